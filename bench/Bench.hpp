@@ -0,0 +1,180 @@
+#pragma once
+
+#include "Common.hpp"
+
+#include <chrono>
+#include <cmath>
+#include <cstdint>
+#include <cstdio>
+#include <cstdlib>
+#include <fstream>
+#include <iostream>
+#include <string>
+#include <vector>
+
+#if defined(__unix__) || defined(__APPLE__)
+#include <sys/resource.h>
+#endif
+
+// Helpers shared by the benchmark programs
+namespace bench
+{
+
+class Timer
+{
+private:
+	std::chrono::steady_clock::time_point start = std::chrono::steady_clock::now();
+
+public:
+	void restart() { start = std::chrono::steady_clock::now(); }
+	double seconds() const { return std::chrono::duration<double>(std::chrono::steady_clock::now() - start).count(); }
+};
+
+// Peak resident memory of the process so far, 0 when unknown
+inline uint64_t peakResidentBytes()
+{
+#if defined(__unix__) || defined(__APPLE__)
+	struct rusage usage;
+	if (getrusage(RUSAGE_SELF, &usage) != 0)
+		return 0;
+#if defined(__APPLE__)
+	return uint64_t(usage.ru_maxrss);
+#else
+	return uint64_t(usage.ru_maxrss) * 1024;
+#endif
+#else
+	return 0;
+#endif
+}
+
+inline const char *realName()
+{
+	return sizeof(Real) == sizeof(double) ? "double" : "float";
+}
+
+// Command line values, the whole string has to be a decimal number
+inline bool parseUint(const char *str, uint &value)
+{
+	char *end = nullptr;
+	unsigned long parsed = std::strtoul(str, &end, 10);
+	if (end == str || *end != '\0')
+		return false;
+	value = uint(parsed);
+	return true;
+}
+
+// Streams JSON, separating and indenting values as they come
+class JsonWriter
+{
+private:
+	std::ostream &os;
+	std::vector<bool> firstInScope;
+
+	void key(const char *name)
+	{
+		if (!firstInScope.empty())
+		{
+			if (!firstInScope.back())
+				os << ",";
+			firstInScope.back() = false;
+			os << "\n" << std::string(firstInScope.size(), '\t');
+		}
+		if (name)
+		{
+			quoted(name);
+			os << ": ";
+		}
+	}
+
+	// Quoted, with quotes, backslashes and control characters escaped
+	void quoted(const char *v)
+	{
+		os << "\"";
+		for (const char *c = v; *c; c++)
+		{
+			unsigned char character = static_cast<unsigned char>(*c);
+			if (character == '"' || character == '\\')
+			{
+				os << '\\' << *c;
+			}
+			else if (character < 0x20)
+			{
+				char escaped[8];
+				std::snprintf(escaped, sizeof(escaped), "\\u%04x", uint(character));
+				os << escaped;
+			}
+			else
+			{
+				os << *c;
+			}
+		}
+		os << "\"";
+	}
+
+	// JSON has no infinities nor NaNs
+	template <typename T>
+	void number(T v)
+	{
+		if (std::isfinite(v))
+			os << v;
+		else
+			os << "null";
+	}
+
+	void begin(const char *name, char bracket)
+	{
+		key(name);
+		os << bracket;
+		firstInScope.push_back(true);
+	}
+
+	void end(char bracket)
+	{
+		firstInScope.pop_back();
+		os << "\n" << std::string(firstInScope.size(), '\t') << bracket;
+		if (firstInScope.empty())
+			os << "\n";
+	}
+
+public:
+	JsonWriter(std::ostream &_os) : os(_os) { os.precision(9); }
+
+	// Keys are only given for the members of an object
+	void beginObject(const char *name = nullptr) { begin(name, '{'); }
+	void endObject() { end('}'); }
+	void beginArray(const char *name = nullptr) { begin(name, '['); }
+	void endArray() { end(']'); }
+
+	template <typename T>
+	void value(const char *name, const T &v) { key(name); os << v; }
+	void value(const char *name, float v) { key(name); number(v); }
+	void value(const char *name, double v) { key(name); number(v); }
+	void value(const char *name, bool v) { key(name); os << (v ? "true" : "false"); }
+	void value(const char *name, const char *v) { key(name); quoted(v); }
+	void value(const char *name, const std::string &v) { value(name, v.c_str()); }
+};
+
+// Results go to the given file, or to the standard output when no name is given
+class Output
+{
+private:
+	std::ofstream file;
+
+public:
+	bool open(const std::string &fileName)
+	{
+		if (fileName.empty())
+			return true;
+		file.open(fileName);
+		if (!file)
+		{
+			std::cerr << "Couldn't open '" << fileName << "' for writing." << std::endl;
+			return false;
+		}
+		return true;
+	}
+
+	std::ostream &stream() { return file.is_open() ? file : std::cout; }
+};
+
+}
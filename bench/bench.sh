@@ -0,0 +1,72 @@
+#!/usr/bin/env bash
+
+# Builds and runs the benchmark programs, each writing its JSON results to bin/bench/<name>.json.
+# Arguments after '--' are passed to every program, e.g. 'bench/bench.sh -- --quick'.
+
+absolute_path()
+{
+	( cd "$1" && pwd -P || echo "$1" )
+}
+
+barename()
+{
+	name="$(basename "$1")"
+	name="${name%%.*}"
+	echo "$name"
+}
+
+scriptName="$( basename "$0" )"
+benchDir="$( absolute_path "$(dirname "$0")" )"
+binDir="${benchDir}/../bin/bench"
+failure=0
+
+do_bench()
+{
+	benchName="$1"
+	benchPath="$2"
+	shift 2
+
+	execName="$( "${benchDir}"/../tools/build.sh "${benchPath}" -r "${benchDir}/../src/" -b "${binDir}/" )"
+
+	if [[ $? -ne 0 ]]; then
+		echo 1>&2
+		echo "[Bench>${benchName}] Failed to build '${benchPath}'" 1>&2
+		failure=1
+		return 1
+	fi
+
+	"${execName}" -o "${binDir}/${benchName}.json" "$@" 2>&1 | awk '{print "[Bench>'"${benchName}"'] " $0}'
+
+	status="${PIPESTATUS[0]}"
+	if [[ "${status}" -ne 0 ]]; then
+		echo "[${scriptName}] Errors running '${benchPath}'" 1>&2
+		failure=1
+	fi
+	return "${status}"
+}
+
+list=()
+while [[ $# -gt 0 && "$1" != "--" ]]; do
+	list+=("$1")
+	shift
+done
+if [[ "$1" == "--" ]]; then
+	shift
+fi
+if [[ ${#list[@]} -eq 0 ]]; then
+	list=("${benchDir}"/*.cpp)
+fi
+
+for item in "${list[@]}"
+do
+	benchName="$( barename "$item" )"
+	benchPath="$( absolute_path "$(dirname "$item")" )"/"$( basename "$item" )"
+
+	do_bench "${benchName}" "${benchPath}" "$@" &&
+	echo "[Bench>${benchName}] Results written to '${binDir}/${benchName}.json'"
+done
+
+if [[ $failure -ne 0 ]]; then
+	echo "[${scriptName}] Some benchmarks failed." 1>&2
+	exit 1
+fi
@@ -0,0 +1,350 @@
+#include "Common.hpp"
+
+#include "Bench.hpp"
+#include "Box.hpp"
+#include "CheckerTexture.hpp"
+#include "ConstantTexture.hpp"
+#include "Dielectric.hpp"
+#include "DiffuseLight.hpp"
+#include "Hitable.hpp"
+#include "Lambertian.hpp"
+#include "Material.hpp"
+#include "Metal.hpp"
+#include "NoiseTexture.hpp"
+#include "Quat.hpp"
+#include "Random.hpp"
+#include "Ray.hpp"
+#include "Rect.hpp"
+#include "Sphere.hpp"
+#include "Texture.hpp"
+#include "Transform.hpp"
+#include "Vec3.hpp"
+
+#include <cstdint>
+#include <cstdlib>
+#include <iostream>
+#include <string>
+#include <vector>
+
+// Measures the intersection, distance and scattering kernels one at a time over randomized batches, and
+// reports, as JSON, the time per call and how often the call succeeded.
+
+struct Options
+{
+	std::string outputFileName;
+	std::string filter;
+	uint batchSize = 4096;
+	uint seed = 1;
+	double seconds = 0.25;
+};
+
+struct Result
+{
+	uint64_t operations = 0;
+	uint64_t successes = 0;
+	double seconds = 0.0;
+};
+
+// Results of the measured calls are summed here so that they can't be optimized away
+volatile Real sink = 0;
+
+// Runs whole batches until the time is up, the batch returns the number of successful calls
+template <typename Batch>
+Result measure(const Options &options, Batch batch)
+{
+	Result result;
+	// Warm up caches and branch predictors
+	batch();
+	bench::Timer timer;
+	do
+	{
+		result.successes += batch();
+		result.operations += options.batchSize;
+		result.seconds = timer.seconds();
+	} while (result.seconds < options.seconds);
+	return result;
+}
+
+void report(bench::JsonWriter &json, const char *name, const char *rateName, const Result &result)
+{
+	std::cerr << name << ": " << result.seconds * 1e9 / result.operations << " ns/op" << std::endl;
+
+	json.beginObject();
+	json.value("name", name);
+	json.value("operations", result.operations);
+	json.value("nsPerOp", result.seconds * 1e9 / result.operations);
+	json.value(rateName, double(result.successes) / result.operations);
+	json.endObject();
+}
+
+Vec3 randomInCube(Real halfSize)
+{
+	return halfSize * (2.0 * Vec3(uniformRand(), uniformRand(), uniformRand()) - 1.0);
+}
+
+// Rays from a shell around the origin towards points of a cube centered on it, some of them missing the
+// unit sized primitives
+std::vector<Ray> makeRays(uint amount)
+{
+	std::vector<Ray> rays;
+	rays.reserve(amount);
+	for (uint i = 0; i < amount; i++)
+	{
+		Vec3 origin = normalize(randomInCube(1.0)) * 4.0;
+		rays.push_back(Ray(origin, randomInCube(1.5) - origin));
+	}
+	return rays;
+}
+
+std::vector<Vec3> makePoints(uint amount)
+{
+	std::vector<Vec3> points;
+	points.reserve(amount);
+	for (uint i = 0; i < amount; i++)
+		points.push_back(randomInCube(2.0));
+	return points;
+}
+
+void benchHitable(bench::JsonWriter &json, const Options &options, const std::string &name, const Hitable &hitable)
+{
+	const std::vector<Ray> rays = makeRays(options.batchSize);
+	const std::vector<Vec3> points = makePoints(options.batchSize);
+
+	std::string hitName = name + "::hit";
+	if (hitName.find(options.filter) != std::string::npos)
+	{
+		Result result = measure(options, [&]()
+		{
+			uint hits = 0;
+			Real sum = 0;
+			HitRecord rec;
+			for (const Ray &r : rays)
+			{
+				if (hitable.hit(r, math::minHitDistance(), math::maxReal(), rec))
+				{
+					hits++;
+					sum += rec.t;
+				}
+			}
+			sink = sum;
+			return hits;
+		});
+		report(json, hitName.c_str(), "hitRate", result);
+	}
+
+	std::string sdfName = name + "::evaluateSDF";
+	if (sdfName.find(options.filter) != std::string::npos)
+	{
+		Result result = measure(options, [&]()
+		{
+			uint inside = 0;
+			Real sum = 0;
+			for (const Vec3 &p : points)
+			{
+				Real distance = hitable.evaluateSDF(p);
+				inside += distance <= 0.0;
+				sum += distance;
+			}
+			sink = sum;
+			return inside;
+		});
+		report(json, sdfName.c_str(), "insideRate", result);
+	}
+}
+
+// Scatters the rays that hit a unit sphere, off the hit points
+void benchMaterial(bench::JsonWriter &json, const Options &options, const std::string &name, const Material &material)
+{
+	std::string scatterName = name + "::scatter";
+	if (scatterName.find(options.filter) == std::string::npos)
+		return;
+
+	Sphere sphere(Vec3(0, 0, 0), 1, material);
+	std::vector<Ray> rays;
+	std::vector<HitRecord> records;
+	rays.reserve(options.batchSize);
+	records.reserve(options.batchSize);
+	while (rays.size() < options.batchSize)
+	{
+		HitRecord rec;
+		for (const Ray &r : makeRays(options.batchSize))
+		{
+			if (rays.size() < options.batchSize && sphere.hit(r, math::minHitDistance(), math::maxReal(), rec))
+			{
+				rays.push_back(r);
+				records.push_back(rec);
+			}
+		}
+	}
+
+	Result result = measure(options, [&]()
+	{
+		uint scattered = 0;
+		Real sum = 0;
+		Vec3 attenuation;
+		Ray scatteredRay;
+		for (uint i = 0; i < options.batchSize; i++)
+		{
+			if (material.scatter(rays[i], records[i], attenuation, scatteredRay))
+			{
+				scattered++;
+				sum += attenuation.r + scatteredRay.direction().x;
+			}
+		}
+		sink = sum;
+		return scattered;
+	});
+	report(json, scatterName.c_str(), "scatterRate", result);
+}
+
+// Samples the texture at points of the cube, one at a time and in one call
+void benchTexture(bench::JsonWriter &json, const Options &options, const std::string &name, const Texture &texture)
+{
+	const std::vector<Vec3> points = makePoints(options.batchSize);
+	std::vector<Vec3> colours(options.batchSize);
+
+	std::string sampleName = name + "::sample";
+	if (sampleName.find(options.filter) != std::string::npos)
+	{
+		Result result = measure(options, [&]()
+		{
+			Real sum = 0;
+			for (const Vec3 &p : points)
+				sum += texture.sample(p).r;
+			sink = sum;
+			return options.batchSize;
+		});
+		report(json, sampleName.c_str(), "sampleRate", result);
+	}
+
+	std::string sampleManyName = name + "::sampleMany";
+	if (sampleManyName.find(options.filter) != std::string::npos)
+	{
+		Result result = measure(options, [&]()
+		{
+			texture.sampleMany(points.data(), options.batchSize, colours.data());
+			sink = colours[options.batchSize - 1].r;
+			return options.batchSize;
+		});
+		report(json, sampleManyName.c_str(), "sampleRate", result);
+	}
+}
+
+void printUsage(const char *programName)
+{
+	std::cout << "usage: " << programName << " [options]" << std::endl;
+	std::cout << "Measures primitive intersections, distance functions, material scattering and texture sampling, reports as JSON." << std::endl;
+	std::cout << "options:" << std::endl;
+	std::cout << "  -h|--help             Prints this message." << std::endl;
+	std::cout << "  -o|--output file      Writes the results to a file instead of the standard output." << std::endl;
+	std::cout << "  -b|--batch n          Rays or points per batch, 4096 by default." << std::endl;
+	std::cout << "  --time seconds        Minimum time spent on each kernel, 0.25 by default." << std::endl;
+	std::cout << "  --filter text         Only runs the kernels whose name contains the text, e.g. 'Box::'." << std::endl;
+	std::cout << "  --seed n              Seed of the batch generation." << std::endl;
+	std::cout << "  --quick               Short runs, to check that everything runs." << std::endl;
+}
+
+// Returns 0 to proceed, a negative value to exit successfully and a positive value on error
+int parseOptions(int argc, char *argv[], Options &options)
+{
+	for (int i = 1; i < argc; i++)
+	{
+		std::string arg(argv[i]);
+		bool hasValue = i + 1 < argc;
+		bool valid = true;
+		if (arg == "-h" || arg == "--help")
+		{
+			printUsage(argv[0]);
+			return -1;
+		}
+		else if ((arg == "-o" || arg == "--output") && hasValue)
+		{
+			options.outputFileName = argv[++i];
+		}
+		else if ((arg == "-b" || arg == "--batch") && hasValue)
+		{
+			valid = bench::parseUint(argv[++i], options.batchSize) && options.batchSize > 0;
+		}
+		else if (arg == "--time" && hasValue)
+		{
+			options.seconds = std::atof(argv[++i]);
+			valid = options.seconds > 0.0;
+		}
+		else if (arg == "--filter" && hasValue)
+		{
+			options.filter = argv[++i];
+		}
+		else if (arg == "--seed" && hasValue)
+		{
+			valid = bench::parseUint(argv[++i], options.seed);
+		}
+		else if (arg == "--quick")
+		{
+			options.seconds = 0.01;
+		}
+		else
+		{
+			valid = false;
+		}
+
+		if (!valid)
+		{
+			std::cerr << "Invalid argument '" << arg << "'." << std::endl;
+			printUsage(argv[0]);
+			return 1;
+		}
+	}
+	return 0;
+}
+
+int main(int argc, char *argv[])
+{
+	Options options;
+	int exitCode = parseOptions(argc, argv, options);
+	if (exitCode != 0)
+		return exitCode < 0 ? 0 : exitCode;
+
+	bench::Output output;
+	if (!output.open(options.outputFileName))
+		return 1;
+
+	seedRandom(options.seed);
+
+	bench::JsonWriter json(output.stream());
+	json.beginObject();
+	json.value("benchmark", "kernels");
+	json.value("real", bench::realName());
+	json.value("batchSize", options.batchSize);
+	json.value("seed", options.seed);
+	json.beginArray("kernels");
+
+	Lambertian lambertian(Vec3(0.5, 0.5, 0.5));
+	Quat rotation = axisAngleToQuat(Vec3(1, 1, 0), math::pi() * 0.25);
+
+	benchHitable(json, options, "Sphere", Sphere(Vec3(0, 0, 0), 1, lambertian));
+	benchHitable(json, options, "Box", Box(Transform(rotation, Vec3(0, 0, 0), 1), Vec3(2, 1.5, 1), lambertian));
+	benchHitable(json, options, "Rect", Rect(Transform(rotation, Vec3(0, 0, 0), 1), 2, 1.5, lambertian));
+
+	CheckerTexture checker(Vec3(1, 1, 1), Vec3(0, 0, 0), Vec3(4, 4, 4));
+	benchMaterial(json, options, "Lambertian", lambertian);
+	benchMaterial(json, options, "Lambertian<CheckerTexture>", Lambertian(checker));
+	ConstantTexture grey(Vec3(0.5, 0.5, 0.5));
+	CheckerTexture checkerInChecker(checker, grey, Vec3(1, 1, 1));
+	CheckerTexture nested(checkerInChecker, checker, Vec3(0.25, 0.25, 0.25));
+	benchMaterial(json, options, "Lambertian<nested CheckerTexture>", Lambertian(nested));
+	benchMaterial(json, options, "Metal", Metal(Vec3(0.8, 0.8, 0.8), 0));
+	benchMaterial(json, options, "Metal<rough>", Metal(Vec3(0.8, 0.8, 0.8), 0.5));
+	benchMaterial(json, options, "Dielectric", Dielectric(1.5));
+	benchMaterial(json, options, "DiffuseLight", DiffuseLight(Vec3(1, 1, 1)));
+
+	benchTexture(json, options, "CheckerTexture", checker);
+	benchTexture(json, options, "CheckerTexture<nested>", nested);
+	benchTexture(json, options, "NoiseTexture", NoiseTexture(4));
+	benchTexture(json, options, "TurbulenceTexture", TurbulenceTexture(4, 7));
+	benchTexture(json, options, "MarbleTexture", MarbleTexture(4, 7));
+
+	json.endArray();
+	json.endObject();
+
+	return 0;
+}
@@ -0,0 +1,313 @@
+#include "Common.hpp"
+
+#include "../examples/ExampleScenes.hpp"
+#include "Bench.hpp"
+#include "Camera.hpp"
+#include "Image.hpp"
+#include "Random.hpp"
+#include "Raytrace.hpp"
+#include "Renderer.hpp"
+#include "Scene.hpp"
+#include "Viewport.hpp"
+
+#include <algorithm>
+#include <atomic>
+#include <cstdint>
+#include <cstdlib>
+#include <iostream>
+#include <sstream>
+#include <string>
+#include <thread>
+#include <vector>
+
+// Renders the example scenes at fixed seeds and resolutions and reports, as JSON, the ray and sample
+// throughput for a range of thread counts along with the memory used.
+
+// Counts the rays traced through the scene, one per call to hit. Rendering threads are started for every
+// render, so each thread counts on its own and hands its total over when it exits.
+class CountingScene : public Scene
+{
+private:
+	struct Counter
+	{
+		uint64_t rays = 0;
+		~Counter() { retiredRays += rays; }
+	};
+
+	static std::atomic<uint64_t> retiredRays;
+	static thread_local Counter counter;
+
+public:
+	virtual bool hit(const Ray &r, Real minDist, Real maxDist, HitRecord &rec) const override
+	{
+		counter.rays++;
+		return Scene::hit(r, minDist, maxDist, rec);
+	}
+
+	// Rays counted since the last reset by the exited threads and the calling thread
+	static uint64_t rays() { return retiredRays + counter.rays; }
+	static void resetRays() { retiredRays = 0; counter.rays = 0; }
+};
+
+std::atomic<uint64_t> CountingScene::retiredRays {0};
+thread_local CountingScene::Counter CountingScene::counter;
+
+// An example scene counting its rays
+struct BenchScene
+{
+	CountingScene scene;
+	ExampleScene example;
+
+	BenchScene(const Viewport &vp) : example(scene, vp) {}
+};
+
+struct SceneEntry
+{
+	const char *name;
+	void (*build)(ExampleScene &s);
+	uint width;
+	uint height;
+};
+
+// Same resolutions as the examples
+const SceneEntry sceneEntries[] =
+{
+	{ "weekend1", examples::buildWeekend1, 1024, 640 },
+	{ "cornell_box", examples::buildCornellBox, 256, 256 },
+	{ "light", examples::buildLight, 480, 300 },
+	{ "spheres_and_boxes", examples::buildSpheresAndBoxes, 512, 256 },
+	{ "texture", examples::buildTexture, 480, 300 },
+};
+
+struct Options
+{
+	std::string outputFileName;
+	std::vector<std::string> scenes;
+	std::vector<uint> threadCounts;
+	uint samplesPerPixel = 8;
+	uint repeat = 1;
+	uint seed = 1;
+	double scale = 1.0;
+};
+
+void printUsage(const char *programName)
+{
+	std::cout << "usage: " << programName << " [options]" << std::endl;
+	std::cout << "Renders the example scenes and reports throughput and memory use as JSON." << std::endl;
+	std::cout << "options:" << std::endl;
+	std::cout << "  -h|--help                 Prints this message." << std::endl;
+	std::cout << "  -o|--output file          Writes the results to a file instead of the standard output." << std::endl;
+	std::cout << "  -s|--spp n                Samples per pixel, 8 by default." << std::endl;
+	std::cout << "  -t|--threads n[,n...]     Thread counts to measure, powers of two up to all hardware threads by default." << std::endl;
+	std::cout << "  -r|--repeat n             Renders each configuration n times and keeps the fastest." << std::endl;
+	std::cout << "  --scale factor            Scales the resolution of every scene." << std::endl;
+	std::cout << "  --scenes name[,name...]   Scenes to render, all by default:";
+	for (const SceneEntry &entry : sceneEntries)
+		std::cout << " " << entry.name;
+	std::cout << "." << std::endl;
+	std::cout << "  --seed n                  Seed of the scene generation and of the main thread." << std::endl;
+	std::cout << "  --quick                   Quarter resolution and 2 samples per pixel, to check that everything runs." << std::endl;
+}
+
+std::vector<std::string> split(const std::string &list)
+{
+	std::vector<std::string> items;
+	std::istringstream is(list);
+	std::string item;
+	while (std::getline(is, item, ','))
+		items.push_back(item);
+	return items;
+}
+
+// Returns 0 to proceed, a negative value to exit successfully and a positive value on error
+int parseOptions(int argc, char *argv[], Options &options)
+{
+	for (int i = 1; i < argc; i++)
+	{
+		std::string arg(argv[i]);
+		bool hasValue = i + 1 < argc;
+		bool valid = true;
+		if (arg == "-h" || arg == "--help")
+		{
+			printUsage(argv[0]);
+			return -1;
+		}
+		else if ((arg == "-o" || arg == "--output") && hasValue)
+		{
+			options.outputFileName = argv[++i];
+		}
+		else if ((arg == "-s" || arg == "--spp") && hasValue)
+		{
+			valid = bench::parseUint(argv[++i], options.samplesPerPixel) && options.samplesPerPixel > 0;
+		}
+		else if ((arg == "-t" || arg == "--threads") && hasValue)
+		{
+			options.threadCounts.clear();
+			for (const std::string &item : split(argv[++i]))
+			{
+				uint n = 0;
+				valid = valid && bench::parseUint(item.c_str(), n) && n > 0;
+				options.threadCounts.push_back(n);
+			}
+			valid = valid && !options.threadCounts.empty();
+		}
+		else if ((arg == "-r" || arg == "--repeat") && hasValue)
+		{
+			valid = bench::parseUint(argv[++i], options.repeat) && options.repeat > 0;
+		}
+		else if (arg == "--scale" && hasValue)
+		{
+			options.scale = std::atof(argv[++i]);
+			valid = options.scale > 0.0;
+		}
+		else if (arg == "--scenes" && hasValue)
+		{
+			options.scenes = split(argv[++i]);
+			for (const std::string &name : options.scenes)
+				valid = valid && std::any_of(std::begin(sceneEntries), std::end(sceneEntries), [&name](const SceneEntry &entry) { return name == entry.name; });
+		}
+		else if (arg == "--seed" && hasValue)
+		{
+			valid = bench::parseUint(argv[++i], options.seed);
+		}
+		else if (arg == "--quick")
+		{
+			options.scale = 0.25;
+			options.samplesPerPixel = 2;
+		}
+		else
+		{
+			valid = false;
+		}
+
+		if (!valid)
+		{
+			std::cerr << "Invalid argument '" << arg << "'." << std::endl;
+			printUsage(argv[0]);
+			return 1;
+		}
+	}
+
+	if (options.threadCounts.empty())
+	{
+		uint hardwareThreads = math::max(std::thread::hardware_concurrency(), 1u);
+		for (uint n = 1; n < hardwareThreads; n *= 2)
+			options.threadCounts.push_back(n);
+		options.threadCounts.push_back(hardwareThreads);
+	}
+
+	return 0;
+}
+
+int main(int argc, char *argv[])
+{
+	Options options;
+	int exitCode = parseOptions(argc, argv, options);
+	if (exitCode != 0)
+		return exitCode < 0 ? 0 : exitCode;
+
+	bench::Output output;
+	if (!output.open(options.outputFileName))
+		return 1;
+
+	bench::JsonWriter json(output.stream());
+	json.beginObject();
+	json.value("benchmark", "render");
+	json.value("real", bench::realName());
+	json.value("hardwareThreads", std::thread::hardware_concurrency());
+	json.value("samplesPerPixel", options.samplesPerPixel);
+	json.value("seed", options.seed);
+	json.value("repeat", options.repeat);
+	json.beginArray("scenes");
+
+	for (const SceneEntry &entry : sceneEntries)
+	{
+		if (!options.scenes.empty() && std::find(options.scenes.begin(), options.scenes.end(), entry.name) == options.scenes.end())
+			continue;
+
+		uint width = math::max(uint(entry.width * options.scale + 0.5), 1u);
+		uint height = math::max(uint(entry.height * options.scale + 0.5), 1u);
+
+		// Scene generation draws from the main thread's sequence
+		seedRandom(options.seed);
+		bench::Timer timer;
+		BenchScene benchScene(Viewport(width, height));
+		entry.build(benchScene.example);
+		benchScene.scene.build();
+		double buildSeconds = timer.seconds();
+
+		ImageDesc imageDesc;
+		imageDesc.width = width;
+		imageDesc.height = height;
+		imageDesc.format = ImageFormat::r32g32b32f;
+		Image image(imageDesc);
+
+		Raytrace raytrace(benchScene.scene, *benchScene.example.camera, benchScene.example.viewport, image);
+		raytrace.setSamplesPerPixel(options.samplesPerPixel);
+
+		json.beginObject();
+		json.value("name", entry.name);
+		json.value("width", width);
+		json.value("height", height);
+		json.value("hitables", benchScene.scene.size());
+		json.value("buildSeconds", buildSeconds);
+		json.beginArray("runs");
+
+		const uint64_t samples = uint64_t(width) * height * options.samplesPerPixel;
+		double baseSamplesPerSecond = 0.0;
+		Renderer renderer;
+		for (uint threadCount : options.threadCounts)
+		{
+			renderer.setThreadCount(threadCount);
+			double seconds = 0.0;
+			uint64_t rays = 0;
+			for (uint i = 0; i < options.repeat; i++)
+			{
+				// The other rendering threads start from the default seed on every render
+				seedRandom(options.seed);
+				CountingScene::resetRays();
+				timer.restart();
+				renderer.render(raytrace);
+				double runSeconds = timer.seconds();
+				if (i == 0 || runSeconds < seconds)
+				{
+					seconds = runSeconds;
+					rays = CountingScene::rays();
+				}
+			}
+			std::cerr << entry.name << ": " << threadCount << " thread(s), " << seconds << "s" << std::endl;
+
+			// Every sample starts with one camera ray, the others are scattered off surfaces
+			const uint64_t primaryRays = samples;
+			const uint64_t secondaryRays = rays > primaryRays ? rays - primaryRays : 0;
+			const double samplesPerSecond = samples / seconds;
+			if (baseSamplesPerSecond == 0.0)
+				baseSamplesPerSecond = samplesPerSecond / options.threadCounts.front();
+
+			json.beginObject();
+			json.value("threads", threadCount);
+			json.value("seconds", seconds);
+			json.value("primaryRays", primaryRays);
+			json.value("secondaryRays", secondaryRays);
+			json.value("raysPerSecond", rays / seconds);
+			json.value("primaryRaysPerSecond", primaryRays / seconds);
+			json.value("secondaryRaysPerSecond", secondaryRays / seconds);
+			json.value("samplesPerSecond", samplesPerSecond);
+			// Relative to the first thread count, scaled down to a single thread
+			json.value("speedup", samplesPerSecond / baseSamplesPerSecond);
+			json.value("efficiency", samplesPerSecond / baseSamplesPerSecond / threadCount);
+			json.endObject();
+		}
+
+		json.endArray();
+		json.value("imageBytes", uint64_t(image.getWidth()) * image.getHeight() * image.getPixelSizeInBytes());
+		// Peak of the whole process, scenes are rendered in the order listed
+		json.value("peakResidentBytes", bench::peakResidentBytes());
+		json.endObject();
+	}
+
+	json.endArray();
+	json.endObject();
+
+	return 0;
+}
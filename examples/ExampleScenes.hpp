@@ -0,0 +1,174 @@
+#pragma once
+
+#include "Common.hpp"
+
+#include "Background.hpp"
+#include "Box.hpp"
+#include "Camera.hpp"
+#include "CheckerTexture.hpp"
+#include "Dielectric.hpp"
+#include "DiffuseLight.hpp"
+#include "Hitable.hpp"
+#include "Lambertian.hpp"
+#include "Material.hpp"
+#include "Metal.hpp"
+#include "Quat.hpp"
+#include "Random.hpp"
+#include "Rect.hpp"
+#include "Scene.hpp"
+#include "Sphere.hpp"
+#include "Texture.hpp"
+#include "Transform.hpp"
+#include "Vec3.hpp"
+#include "Viewport.hpp"
+
+#include <memory>
+#include <vector>
+
+// Scenes of the example programs, also rendered by bench/render.cpp. The builders add their shapes to the
+// given scene without building it, and draw from the random sequence of the calling thread.
+
+// Owns everything an example scene references
+class ExampleScene
+{
+private:
+	std::vector<std::unique_ptr<Texture>> textures;
+	std::vector<std::unique_ptr<Material>> materials;
+	std::vector<std::unique_ptr<Hitable>> hitables;
+
+public:
+	Scene &scene;
+	Viewport viewport;
+	std::unique_ptr<Camera> camera;
+
+	ExampleScene(Scene &_scene, const Viewport &vp) : scene(_scene), viewport(vp) {}
+
+	const Texture &add(Texture *texture) { textures.emplace_back(texture); return *texture; }
+	const Material &add(Material *material) { materials.emplace_back(material); return *material; }
+	void add(Hitable *hitable) { hitables.emplace_back(hitable); scene.add(*hitable); }
+	void setCamera(const Vec3 &position, const Vec3 &target, Real fovY, Real aperture, Real focusDistance)
+	{
+		camera.reset(new Camera(position, target - position, Vec3(0, 1, 0), fovY, viewport, aperture, focusDistance));
+	}
+};
+
+namespace examples
+{
+
+// Random spheres around three big ones, from Ray Tracing in One Weekend
+inline void buildWeekend1(ExampleScene &s)
+{
+	Vec3 cameraPosition(13.0, 2.0, 3.0);
+	Vec3 focusPosition(0, 0.5, 0);
+	s.setCamera(cameraPosition, focusPosition, 20, 0.25, (focusPosition - cameraPosition).length() - 4.0);
+	s.scene.setBackground(Background(Vec3(0.619, 1, 0.694), Vec3(1, 0.639, 0.619)));
+
+	s.add(new Sphere(Vec3(0, -1000, 0), 1000, s.add(new Lambertian(Vec3(0.5, 0.5, 0.5)))));
+	for (int i = -11; i < 11; i++)
+	{
+		for (int j = -11; j < 11; j++)
+		{
+			Real materialChooser = uniformRand();
+			const Material *material = nullptr;
+			if (materialChooser > 0.9)
+				material = &s.add(new Dielectric(1.2 + uniformRand() * 0.5));
+			else if (materialChooser > 0.6)
+				material = &s.add(new Metal(Vec3(uniformRand(), uniformRand(), uniformRand()), uniformRand()));
+			else
+				material = &s.add(new Lambertian(Vec3(uniformRand(), uniformRand(), uniformRand())));
+			Vec3 spherePosition(i + uniformRand() * 2.0 - 1.0, 0.2 + uniformRand() * 0.2, j + uniformRand() * 2.0 - 1.0);
+			s.add(new Sphere(spherePosition, 0.2, *material));
+		}
+	}
+	s.add(new Sphere(Vec3(-4, 1, 0), 1, s.add(new Lambertian(Vec3(0.0, 1.0, 0.32)))));
+	s.add(new Sphere(Vec3(4, 1, 0), 1, s.add(new Metal(Vec3(0.7, 0.6, 0.5), 0))));
+	s.add(new Sphere(Vec3(0, 1, 0), 1, s.add(new Dielectric(1.5))));
+}
+
+inline void buildCornellBox(ExampleScene &s)
+{
+	s.setCamera(Vec3(278.0, 278.0, -800.0), Vec3(278.0, 278.0, 0.0), 40.0, 0.0, 10.0);
+	s.scene.setBackground(Background(Vec3(0.0, 0.0, 0.0), Vec3(0.0, 0.0, 0.0)));
+
+	const Material &red = s.add(new Lambertian(Vec3(0.65, 0.05, 0.05)));
+	const Material &white = s.add(new Lambertian(Vec3(0.73, 0.73, 0.73)));
+	const Material &green = s.add(new Lambertian(Vec3(0.12, 0.45, 0.15)));
+	const Material &light = s.add(new DiffuseLight(Vec3(15.0, 15.0, 15.0)));
+
+	s.add(new Rect(Transform(axisAngleToQuat(Vec3(0.0, 1.0, 0.0), math::pi() * -0.5), Vec3(555.0, 277.5, 277.5), 1.0), 555.0, 555.0, red));
+	s.add(new Rect(Transform(axisAngleToQuat(Vec3(0.0, 1.0, 0.0), math::pi() * 0.5), Vec3(0.0, 277.5, 277.5), 1.0), 555.0, 555.0, green));
+	s.add(new Rect(Transform(axisAngleToQuat(Vec3(1.0, 0.0, 0.0), math::pi() * -0.5), Vec3(278.0, 554.0, 279.5), 1.0), 130.0, 105.0, light));
+	s.add(new Rect(Transform(axisAngleToQuat(Vec3(1.0, 0.0, 0.0), math::pi() * 0.5), Vec3(277.5, 555.0, 277.5), 1.0), 555.0, 555.0, white));
+	s.add(new Rect(Transform(axisAngleToQuat(Vec3(1.0, 0.0, 0.0), math::pi() * -0.5), Vec3(277.5, 0.0, 277.5), 1.0), 555.0, 555.0, white));
+	s.add(new Rect(Transform(axisAngleToQuat(Vec3(1.0, 0.0, 0.0), math::pi()), Vec3(277.5, 277.5, 555.0), 1.0), 555.0, 555.0, white));
+	s.add(new Box(Transform(axisAngleToQuat(Vec3(0.0, 1.0, 0.0), math::pi() / 180.0 * -18.0), Vec3(185.5, 82.5, 169.0), 1.0), Vec3(165.0, 165.0, 165.0), white));
+	s.add(new Box(Transform(axisAngleToQuat(Vec3(0.0, 1.0, 0.0), math::pi() / 180.0 * 15.0), Vec3(368.5, 165.0, 351.5), 1.0), Vec3(165.0, 330.0, 165.0), white));
+}
+
+// Metal sphere lit by three coloured rectangles
+inline void buildLight(ExampleScene &s)
+{
+	Vec3 focusPosition(0, 0, 0);
+	Vec3 cameraPosition(0.0, 0.0, 8.0);
+	s.setCamera(cameraPosition, focusPosition, 20, 0.2, (focusPosition - cameraPosition).length());
+	s.camera->setDepthOfFieldEnabled(false);
+	s.scene.setBackground(Background(Vec3(0.0, 0.0, 0.03), Vec3(0.03, 0.0, 0.0)));
+
+	const Material &ground = s.add(new Lambertian(Vec3(0.6, 0.8, 0.6)));
+	const Material &metal = s.add(new Metal(Vec3(0.9, 0.85, 0.9), 0.0));
+	const Material &light1 = s.add(new DiffuseLight(Vec3(1.0, 0.0, 0.2)));
+	const Material &light2 = s.add(new DiffuseLight(Vec3(0.2, 0.0, 1.0)));
+	const Material &light3 = s.add(new DiffuseLight(Vec3(0.8, 0.9, 0.7)));
+
+	s.add(new Sphere(focusPosition + Vec3(0.0, -100.55, 0.0), 100.0, ground));
+	s.add(new Sphere(focusPosition + Vec3(0.0, 0.05, 0.0), 0.5, metal));
+	s.add(new Rect(Transform(axisAngleToQuat(Vec3(0.0, 1.0, 0.0), math::pi() * 0.45), focusPosition + Vec3(-1.0, 0.0, 0.0), 1.0), 1.5, 1.5, light1));
+	s.add(new Rect(Transform(axisAngleToQuat(Vec3(0.0, 1.0, 0.0), math::pi() * -0.45), focusPosition + Vec3(1.0, 0.0, 0.0), 1.0), 1.5, 1.5, light2));
+	s.add(new Rect(Transform(Quat(), focusPosition + Vec3(0.0, 0.0, -1.0), 1.0), 1.5, 1.5, light3));
+}
+
+inline void buildSpheresAndBoxes(ExampleScene &s)
+{
+	Vec3 focusPosition(0, 0, 0);
+	Vec3 cameraPosition(0.0, 0.0, 5.0);
+	s.setCamera(cameraPosition, focusPosition, 20, 0.2, (focusPosition - cameraPosition).length());
+	s.camera->setDepthOfFieldEnabled(false);
+	s.scene.setBackground(Background(Vec3(0.8, 0.3, 0.1), Vec3(0.2, 0.7, 0.9)));
+
+	s.add(new Box(Transform(Quat(), Vec3(0.0, -100.55, -3.0), 200), Vec3(1.0, 1.0, 1.0), s.add(new Metal(Vec3(0.6, 0.6, 0.6), 0.02))));
+	s.add(new Sphere(focusPosition + Vec3(-1.0, 0.0, 0.0), 0.5, s.add(new Dielectric(Vec3(0.9, 0.4, 0.2), 1.5))));
+	s.add(new Sphere(focusPosition + Vec3(-0.8, 0.0, -2.0), 0.5, s.add(new Metal(Vec3(0.15, 0.7, 0.15), 0.0))));
+	s.add(new Sphere(focusPosition + Vec3(-0.6, 0.0, -4.0), 0.5, s.add(new Lambertian(Vec3(0.1, 0.2, 0.7)))));
+	Quat rot = axisAngleToQuat(Vec3(1.0, 1.0, 0.0), math::pi() * 0.25);
+	Vec3 ext(1.0, 1.0, 1.0);
+	s.add(new Box(Transform(rot, focusPosition + Vec3(1.0, 0.0, 0.0), 0.6), ext, s.add(new Dielectric(Vec3(0.1, 0.9, 0.8), 1.8))));
+	s.add(new Box(Transform(rot, focusPosition + Vec3(0.8, 0.0, -2.0), 0.6), ext, s.add(new Metal(Vec3(0.7, 0.2, 0.9), 0.0))));
+	s.add(new Box(Transform(rot, focusPosition + Vec3(0.6, 0.0, -4.0), 0.6), ext, s.add(new Lambertian(Vec3(0.7, 0.9, 0.2)))));
+}
+
+// Cornell box as wide as the viewport, with checker walls
+inline void buildTexture(ExampleScene &s)
+{
+	s.setCamera(Vec3(278.0, 278.0, -800.0), Vec3(278.0, 278.0, 0.0), 40.0, 0.0, 10.0);
+	s.scene.setBackground(Background(Vec3(0.0, 0.0, 0.0), Vec3(0.0, 0.0, 0.0)));
+
+	const Texture &redChecker = s.add(new CheckerTexture(Vec3(1.0, 1.0, 1.0), Vec3(0.65, 0.05, 0.05), 0.1 * Vec3(1.0, 1.0, 1.0)));
+	const Texture &greenChecker = s.add(new CheckerTexture(Vec3(1.0, 1.0, 1.0), Vec3(0.12, 0.45, 0.15), 0.1 * Vec3(1.0, 1.0, 1.0)));
+	const Material &red = s.add(new Lambertian(redChecker));
+	const Material &white = s.add(new Lambertian(Vec3(0.73, 0.73, 0.73)));
+	const Material &green = s.add(new Lambertian(greenChecker));
+	const Material &mirror = s.add(new Metal(Vec3(1.0, 1.0, 1.0), 0.8));
+	const Material &light = s.add(new DiffuseLight(Vec3(1.0, 1.0, 1.0)));
+
+	const Real boxHeight = 555.0;
+	const Real boxWidth = boxHeight * s.viewport.aspectRatio();
+	s.add(new Rect(Transform(axisAngleToQuat(Vec3(0.0, 1.0, 0.0), math::pi() * -0.5), Vec3((boxWidth - boxHeight) * 0.5 + boxHeight, boxHeight * 0.5, boxHeight * 0.5), 1.0), boxHeight, boxHeight, red));
+	s.add(new Rect(Transform(axisAngleToQuat(Vec3(0.0, 1.0, 0.0), math::pi() * 0.5), Vec3(-(boxWidth - boxHeight) * 0.5, boxHeight * 0.5, boxHeight * 0.5), 1.0), boxHeight, boxHeight, green));
+	s.add(new Rect(Transform(axisAngleToQuat(Vec3(1.0, 0.0, 0.0), math::pi() * 0.5), Vec3(boxHeight * 0.5, boxHeight, boxHeight * 0.5), 1.0), boxWidth, boxHeight, light));
+	s.add(new Rect(Transform(axisAngleToQuat(Vec3(1.0, 0.0, 0.0), math::pi() * -0.5), Vec3(boxHeight * 0.5, 0.0, boxHeight * 0.5), 1.0), boxWidth, boxHeight, white));
+	s.add(new Rect(Transform(axisAngleToQuat(Vec3(1.0, 0.0, 0.0), math::pi()), Vec3(boxHeight * 0.5, boxHeight * 0.5, boxHeight), 1.0), boxWidth, boxHeight, mirror));
+	s.add(new Box(Transform(axisAngleToQuat(Vec3(0.0, 1.0, 0.0), math::pi() / 180.0 * -18.0), Vec3(185.5, 82.5, 169.0), 1.0), Vec3(165.0, 165.0, 165.0), white));
+	s.add(new Box(Transform(axisAngleToQuat(Vec3(0.0, 1.0, 0.0), math::pi() / 180.0 * 15.0), Vec3(368.5, 165.0, 351.5), 1.0), Vec3(165.0, 330.0, 165.0), white));
+}
+
+}	// namespace examples
@@ -5,6 +5,7 @@
 #include "Camera.hpp"
 #include "Dielectric.hpp"
 #include "DiffuseLight.hpp"
+#include "ExampleScenes.hpp"
 #include "File.hpp"
 #include "Image.hpp"
 #include "Metal.hpp"
@@ -228,36 +229,14 @@ void renderScene6(Image &image, const Viewport &viewport, uint samplesPerPixel)
 	renderer.render(raytrace);
 }
 
+// Metal sphere lit by three coloured rectangles
 void renderScene7(Image &image, const Viewport &viewport, uint samplesPerPixel)
 {
-	Vec3 cameraPosition(0.0, 0.0, 8.0);
-	Vec3 focusPosition(0, 0, 0);
-	Vec3 focusDirection = focusPosition - cameraPosition;
-	Camera camera(cameraPosition, focusDirection, Vec3(0.0, 1.0, 0.0), 20, viewport, 0.2, focusDirection.length());
-	camera.setDepthOfFieldEnabled(false);
-
-	Lambertian groundMaterial(Vec3(0.6, 0.8, 0.6));
-	Metal metalMaterial(Vec3(0.9, 0.85, 0.9), 0.0);
-	Dielectric glassMaterial(Vec3(0.9, 0.9, 0.9), 1.5);
-	DiffuseLight lightMaterial1(Vec3(1.0, 0.0, 0.2));
-	DiffuseLight lightMaterial2(Vec3(0.2, 0.0, 1.0));
-	DiffuseLight lightMaterial3(Vec3(0.8, 0.9, 0.7));
-
 	Scene scene;
-	scene.setBackground(Background(Vec3(0.0, 0.0, 0.03), Vec3(0.03, 0.0, 0.0)));
-
-	Sphere ground(focusPosition + Vec3(0.0, -100.55, 0.0), 100.0, groundMaterial);
-	scene.add(ground);
-	Sphere metalSphere1(focusPosition + Vec3(0.0, 0.05, 0.0), 0.5, metalMaterial);
-	scene.add(metalSphere1);
-	Rect lightRect1(Transform(axisAngleToQuat(Vec3(0.0, 1.0, 0.0), math::pi() * 0.45), focusPosition + Vec3(-1.0, 0.0, 0.0), 1.0), 1.5, 1.5, lightMaterial1);
-	scene.add(lightRect1);
-	Rect lightRect2(Transform(axisAngleToQuat(Vec3(0.0, 1.0, 0.0), math::pi() * -0.45), focusPosition + Vec3(1.0, 0.0, 0.0), 1.0), 1.5, 1.5, lightMaterial2);
-	scene.add(lightRect2);
-	Rect lightRect3(Transform(Quat(), focusPosition + Vec3(0.0, 0.0, -1.0), 1.0), 1.5, 1.5, lightMaterial3);
-	scene.add(lightRect3);
+	ExampleScene example(scene, viewport);
+	examples::buildLight(example);
 
-	Raytrace raytrace(scene, camera, viewport, image);
+	Raytrace raytrace(scene, *example.camera, viewport, image);
 	raytrace.setSamplesPerPixel(samplesPerPixel);
 	Renderer renderer;
 	renderer.render(raytrace);
@@ -5,6 +5,7 @@
 #include "Camera.hpp"
 #include "CheckerTexture.hpp"
 #include "DiffuseLight.hpp"
+#include "ExampleScenes.hpp"
 #include "File.hpp"
 #include "Image.hpp"
 #include "Metal.hpp"
@@ -50,42 +51,13 @@ void renderScene1(Image &image, const Viewport &viewport, uint samplesPerPixel)
 }
 
 // Wide cornell box with checker walls
-void renderScene2(Image &image, const Viewport &viewport, Real aspectRatio, uint samplesPerPixel)
+void renderScene2(Image &image, const Viewport &viewport, uint samplesPerPixel)
 {
-	Vec3 cameraPosition(278.0, 278.0, -800.0);
-	Vec3 focusPosition(278.0, 278.0, 0.0);
-	Vec3 focusDirection = focusPosition - cameraPosition;
-	Camera camera(cameraPosition, focusDirection, Vec3(0.0, 1.0, 0.0), 40.0, viewport, 0.0, 10.0);
-
-	CheckerTexture redCheckerTexture(Vec3(1.0, 1.0, 1.0), Vec3(0.65, 0.05, 0.05), 0.1 * Vec3(1.0, 1.0, 1.0));
-	Lambertian red(redCheckerTexture);
-	Lambertian white(Vec3(0.73, 0.73, 0.73));
-	CheckerTexture greenCheckerTexture(Vec3(1.0, 1.0, 1.0), Vec3(0.12, 0.45, 0.15), 0.1 * Vec3(1.0, 1.0, 1.0));
-	Lambertian green(greenCheckerTexture);
-	Metal mirror(Vec3(1.0, 1.0, 1.0), 0.8);
-	DiffuseLight lightMaterial(Vec3(1.0, 1.0, 1.0));
-
 	Scene scene;
-	scene.setBackground(Background(Vec3(0.0, 0.0, 0.0), Vec3(0.0, 0.0, 0.0)));
+	ExampleScene example(scene, viewport);
+	examples::buildTexture(example);
 
-	const Real boxHeight = 555.0;
-	const Real boxWidth = boxHeight * aspectRatio;
-	Rect redWall(Transform(axisAngleToQuat(Vec3(0.0, 1.0, 0.0), math::pi() * -0.5), Vec3((boxWidth - boxHeight) * 0.5 + boxHeight, boxHeight * 0.5, boxHeight * 0.5), 1.0), boxHeight, boxHeight, red);
-	scene.add(redWall);
-	Rect greenWall(Transform(axisAngleToQuat(Vec3(0.0, 1.0, 0.0), math::pi() * 0.5), Vec3(-(boxWidth - boxHeight) * 0.5, boxHeight * 0.5, boxHeight * 0.5), 1.0), boxHeight, boxHeight, green);
-	scene.add(greenWall);
-	Rect ceilingWall(Transform(axisAngleToQuat(Vec3(1.0, 0.0, 0.0), math::pi() * 0.5), Vec3(boxHeight * 0.5, boxHeight, boxHeight * 0.5), 1.0), boxWidth, boxHeight, lightMaterial);
-	scene.add(ceilingWall);
-	Rect floorWall(Transform(axisAngleToQuat(Vec3(1.0, 0.0, 0.0), math::pi() * -0.5), Vec3(boxHeight * 0.5, 0.0, boxHeight * 0.5), 1.0), boxWidth, boxHeight, white);
-	scene.add(floorWall);
-	Rect backWall(Transform(axisAngleToQuat(Vec3(1.0, 0.0, 0.0), math::pi()), Vec3(boxHeight * 0.5, boxHeight * 0.5, boxHeight), 1.0), boxWidth, boxHeight, mirror);
-	scene.add(backWall);
-	Box smallBox(Transform(axisAngleToQuat(Vec3(0.0, 1.0, 0.0), math::pi() / 180.0 * -18.0), Vec3(185.5, 82.5, 169.0), 1.0), Vec3(165.0, 165.0, 165.0), white);
-	scene.add(smallBox);
-	Box bigBox(Transform(axisAngleToQuat(Vec3(0.0, 1.0, 0.0), math::pi() / 180.0 * 15.0), Vec3(368.5, 165.0, 351.5), 1.0), Vec3(165.0, 330.0, 165.0), white);
-	scene.add(bigBox);
-
-	Raytrace raytrace(scene, camera, viewport, image);
+	Raytrace raytrace(scene, *example.camera, viewport, image);
 	raytrace.setSamplesPerPixel(samplesPerPixel);
 	Renderer renderer;
 	renderer.render(raytrace);
@@ -104,7 +76,7 @@ int main(int argc, char *argv[])
 	Image image(imageDesc);
 
 	// renderScene1(image, viewport, samplesPerPixel);
-	renderScene2(image, viewport, aspectRatio, samplesPerPixel);
+	renderScene2(image, viewport, samplesPerPixel);
 
 	file::writePpm(argv[argc > 1 ? 1 : 0], image);
 
@@ -0,0 +1,7 @@
+#include "Background.hpp"
+
+Vec3 Background::sample(const Vec3 &direction) const
+{
+	Real altitude = 0.5 * (direction.y + 1.0);
+	return lerp(bottom, top, altitude);
+}
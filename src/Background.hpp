@@ -19,9 +19,3 @@ public:
 
 	Vec3 sample(const Vec3 &direction) const;
 };
-
-Vec3 Background::sample(const Vec3 &direction) const
-{
-	Real altitude = 0.5 * (direction.y + 1.0);
-	return lerp(bottom, top, altitude);
-}
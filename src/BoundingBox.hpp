@@ -0,0 +1,96 @@
+#pragma once
+
+#include "Common.hpp"
+
+#include "Math.hpp"
+#include "Ray.hpp"
+#include "Vec3.hpp"
+
+// Axis aligned bounding box, empty until extended
+class BoundingBox
+{
+public:
+	Vec3 minimum;
+	Vec3 maximum;
+
+	BoundingBox() : minimum(math::maxReal(), math::maxReal(), math::maxReal()), maximum(-math::maxReal(), -math::maxReal(), -math::maxReal()) {}
+	BoundingBox(const Vec3 &_minimum, const Vec3 &_maximum) { minimum = _minimum; maximum = _maximum; }
+
+	inline bool isEmpty() const { return minimum.x > maximum.x || minimum.y > maximum.y || minimum.z > maximum.z; }
+	inline Vec3 center() const { return (minimum + maximum) * 0.5; }
+	inline Vec3 extents() const { return maximum - minimum; }
+	inline Real surfaceArea() const;
+	inline uint largestAxis() const;
+
+	inline BoundingBox &extend(const Vec3 &point);
+	inline BoundingBox &extend(const BoundingBox &box);
+
+	// Slab test, the inverse of the ray direction is given to share its computation across boxes
+	inline bool hit(const Vec3 &origin, const Vec3 &invDirection, Real minDist, Real maxDist, Real &entryDist) const;
+	// Squared distance from a point to the box, zero inside
+	inline Real squaredDistance(const Vec3 &point) const;
+};
+
+inline Real BoundingBox::surfaceArea() const
+{
+	if (isEmpty())
+		return 0;
+	Vec3 e = extents();
+	return 2 * (e.x * e.y + e.y * e.z + e.z * e.x);
+}
+
+inline uint BoundingBox::largestAxis() const
+{
+	Vec3 e = extents();
+	if (e.x > e.y && e.x > e.z)
+		return 0;
+	return e.y > e.z ? 1 : 2;
+}
+
+inline BoundingBox &BoundingBox::extend(const Vec3 &point)
+{
+	minimum = min(minimum, point);
+	maximum = max(maximum, point);
+	return *this;
+}
+
+inline BoundingBox &BoundingBox::extend(const BoundingBox &box)
+{
+	minimum = min(minimum, box.minimum);
+	maximum = max(maximum, box.maximum);
+	return *this;
+}
+
+inline bool BoundingBox::hit(const Vec3 &origin, const Vec3 &invDirection, Real minDist, Real maxDist, Real &entryDist) const
+{
+	for (uint i = 0; i < 3; i++)
+	{
+		Real t0 = (minimum[i] - origin[i]) * invDirection[i];
+		Real t1 = (maximum[i] - origin[i]) * invDirection[i];
+		if (invDirection[i] < 0)
+		{
+			Real tmp = t0;
+			t0 = t1;
+			t1 = tmp;
+		}
+		// Written so that NaNs from 0 * inf leave the bounds untouched
+		minDist = t0 > minDist ? t0 : minDist;
+		maxDist = t1 < maxDist ? t1 : maxDist;
+		if (maxDist < minDist)
+			return false;
+	}
+	entryDist = minDist;
+	return true;
+}
+
+inline Real BoundingBox::squaredDistance(const Vec3 &point) const
+{
+	Vec3 d = max(max(minimum - point, point - maximum), Vec3());
+	return d.squaredLength();
+}
+
+inline std::ostream &operator<<(std::ostream &os, const BoundingBox &b)
+{
+	os << "BoundingBox(" << b.minimum << ", " << b.maximum << ")";
+	return os;
+}
@@ -0,0 +1,80 @@
+#include "Box.hpp"
+
+Box::Box(const Transform &t, const Vec3 &extents, const Material &_material)
+{
+	transform = t;
+	halfExtents = extents * 0.5;
+	material = &_material;
+}
+
+// Efficient hit implementation from http://www.jcgt.org/published/0007/03/04/paper-lowres.pdf
+bool Box::hit(const Ray &r, Real minDist, Real maxDist, HitRecord &rec) const
+{
+	// Transform the ray into box space
+	Ray ray = transform.applyInverse(r);
+
+	Real winding = (max(abs(ray.origin()) / halfExtents) < 1.0) ? -1 : 1;
+	Vec3 sgn = -sign(ray.direction());
+
+	// Distance to plane
+	Vec3 d = halfExtents * winding * sgn - ray.origin();
+	d /= ray.direction();
+
+	if ((d.x >= 0.0) &&
+		math::abs(ray.origin().y + ray.direction().y * d.x) < halfExtents.y &&
+		math::abs(ray.origin().z + ray.direction().z * d.x) < halfExtents.z)
+	{
+		sgn = Vec3(sgn.x, 0.0, 0.0);
+	}
+	else if ((d.y >= 0.0) &&
+		math::abs(ray.origin().z + ray.direction().z * d.y) < halfExtents.z &&
+		math::abs(ray.origin().x + ray.direction().x * d.y) < halfExtents.x)
+	{
+		sgn = Vec3(0.0, sgn.y, 0.0);
+	}
+	else if ((d.z >= 0.0) &&
+		math::abs(ray.origin().x + ray.direction().x * d.z) < halfExtents.x &&
+		math::abs(ray.origin().y + ray.direction().y * d.z) < halfExtents.y)
+	{
+		sgn = Vec3(0.0, 0.0, sgn.z);
+	}
+	else
+	{
+		sgn = Vec3();
+	}
+
+	Real hitDistance = (sgn.x != 0) ? d.x : ((sgn.y != 0) ? d.y : d.z);
+	hitDistance *= transform.scale();
+	if (any(sgn) && hitDistance > minDist && hitDistance < maxDist)
+	{
+		rec.t = hitDistance;
+		rec.point = r.to(rec.t);
+		rec.normal = transform.applyRotation(sgn);
+
+		// Each face maps to the unit square, along the two other axes
+		uint axis = sgn.x != 0 ? 0 : (sgn.y != 0 ? 1 : 2);
+		uint uAxis = axis == 0 ? 2 : 0;
+		uint vAxis = axis == 1 ? 2 : 1;
+		Vec3 local = ray.to(hitDistance * transform.inverseScale());
+		rec.u = Real(0.5) + local[uAxis] / (2 * halfExtents[uAxis]);
+		rec.v = Real(0.5) + local[vAxis] / (2 * halfExtents[vAxis]);
+		rec.uvDensity = transform.inverseScale() / (2 * math::min(halfExtents[uAxis], halfExtents[vAxis]));
+		rec.hitable = this;
+		return true;
+	}
+
+	return false;
+}
+
+Real Box::evaluateSDF(const Vec3 &point) const
+{
+	Vec3 p = transform.applyInverse(point);
+	Vec3 diff = (abs(p) - halfExtents) * transform.scale();
+	return max(diff, Vec3()).length() + math::min(max(diff), Real(0));
+}
+
+bool Box::boundingBox(BoundingBox &box) const
+{
+	box = transform.apply(BoundingBox(-halfExtents, halfExtents));
+	return true;
+}
@@ -0,0 +1,161 @@
+#include "Bvh.hpp"
+
+#include <cstdint>
+#include <utility>
+
+void Bvh::build(const std::vector<BoundingBox> &primitiveBounds)
+{
+	clear();
+
+	uint primitiveAmount = uint(primitiveBounds.size());
+	if (primitiveAmount == 0)
+		return;
+
+	std::vector<Vec3> centroids;
+	centroids.reserve(primitiveAmount);
+	ownedReferences.resize(primitiveAmount);
+	for (uint i = 0; i < primitiveAmount; i++)
+	{
+		centroids.push_back(primitiveBounds[i].center());
+		ownedReferences[i] = i;
+	}
+
+	ownedNodes.reserve(2 * primitiveAmount);
+	buildRecursive(primitiveBounds, centroids, 0, primitiveAmount, 0);
+	ownedNodes.shrink_to_fit();
+
+	setData(ownedNodes.data(), uint(ownedNodes.size()), ownedReferences.data(), uint(ownedReferences.size()));
+}
+
+void Bvh::buildRecursive(const std::vector<BoundingBox> &bounds, const std::vector<Vec3> &centroids, uint begin, uint end, uint depth)
+{
+	uint nodeIndex = uint(ownedNodes.size());
+	ownedNodes.push_back(BvhNode());
+
+	BoundingBox nodeBounds;
+	BoundingBox centroidBounds;
+	for (uint i = begin; i < end; i++)
+	{
+		nodeBounds.extend(bounds[ownedReferences[i]]);
+		centroidBounds.extend(centroids[ownedReferences[i]]);
+	}
+	ownedNodes[nodeIndex].bounds = nodeBounds;
+
+	uint count = end - begin;
+	uint axis = centroidBounds.largestAxis();
+	Real axisMin = centroidBounds.minimum[axis];
+	Real axisExtent = centroidBounds.maximum[axis] - axisMin;
+	if (count <= maxLeafSize || depth >= maxDepth - 1 || axisExtent <= 0)
+	{
+		ownedNodes[nodeIndex].offset = begin;
+		ownedNodes[nodeIndex].count = count;
+		return;
+	}
+
+	// Bin primitives along the largest axis of their centroids
+	BoundingBox binBounds[binAmount];
+	uint binCounts[binAmount] = {};
+	Real binScale = Real(binAmount) / axisExtent;
+	for (uint i = begin; i < end; i++)
+	{
+		uint primitive = ownedReferences[i];
+		uint bin = math::min(uint((centroids[primitive][axis] - axisMin) * binScale), binAmount - 1);
+		binBounds[bin].extend(bounds[primitive]);
+		binCounts[bin]++;
+	}
+
+	// Sweep from the right to get the cost of every right partition, then from the left
+	Real rightCosts[binAmount];
+	BoundingBox accumulated;
+	uint accumulatedCount = 0;
+	for (uint bin = binAmount - 1; bin > 0; bin--)
+	{
+		accumulated.extend(binBounds[bin]);
+		accumulatedCount += binCounts[bin];
+		rightCosts[bin] = accumulated.surfaceArea() * accumulatedCount;
+	}
+
+	Real bestCost = math::maxReal();
+	uint bestSplit = 0;
+	accumulated = BoundingBox();
+	accumulatedCount = 0;
+	for (uint bin = 0; bin < binAmount - 1; bin++)
+	{
+		accumulated.extend(binBounds[bin]);
+		accumulatedCount += binCounts[bin];
+		Real cost = accumulated.surfaceArea() * accumulatedCount + rightCosts[bin + 1];
+		if (cost < bestCost)
+		{
+			bestCost = cost;
+			bestSplit = bin;
+		}
+	}
+
+	uint *first = &ownedReferences[begin];
+	uint *last = first + count;
+	uint *middle = std::partition(first, last, [&](uint primitive)
+	{
+		return math::min(uint((centroids[primitive][axis] - axisMin) * binScale), binAmount - 1) <= bestSplit;
+	});
+	uint split = begin + uint(middle - first);
+	if (split == begin || split == end)
+		split = begin + count / 2;
+
+	buildRecursive(bounds, centroids, begin, split, depth + 1);
+	ownedNodes[nodeIndex].offset = uint(ownedNodes.size());
+	buildRecursive(bounds, centroids, split, end, depth + 1);
+}
+
+void Bvh::setData(const BvhNode *_nodes, uint _nodeAmount, const uint *_references, uint _referenceAmount)
+{
+	nodes = _nodes;
+	nodeAmount = _nodeAmount;
+	references = _references;
+	referenceAmount = _referenceAmount;
+}
+
+void Bvh::clear()
+{
+	ownedNodes.clear();
+	ownedReferences.clear();
+	setData(nullptr, 0, nullptr, 0);
+}
+
+bool Bvh::isValid(const BvhNode *nodes, uint nodeAmount, const uint *references, uint referenceAmount, uint primitiveAmount)
+{
+	for (uint i = 0; i < referenceAmount; i++)
+	{
+		if (references[i] >= primitiveAmount)
+			return false;
+	}
+	if (nodeAmount == 0)
+		return true;
+
+	// Each node is reached once, along with the number of interior nodes above it, which the traversals stack
+	std::vector<bool> visited(nodeAmount, false);
+	std::vector<std::pair<uint, uint>> pending(1, std::make_pair(0u, 0u));
+	while (!pending.empty())
+	{
+		uint index = pending.back().first;
+		uint depth = pending.back().second;
+		pending.pop_back();
+		if (index >= nodeAmount || visited[index])
+			return false;
+		visited[index] = true;
+
+		const BvhNode &node = nodes[index];
+		if (node.count > 0)
+		{
+			if (uint64_t(node.offset) + node.count > referenceAmount)
+				return false;
+		}
+		else
+		{
+			if (depth >= maxDepth)
+				return false;
+			pending.push_back(std::make_pair(index + 1, depth + 1));
+			pending.push_back(std::make_pair(node.offset, depth + 1));
+		}
+	}
+	return true;
+}
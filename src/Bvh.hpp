@@ -0,0 +1,231 @@
+#pragma once
+
+#include "Common.hpp"
+
+#include "BoundingBox.hpp"
+#include "Math.hpp"
+#include "Ray.hpp"
+#include "Stats.hpp"
+#include "Vec3.hpp"
+
+#include <algorithm>
+#include <vector>
+
+// Flattened node, stored depth first so that the first child of an interior node directly follows it.
+// Plain data, so a built hierarchy can be written out and used back in place.
+struct BvhNode
+{
+	BoundingBox bounds;
+	// Leaves: index of the first primitive reference. Interior nodes: index of the second child.
+	uint offset = 0;
+	// Number of primitives in a leaf, zero for interior nodes
+	uint count = 0;
+};
+
+// Bounding volume hierarchy over an indexed set of primitives, built with binned SAH.
+// Primitives are only known through their bounds, intersection and distance queries are delegated
+// to functors receiving the primitive index.
+class Bvh
+{
+private:
+	static const uint maxLeafSize = 4;
+	static const uint binAmount = 12;
+	static const uint maxDepth = 64;
+
+	std::vector<BvhNode> ownedNodes;
+	std::vector<uint> ownedReferences;
+	const BvhNode *nodes = nullptr;
+	const uint *references = nullptr;
+	uint nodeAmount = 0;
+	uint referenceAmount = 0;
+
+	void buildRecursive(const std::vector<BoundingBox> &bounds, const std::vector<Vec3> &centroids, uint begin, uint end, uint depth);
+
+public:
+	Bvh() {}
+	Bvh(const Bvh &other) = delete;
+	Bvh &operator=(const Bvh &other) = delete;
+
+	void build(const std::vector<BoundingBox> &primitiveBounds);
+	// Use externally owned nodes and references, e.g. from a mapped file
+	void setData(const BvhNode *_nodes, uint _nodeAmount, const uint *_references, uint _referenceAmount);
+	void clear();
+
+	// Whether external data can be traversed: a tree reached from the root with children, leaf ranges and
+	// references in bounds, and no deeper than the traversal stacks
+	static bool isValid(const BvhNode *nodes, uint nodeAmount, const uint *references, uint referenceAmount, uint primitiveAmount);
+
+	bool isEmpty() const { return nodeAmount == 0; }
+	BoundingBox bounds() const { return nodeAmount ? nodes[0].bounds : BoundingBox(); }
+	const BvhNode *getNodes() const { return nodes; }
+	uint getNodeAmount() const { return nodeAmount; }
+	const uint *getReferences() const { return references; }
+	uint getReferenceAmount() const { return referenceAmount; }
+
+	// The intersector is called as intersector(primitiveIndex, ray, minDist, maxDist) and must return
+	// true and shrink maxDist when it finds a closer hit.
+	template <typename Intersector>
+	bool intersect(const Ray &r, Real minDist, Real &maxDist, Intersector &intersector) const;
+
+	// The distance functor is called as distance(primitiveIndex, point) and returns a squared distance.
+	// Returns the smallest squared distance found, or maxReal if the hierarchy is empty.
+	template <typename Distance>
+	Real closestSquared(const Vec3 &point, Distance &distance, uint &closestPrimitive) const;
+};
+
+template <typename Intersector>
+bool Bvh::intersect(const Ray &r, Real minDist, Real &maxDist, Intersector &intersector) const
+{
+	if (nodeAmount == 0)
+		return false;
+
+	const Vec3 &origin = r.origin();
+	Vec3 invDirection = Real(1) / r.direction();
+
+	Real entryDist;
+	statsIncrement(BoundsTests);
+	if (!nodes[0].bounds.hit(origin, invDirection, minDist, maxDist, entryDist))
+		return false;
+
+	struct StackEntry
+	{
+		uint node;
+		Real entryDist;
+	};
+	StackEntry stack[maxDepth];
+	uint stackSize = 0;
+
+	bool hit = false;
+	uint nodeIndex = 0;
+	while (true)
+	{
+		const BvhNode &node = nodes[nodeIndex];
+		if (node.count > 0)
+		{
+			for (uint i = 0; i < node.count; i++)
+			{
+				if (intersector(references[node.offset + i], r, minDist, maxDist))
+					hit = true;
+			}
+		}
+		else
+		{
+			uint first = nodeIndex + 1;
+			uint second = node.offset;
+			Real firstEntry, secondEntry;
+			statsAdd(BoundsTests, 2);
+			bool hitFirst = nodes[first].bounds.hit(origin, invDirection, minDist, maxDist, firstEntry);
+			bool hitSecond = nodes[second].bounds.hit(origin, invDirection, minDist, maxDist, secondEntry);
+			if (hitFirst && hitSecond)
+			{
+				// Visit the nearest child first and defer the other one
+				if (secondEntry < firstEntry)
+				{
+					std::swap(first, second);
+					std::swap(firstEntry, secondEntry);
+				}
+				stack[stackSize].node = second;
+				stack[stackSize].entryDist = secondEntry;
+				stackSize++;
+				nodeIndex = first;
+				continue;
+			}
+			else if (hitFirst || hitSecond)
+			{
+				nodeIndex = hitFirst ? first : second;
+				continue;
+			}
+		}
+
+		// Pop the next node still closer than the current hit
+		bool found = false;
+		while (stackSize > 0)
+		{
+			stackSize--;
+			if (stack[stackSize].entryDist <= maxDist)
+			{
+				nodeIndex = stack[stackSize].node;
+				found = true;
+				break;
+			}
+		}
+		if (!found)
+			break;
+	}
+
+	return hit;
+}
+
+template <typename Distance>
+Real Bvh::closestSquared(const Vec3 &point, Distance &distance, uint &closestPrimitive) const
+{
+	Real best = math::maxReal();
+	if (nodeAmount == 0)
+		return best;
+
+	struct StackEntry
+	{
+		uint node;
+		Real squaredDist;
+	};
+	StackEntry stack[maxDepth];
+	uint stackSize = 0;
+
+	uint nodeIndex = 0;
+	while (true)
+	{
+		const BvhNode &node = nodes[nodeIndex];
+		if (node.count > 0)
+		{
+			for (uint i = 0; i < node.count; i++)
+			{
+				uint primitive = references[node.offset + i];
+				Real d = distance(primitive, point);
+				if (d < best)
+				{
+					best = d;
+					closestPrimitive = primitive;
+				}
+			}
+		}
+		else
+		{
+			uint first = nodeIndex + 1;
+			uint second = node.offset;
+			Real firstDist = nodes[first].bounds.squaredDistance(point);
+			Real secondDist = nodes[second].bounds.squaredDistance(point);
+			if (secondDist < firstDist)
+			{
+				std::swap(first, second);
+				std::swap(firstDist, secondDist);
+			}
+			if (secondDist < best)
+			{
+				stack[stackSize].node = second;
+				stack[stackSize].squaredDist = secondDist;
+				stackSize++;
+			}
+			if (firstDist < best)
+			{
+				nodeIndex = first;
+				continue;
+			}
+		}
+
+		bool found = false;
+		while (stackSize > 0)
+		{
+			stackSize--;
+			if (stack[stackSize].squaredDist < best)
+			{
+				nodeIndex = stack[stackSize].node;
+				found = true;
+				break;
+			}
+		}
+		if (!found)
+			break;
+	}
+
+	return best;
+}
@@ -0,0 +1,33 @@
+#include "Camera.hpp"
+
+Camera::Camera(const Vec3 &_position, const Vec3 &_direction, const Vec3 &_up, Real fovY, const Viewport &_viewport, Real aperture, Real focus)
+{
+	viewport = _viewport;
+	position = _position;
+	lensRadius = aperture * 0.5;
+
+	Real theta = fovY * (math::pi() / 180.0);
+	Real halfHeight = tan(theta * 0.5);
+	Real halfWidth = halfHeight * viewport.aspectRatio();
+
+	Vec3 direction = normalize(_direction);
+	right = normalize(cross(direction, _up));
+	up = cross(right, direction);
+
+	bottomLeft = position + focus * (-halfWidth * right - halfHeight * up + direction);
+	horizontal = 2.0 * halfWidth * focus * right;
+	vertical = 2.0 * halfHeight * focus * up;
+	pixelSpread = 2.0 * halfHeight / Real(viewport.height());
+}
+
+Ray Camera::getRay(Real u, Real v, bool useDepthOfField) const
+{
+	Vec3 start = position;
+	if (depthOfFieldEnabled && useDepthOfField)
+	{
+		Vec3 sample = lensRadius * sampleUnitDisk();
+		Vec3 offset = right * sample.x + up * sample.y;
+		start += offset;
+	}
+	return Ray(start, bottomLeft + u * horizontal + v * vertical - start, pixelSpread);
+}
@@ -0,0 +1,56 @@
+#include "CheckerTexture.hpp"
+#include "TextureProgram.hpp"
+
+CheckerTexture::CheckerTexture(const Vec3 &albedo1, const Vec3 &albedo2, const Vec3 &_frequency)
+{
+	texture1 = new ConstantTexture(albedo1);
+	texture2 = new ConstantTexture(albedo2);
+	halfPeriods = _frequency / math::pi();
+	ownedTextures = true;
+}
+
+CheckerTexture::CheckerTexture(const Texture &_texture1, const Texture &_texture2, const Vec3 &_frequency)
+{
+	texture1 = &_texture1;
+	texture2 = &_texture2;
+	halfPeriods = _frequency / math::pi();
+}
+
+CheckerTexture::~CheckerTexture()
+{
+	if (ownedTextures)
+	{
+		delete texture1;
+		delete texture2;
+	}
+}
+
+Vec3 CheckerTexture::sample(const Vec3& position) const
+{
+	if (selectsFirst(halfPeriods, position))
+		return texture1->sample(position);
+	else
+		return texture2->sample(position);
+}
+
+Vec3 CheckerTexture::sampleSurface(const TextureCoordinates &coordinates) const
+{
+	if (selectsFirst(halfPeriods, coordinates.position))
+		return texture1->sampleSurface(coordinates);
+	else
+		return texture2->sampleSurface(coordinates);
+}
+
+uint CheckerTexture::compile(TextureProgram &program) const
+{
+	TextureNode node;
+	node.op = TextureOp::Checker;
+	node.value = halfPeriods;
+	uint index = program.addNode(node);
+	// Added after the checker, the node may have moved
+	uint child1 = program.add(*texture1);
+	uint child2 = program.add(*texture2);
+	program.getNode(index).child1 = child1;
+	program.getNode(index).child2 = child2;
+	return index;
+}
@@ -3,15 +3,22 @@
 #include "Common.hpp"
 
 #include "ConstantTexture.hpp"
+#include "Math.hpp"
 #include "Vec3.hpp"
 #include "Texture.hpp"
 
+#include <cmath>
+#include <cstdint>
+
+// texture1 where the product of sin(frequency * position) over the axes is not negative, texture2 elsewhere.
+// A zero frequency on any axis makes the product 0, so texture1 everywhere.
 class CheckerTexture : public Texture
 {
 private:
 	const Texture *texture1 = nullptr;
 	const Texture *texture2 = nullptr;
-	Vec3 frequency;
+	// Frequency over pi
+	Vec3 halfPeriods;
 	bool ownedTextures = false;
 
 public:
@@ -20,36 +27,19 @@ public:
 	~CheckerTexture();
 
 	virtual Vec3 sample(const Vec3& position) const override;
-};
-
-CheckerTexture::CheckerTexture(const Vec3 &albedo1, const Vec3 &albedo2, const Vec3 &_frequency)
-{
-	texture1 = new ConstantTexture(albedo1);
-	texture2 = new ConstantTexture(albedo2);
-	frequency = _frequency;
-	ownedTextures = true;
-}
+	virtual Vec3 sampleSurface(const TextureCoordinates &coordinates) const override;
+	virtual uint compile(TextureProgram &program) const override;
 
-CheckerTexture::CheckerTexture(const Texture &_texture1, const Texture &_texture2, const Vec3 &_frequency)
-{
-	texture1 = &_texture1;
-	texture2 = &_texture2;
-	frequency = _frequency;
-}
-
-CheckerTexture::~CheckerTexture()
-{
-	if (ownedTextures)
-	{
-		delete texture1;
-		delete texture2;
-	}
-}
+	// Without the sines: a sine is negative in the odd half periods, so the product is positive when the
+	// half period indices add up to an even number
+	static bool selectsFirst(const Vec3 &halfPeriods, const Vec3 &position);
+};
 
-Vec3 CheckerTexture::sample(const Vec3& position) const
+inline bool CheckerTexture::selectsFirst(const Vec3 &halfPeriods, const Vec3 &position)
 {
-	if ((sin(frequency.x * position.x) * sin(frequency.y * position.y) * sin(frequency.z * position.z)) >= 0)
-		return texture1->sample(position);
-	else
-		return texture2->sample(position);
+	if (halfPeriods.x == 0 || halfPeriods.y == 0 || halfPeriods.z == 0)
+		return true;
+	Vec3 p = halfPeriods * position;
+	int64_t sum = int64_t(std::floor(p.x)) + int64_t(std::floor(p.y)) + int64_t(std::floor(p.z));
+	return (sum & 1) == 0;
 }
@@ -1,5 +1,11 @@
 #pragma once
 
+// Precision used for geometry and shading. Define RAYTRACER_DOUBLE_PRECISION to trace in double,
+// image storage stays 32-bit float either way.
+#ifdef RAYTRACER_DOUBLE_PRECISION
+typedef double Real;
+#else
 typedef float Real;
+#endif
 typedef unsigned int uint;
 typedef unsigned char byte;
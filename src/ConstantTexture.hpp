@@ -4,6 +4,7 @@
 
 #include "Vec3.hpp"
 #include "Texture.hpp"
+#include "TextureProgram.hpp"
 
 class ConstantTexture : public Texture
 {
@@ -14,4 +15,11 @@ public:
 	ConstantTexture(const Vec3& _albedo) { albedo = _albedo; }
 
 	virtual Vec3 sample(const Vec3& position) const override { return albedo; }
+	virtual uint compile(TextureProgram &program) const override
+	{
+		TextureNode node;
+		node.op = TextureOp::Constant;
+		node.value = albedo;
+		return program.addNode(node);
+	}
 };
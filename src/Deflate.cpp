@@ -0,0 +1,448 @@
+#include "Deflate.hpp"
+
+#include <algorithm>
+#include <queue>
+
+namespace deflate
+{
+
+namespace
+{
+
+const uint windowSize = 32768;
+const uint minMatch = 3;
+const uint maxMatch = 258;
+const uint hashBits = 15;
+// Longer chains find better matches, at the cost of speed
+const uint maxChainLength = 64;
+
+const uint literalAmount = 286;
+const uint distanceAmount = 30;
+const uint codeLengthAmount = 19;
+const uint endOfBlock = 256;
+
+const uint16_t lengthBase[29] = {
+	3, 4, 5, 6, 7, 8, 9, 10, 11, 13, 15, 17, 19, 23, 27, 31, 35, 43, 51, 59, 67, 83, 99, 115, 131, 163, 195, 227, 258 };
+const byte lengthExtraBits[29] = {
+	0, 0, 0, 0, 0, 0, 0, 0, 1, 1, 1, 1, 2, 2, 2, 2, 3, 3, 3, 3, 4, 4, 4, 4, 5, 5, 5, 5, 0 };
+const uint16_t distanceBase[30] = {
+	1, 2, 3, 4, 5, 7, 9, 13, 17, 25, 33, 49, 65, 97, 129, 193, 257, 385, 513, 769, 1025, 1537, 2049, 3073, 4097,
+	6145, 8193, 12289, 16385, 24577 };
+const byte distanceExtraBits[30] = {
+	0, 0, 0, 0, 1, 1, 2, 2, 3, 3, 4, 4, 5, 5, 6, 6, 7, 7, 8, 8, 9, 9, 10, 10, 11, 11, 12, 12, 13, 13 };
+// Order in which the code length code lengths are written
+const byte codeLengthOrder[codeLengthAmount] = { 16, 17, 18, 0, 8, 7, 9, 6, 10, 5, 11, 4, 12, 3, 13, 2, 14, 1, 15 };
+
+// Literal when the distance is 0, otherwise the length of a match
+struct Symbol
+{
+	uint16_t value;
+	uint16_t distance;
+};
+
+// Bits are packed from the least significant one
+class BitWriter
+{
+private:
+	std::vector<byte> &out;
+	uint64_t bits = 0;
+	uint count = 0;
+
+public:
+	BitWriter(std::vector<byte> &_out) : out(_out) {}
+
+	void write(uint value, uint length)
+	{
+		bits |= uint64_t(value) << count;
+		count += length;
+		while (count >= 8)
+		{
+			out.push_back(byte(bits));
+			bits >>= 8;
+			count -= 8;
+		}
+	}
+
+	// Huffman codes are packed from their most significant bit
+	void writeCode(uint code, uint length)
+	{
+		uint reversed = 0;
+		for (uint i = 0; i < length; i++)
+			reversed |= ((code >> i) & 1) << (length - 1 - i);
+		write(reversed, length);
+	}
+
+	void flush()
+	{
+		if (count > 0)
+			out.push_back(byte(bits));
+		bits = 0;
+		count = 0;
+	}
+};
+
+class HuffmanCode
+{
+private:
+	std::vector<byte> lengths;
+	std::vector<uint16_t> codes;
+
+	void buildLengths(std::vector<uint> frequencies, uint maxLength);
+	void buildCodes();
+
+public:
+	// At least two symbols get a code, so that the code is always complete
+	HuffmanCode(const std::vector<uint> &frequencies, uint maxLength)
+	{
+		buildLengths(frequencies, maxLength);
+		buildCodes();
+	}
+
+	uint getLength(uint symbol) const { return lengths[symbol]; }
+	// Amount of symbols up to the last one with a code, at least minimum
+	uint usedAmount(uint minimum) const
+	{
+		uint amount = uint(lengths.size());
+		while (amount > minimum && lengths[amount - 1] == 0)
+			amount--;
+		return amount;
+	}
+	void write(BitWriter &writer, uint symbol) const { writer.writeCode(codes[symbol], lengths[symbol]); }
+};
+
+void HuffmanCode::buildLengths(std::vector<uint> frequencies, uint maxLength)
+{
+	uint symbolAmount = uint(frequencies.size());
+	uint used = uint(symbolAmount - std::count(frequencies.begin(), frequencies.end(), 0u));
+	for (uint symbol = 0; symbol < symbolAmount && used < 2; symbol++)
+	{
+		if (frequencies[symbol] == 0)
+		{
+			frequencies[symbol] = 1;
+			used++;
+		}
+	}
+
+	// Halving the frequencies flattens the tree until it fits the maximum length
+	while (true)
+	{
+		// The first nodes are the leaves, each node is created after its children
+		std::vector<uint> nodeSymbols;
+		std::vector<uint> parents;
+		typedef std::pair<uint64_t, uint> Entry;
+		std::priority_queue<Entry, std::vector<Entry>, std::greater<Entry>> queue;
+		for (uint symbol = 0; symbol < symbolAmount; symbol++)
+		{
+			if (frequencies[symbol] == 0)
+				continue;
+			queue.push(Entry(frequencies[symbol], uint(nodeSymbols.size())));
+			nodeSymbols.push_back(symbol);
+		}
+		parents.resize(nodeSymbols.size());
+		while (queue.size() > 1)
+		{
+			Entry first = queue.top();
+			queue.pop();
+			Entry second = queue.top();
+			queue.pop();
+			uint parent = uint(parents.size());
+			parents[first.second] = parent;
+			parents[second.second] = parent;
+			parents.push_back(0);
+			queue.push(Entry(first.first + second.first, parent));
+		}
+
+		std::vector<uint> depths(parents.size(), 0);
+		for (size_t node = parents.size() - 1; node-- > 0;)
+			depths[node] = depths[parents[node]] + 1;
+
+		lengths.assign(symbolAmount, 0);
+		uint longest = 0;
+		for (size_t leaf = 0; leaf < nodeSymbols.size(); leaf++)
+		{
+			lengths[nodeSymbols[leaf]] = byte(depths[leaf]);
+			longest = std::max(longest, depths[leaf]);
+		}
+		if (longest <= maxLength)
+			break;
+
+		for (uint &frequency : frequencies)
+		{
+			if (frequency > 0)
+				frequency = (frequency + 1) / 2;
+		}
+	}
+}
+
+// Canonical codes, consecutive within each length
+void HuffmanCode::buildCodes()
+{
+	uint lengthCounts[16] = {};
+	for (byte length : lengths)
+		lengthCounts[length]++;
+	lengthCounts[0] = 0;
+
+	uint nextCodes[16] = {};
+	uint code = 0;
+	for (uint length = 1; length < 16; length++)
+	{
+		code = (code + lengthCounts[length - 1]) << 1;
+		nextCodes[length] = code;
+	}
+
+	codes.assign(lengths.size(), 0);
+	for (size_t symbol = 0; symbol < lengths.size(); symbol++)
+	{
+		if (lengths[symbol] > 0)
+			codes[symbol] = uint16_t(nextCodes[lengths[symbol]]++);
+	}
+}
+
+uint lengthSymbol(uint length)
+{
+	uint symbol = 28;
+	while (lengthBase[symbol] > length)
+		symbol--;
+	return symbol;
+}
+
+uint distanceSymbol(uint distance)
+{
+	uint symbol = 29;
+	while (distanceBase[symbol] > distance)
+		symbol--;
+	return symbol;
+}
+
+uint hash(const byte *data)
+{
+	return ((uint(data[0]) << 10) ^ (uint(data[1]) << 5) ^ uint(data[2])) & ((1u << hashBits) - 1);
+}
+
+// Greedy LZ77 parse, the longest match found in the chain is always taken
+void findMatches(const byte *data, size_t size, std::vector<Symbol> &symbols)
+{
+	std::vector<int64_t> heads(size_t(1) << hashBits, -1);
+	std::vector<int64_t> previous(size, -1);
+	auto insert = [&](size_t position)
+	{
+		if (position + minMatch > size)
+			return;
+		uint h = hash(data + position);
+		previous[position] = heads[h];
+		heads[h] = int64_t(position);
+	};
+
+	size_t position = 0;
+	while (position < size)
+	{
+		uint bestLength = 0;
+		uint bestDistance = 0;
+		if (position + minMatch <= size)
+		{
+			uint longest = uint(std::min<size_t>(maxMatch, size - position));
+			int64_t candidate = heads[hash(data + position)];
+			for (uint chain = 0; candidate >= 0 && chain < maxChainLength; chain++)
+			{
+				size_t distance = position - size_t(candidate);
+				if (distance > windowSize)
+					break;
+				const byte *a = data + candidate;
+				const byte *b = data + position;
+				uint length = 0;
+				while (length < longest && a[length] == b[length])
+					length++;
+				if (length > bestLength)
+				{
+					bestLength = length;
+					bestDistance = uint(distance);
+					if (length == longest)
+						break;
+				}
+				candidate = previous[size_t(candidate)];
+			}
+		}
+
+		if (bestLength >= minMatch)
+		{
+			symbols.push_back({ uint16_t(bestLength), uint16_t(bestDistance) });
+			for (uint i = 0; i < bestLength; i++)
+				insert(position + i);
+			position += bestLength;
+		}
+		else
+		{
+			symbols.push_back({ data[position], 0 });
+			insert(position);
+			position++;
+		}
+	}
+}
+
+// Runs of code lengths, with the extra bits of the repeat codes
+struct CodeLengthSymbol
+{
+	byte value;
+	byte extra;
+};
+
+void encodeCodeLengths(const std::vector<byte> &lengths, std::vector<CodeLengthSymbol> &symbols)
+{
+	size_t i = 0;
+	while (i < lengths.size())
+	{
+		byte length = lengths[i];
+		size_t run = 1;
+		while (i + run < lengths.size() && lengths[i + run] == length)
+			run++;
+		i += run;
+
+		if (length == 0)
+		{
+			while (run >= 11)
+			{
+				size_t repeat = std::min<size_t>(run, 138);
+				symbols.push_back({ 18, byte(repeat - 11) });
+				run -= repeat;
+			}
+			if (run >= 3)
+			{
+				symbols.push_back({ 17, byte(run - 3) });
+				run = 0;
+			}
+		}
+		else
+		{
+			symbols.push_back({ length, 0 });
+			run--;
+			while (run >= 3)
+			{
+				size_t repeat = std::min<size_t>(run, 6);
+				symbols.push_back({ 16, byte(repeat - 3) });
+				run -= repeat;
+			}
+		}
+		for (; run > 0; run--)
+			symbols.push_back({ length, 0 });
+	}
+}
+
+void writeBlock(const std::vector<Symbol> &symbols, BitWriter &writer)
+{
+	std::vector<uint> literalFrequencies(literalAmount, 0);
+	std::vector<uint> distanceFrequencies(distanceAmount, 0);
+	for (const Symbol &symbol : symbols)
+	{
+		if (symbol.distance == 0)
+		{
+			literalFrequencies[symbol.value]++;
+		}
+		else
+		{
+			literalFrequencies[257 + lengthSymbol(symbol.value)]++;
+			distanceFrequencies[distanceSymbol(symbol.distance)]++;
+		}
+	}
+	literalFrequencies[endOfBlock]++;
+
+	HuffmanCode literalCode(literalFrequencies, 15);
+	HuffmanCode distanceCode(distanceFrequencies, 15);
+	uint usedLiterals = literalCode.usedAmount(257);
+	uint usedDistances = distanceCode.usedAmount(1);
+
+	// Both code lengths sequences are run length coded together
+	std::vector<byte> lengths;
+	for (uint symbol = 0; symbol < usedLiterals; symbol++)
+		lengths.push_back(byte(literalCode.getLength(symbol)));
+	for (uint symbol = 0; symbol < usedDistances; symbol++)
+		lengths.push_back(byte(distanceCode.getLength(symbol)));
+	std::vector<CodeLengthSymbol> lengthSymbols;
+	encodeCodeLengths(lengths, lengthSymbols);
+
+	std::vector<uint> codeLengthFrequencies(codeLengthAmount, 0);
+	for (const CodeLengthSymbol &symbol : lengthSymbols)
+		codeLengthFrequencies[symbol.value]++;
+	HuffmanCode codeLengthCode(codeLengthFrequencies, 7);
+	uint usedCodeLengths = codeLengthAmount;
+	while (usedCodeLengths > 4 && codeLengthCode.getLength(codeLengthOrder[usedCodeLengths - 1]) == 0)
+		usedCodeLengths--;
+
+	// Final block, dynamic Huffman codes
+	writer.write(1, 1);
+	writer.write(2, 2);
+	writer.write(usedLiterals - 257, 5);
+	writer.write(usedDistances - 1, 5);
+	writer.write(usedCodeLengths - 4, 4);
+	for (uint i = 0; i < usedCodeLengths; i++)
+		writer.write(codeLengthCode.getLength(codeLengthOrder[i]), 3);
+	for (const CodeLengthSymbol &symbol : lengthSymbols)
+	{
+		codeLengthCode.write(writer, symbol.value);
+		if (symbol.value == 16)
+			writer.write(symbol.extra, 2);
+		else if (symbol.value == 17)
+			writer.write(symbol.extra, 3);
+		else if (symbol.value == 18)
+			writer.write(symbol.extra, 7);
+	}
+
+	for (const Symbol &symbol : symbols)
+	{
+		if (symbol.distance == 0)
+		{
+			literalCode.write(writer, symbol.value);
+			continue;
+		}
+		uint length = lengthSymbol(symbol.value);
+		literalCode.write(writer, 257 + length);
+		writer.write(symbol.value - lengthBase[length], lengthExtraBits[length]);
+		uint distance = distanceSymbol(symbol.distance);
+		distanceCode.write(writer, distance);
+		writer.write(symbol.distance - distanceBase[distance], distanceExtraBits[distance]);
+	}
+	literalCode.write(writer, endOfBlock);
+}
+
+}	// namespace
+
+void compress(const byte *data, size_t size, std::vector<byte> &out)
+{
+	// Deflate with a 32 KiB window, default compression level
+	out.push_back(0x78);
+	out.push_back(0x9c);
+
+	std::vector<Symbol> symbols;
+	symbols.reserve(size / 2);
+	findMatches(data, size, symbols);
+	BitWriter writer(out);
+	writeBlock(symbols, writer);
+	writer.flush();
+
+	uint32_t checksum = adler32(data, size);
+	for (int shift = 24; shift >= 0; shift -= 8)
+		out.push_back(byte(checksum >> shift));
+}
+
+uint32_t adler32(const byte *data, size_t size)
+{
+	const uint32_t modulus = 65521;
+	// Largest amount of bytes summed before the sums can overflow
+	const size_t blockSize = 5552;
+	uint32_t a = 1;
+	uint32_t b = 0;
+	while (size > 0)
+	{
+		size_t amount = std::min(size, blockSize);
+		size -= amount;
+		for (; amount > 0; amount--)
+		{
+			a += *data++;
+			b += a;
+		}
+		a %= modulus;
+		b %= modulus;
+	}
+	return (b << 16) | a;
+}
+
+}	// namespace deflate
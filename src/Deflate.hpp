@@ -0,0 +1,19 @@
+#pragma once
+
+#include "Common.hpp"
+
+#include <cstddef>
+#include <cstdint>
+#include <vector>
+
+// Lossless compression into the zlib format (RFC 1950 and 1951), readable by any inflater.
+// Matches are searched in hash chains over a 32 KiB window and coded in a single dynamic Huffman block.
+namespace deflate
+{
+
+// Appends the compressed stream to out
+void compress(const byte *data, size_t size, std::vector<byte> &out);
+
+uint32_t adler32(const byte *data, size_t size);
+
+}	// namespace deflate
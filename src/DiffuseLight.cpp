@@ -0,0 +1,6 @@
+#include "DiffuseLight.hpp"
+
+Vec3 DiffuseLight::emitted(const Vec3 &p) const
+{
+	return albedo;
+}
@@ -0,0 +1,493 @@
+#include "Exr.hpp"
+#include "Deflate.hpp"
+#include "File.hpp"
+#include "Half.hpp"
+#include "Trace.hpp"
+
+#include <algorithm>
+#include <cstdint>
+#include <cstring>
+#include <iostream>
+#include <memory>
+#include <utility>
+
+namespace file
+{
+
+namespace
+{
+
+const uint zipScanlines = 16;
+
+struct Channel
+{
+	std::string name;
+	// First sample of the bottom row
+	const float *data = nullptr;
+	// Floats from one pixel to the next, and from one row to the next
+	uint stride = 0;
+	size_t rowStride = 0;
+	ExrValues values = ExrValuesColour;
+
+	bool operator<(const Channel &other) const { return name < other.name; }
+};
+
+// Region of the image in EXR coordinates, y going down
+struct Chunk
+{
+	uint x = 0;
+	uint y = 0;
+	uint width = 0;
+	uint height = 0;
+	uint tileX = 0;
+	uint tileY = 0;
+};
+
+// Everything is little endian
+template <typename T>
+void put(std::vector<char> &buffer, T value)
+{
+	for (uint i = 0; i < sizeof(T); i++)
+		buffer.push_back(char((uint64_t(value) >> (8 * i)) & 0xff));
+}
+
+void putFloat(std::vector<char> &buffer, float value)
+{
+	uint32_t bits;
+	std::memcpy(&bits, &value, sizeof(bits));
+	put(buffer, bits);
+}
+
+void putString(std::vector<char> &buffer, const std::string &text)
+{
+	buffer.insert(buffer.end(), text.begin(), text.end());
+	buffer.push_back('\0');
+}
+
+void putAttribute(std::vector<char> &buffer, const char *name, const char *type, uint32_t size)
+{
+	putString(buffer, name);
+	putString(buffer, type);
+	put(buffer, size);
+}
+
+// Pixels are stored from the top row of data, above the image when it is negative.
+// Tiles may come in any order when streamed.
+void putHeader(std::vector<char> &buffer, const std::vector<Channel> &channels, uint width, uint height, const ExrOptions &options,
+	int top = 0, bool randomOrder = false)
+{
+	// Magic number and version 2, flagged as single part tiled when needed
+	put(buffer, uint32_t(20000630));
+	put(buffer, uint32_t(2 | (options.tiled ? 0x200 : 0)));
+
+	uint32_t channelListSize = 1;
+	for (const Channel &channel : channels)
+		channelListSize += uint32_t(channel.name.size() + 1 + 16);
+	putAttribute(buffer, "channels", "chlist", channelListSize);
+	for (const Channel &channel : channels)
+	{
+		putString(buffer, channel.name);
+		put(buffer, int32_t(options.pixelType == ExrPixelTypeHalf ? 1 : 2));
+		// Perceptually linear flag and reserved bytes, then the sampling
+		put(buffer, uint32_t(0));
+		put(buffer, int32_t(1));
+		put(buffer, int32_t(1));
+	}
+	buffer.push_back('\0');
+
+	const byte compressionCodes[3] = { 0, 1, 3 };
+	putAttribute(buffer, "compression", "compression", 1);
+	buffer.push_back(char(compressionCodes[options.compression]));
+
+	const char *windows[2] = { "dataWindow", "displayWindow" };
+	for (const char *window : windows)
+	{
+		putAttribute(buffer, window, "box2i", 16);
+		put(buffer, int32_t(0));
+		put(buffer, int32_t(window == windows[0] ? top : 0));
+		put(buffer, int32_t(width - 1));
+		put(buffer, int32_t(height - 1));
+	}
+
+	// Increasing or random y
+	putAttribute(buffer, "lineOrder", "lineOrder", 1);
+	buffer.push_back(char(randomOrder ? 2 : 0));
+
+	putAttribute(buffer, "pixelAspectRatio", "float", 4);
+	putFloat(buffer, 1.0f);
+	putAttribute(buffer, "screenWindowCenter", "v2f", 8);
+	putFloat(buffer, 0.0f);
+	putFloat(buffer, 0.0f);
+	putAttribute(buffer, "screenWindowWidth", "float", 4);
+	putFloat(buffer, 1.0f);
+
+	if (options.tiled)
+	{
+		// One level only
+		putAttribute(buffer, "tiles", "tiledesc", 9);
+		put(buffer, uint32_t(options.tileSize));
+		put(buffer, uint32_t(options.tileSize));
+		buffer.push_back('\0');
+	}
+
+	buffer.push_back('\0');
+}
+
+// Each row of the chunk holds all the samples of the first channel, then those of the next
+void gatherSamples(const std::vector<Channel> &channels, const Chunk &chunk, uint sourceHeight, ExrPixelType pixelType, std::vector<byte> &out)
+{
+	uint sampleSize = pixelType == ExrPixelTypeHalf ? 2 : 4;
+	out.resize(size_t(chunk.width) * chunk.height * channels.size() * sampleSize);
+	byte *sample = out.data();
+	for (uint y = chunk.y; y < chunk.y + chunk.height; y++)
+	{
+		// Images start at the bottom
+		size_t row = sourceHeight - 1 - y;
+		for (const Channel &channel : channels)
+		{
+			const float *in = channel.data + row * channel.rowStride + size_t(chunk.x) * channel.stride;
+			for (uint x = 0; x < chunk.width; x++, in += channel.stride)
+			{
+				float value = decodeValue(*in, channel.values);
+				if (pixelType == ExrPixelTypeHalf)
+				{
+					uint16_t half = floatToHalf(value);
+					*sample++ = byte(half);
+					*sample++ = byte(half >> 8);
+				}
+				else
+				{
+					uint32_t bits;
+					std::memcpy(&bits, &value, sizeof(bits));
+					for (uint i = 0; i < 4; i++)
+						*sample++ = byte(bits >> (8 * i));
+				}
+			}
+		}
+	}
+}
+
+// Splits the bytes of the samples into two halves and stores the differences between consecutive bytes,
+// which brings smooth images close to constant runs
+void predict(const std::vector<byte> &in, std::vector<byte> &out)
+{
+	out.resize(in.size());
+	size_t half = (in.size() + 1) / 2;
+	for (size_t i = 0; i < in.size(); i++)
+		out[(i & 1) ? half + i / 2 : i / 2] = in[i];
+	for (size_t i = out.size(); i-- > 1;)
+		out[i] = byte(int(out[i]) - int(out[i - 1]) + 128);
+}
+
+// Runs of 3 to 128 equal bytes are stored as their length minus one and the byte,
+// anything else as minus the amount of bytes that follow
+void runLengthEncode(const std::vector<byte> &in, std::vector<byte> &out)
+{
+	const size_t minRun = 3;
+	const size_t maxRun = 127;
+	const byte *start = in.data();
+	const byte *end = start + in.size();
+	const byte *runEnd = start + 1;
+	while (start < end)
+	{
+		while (runEnd < end && *start == *runEnd && size_t(runEnd - start - 1) < maxRun)
+			runEnd++;
+		if (size_t(runEnd - start) >= minRun)
+		{
+			out.push_back(byte(runEnd - start - 1));
+			out.push_back(*start);
+			start = runEnd;
+		}
+		else
+		{
+			while (runEnd < end &&
+				(runEnd + 1 >= end || *runEnd != *(runEnd + 1) || runEnd + 2 >= end || *(runEnd + 1) != *(runEnd + 2)) &&
+				size_t(runEnd - start) < maxRun)
+			{
+				runEnd++;
+			}
+			out.push_back(byte(-int(runEnd - start)));
+			out.insert(out.end(), start, runEnd);
+			start = runEnd;
+		}
+		runEnd++;
+	}
+}
+
+// Chunks that do not get smaller are stored uncompressed, which readers detect by their size
+void compress(const std::vector<byte> &samples, ExrCompression compression, std::vector<byte> &predicted, std::vector<byte> &out)
+{
+	out.clear();
+	if (compression != ExrCompressionNone)
+	{
+		predict(samples, predicted);
+		if (compression == ExrCompressionRle)
+			runLengthEncode(predicted, out);
+		else
+			deflate::compress(predicted.data(), predicted.size(), out);
+	}
+	if (compression == ExrCompressionNone || out.size() >= samples.size())
+		out = samples;
+}
+
+// R, G and B of tightly packed pixels
+std::vector<Channel> colourChannels(const float *pixels, uint width)
+{
+	const char *names[3] = { "B", "G", "R" };
+	std::vector<Channel> channels(3);
+	for (uint i = 0; i < 3; i++)
+	{
+		channels[i].name = names[i];
+		channels[i].data = pixels ? pixels + 2 - i : nullptr;
+		channels[i].stride = 3;
+		channels[i].rowStride = size_t(width) * 3;
+	}
+	return channels;
+}
+
+void putChunk(std::vector<char> &buffer, const Chunk &chunk, bool tiled, const std::vector<byte> &data)
+{
+	if (tiled)
+	{
+		put(buffer, int32_t(chunk.tileX));
+		put(buffer, int32_t(chunk.tileY));
+		// Level
+		put(buffer, int32_t(0));
+		put(buffer, int32_t(0));
+	}
+	else
+	{
+		put(buffer, int32_t(chunk.y));
+	}
+	put(buffer, int32_t(data.size()));
+	buffer.insert(buffer.end(), data.begin(), data.end());
+}
+
+// Layers in other colour formats than float are read from the float copies kept in converted
+bool collectChannels(const std::vector<ExrLayer> &layers, std::vector<Channel> &channels, std::vector<std::unique_ptr<Image>> &converted)
+{
+	const char *colourNames[3] = { "R", "G", "B" };
+	for (const ExrLayer &layer : layers)
+	{
+		converted.emplace_back();
+		const Image *source = floatImage(*layer.image, converted.back());
+		if (!source)
+		{
+			std::cerr << "Only colour images can be written as EXR layers." << std::endl;
+			return false;
+		}
+		const Image &image = *source;
+		if (image.getWidth() != layers[0].image->getWidth() || image.getHeight() != layers[0].image->getHeight())
+		{
+			std::cerr << "EXR layer '" << layer.name << "' does not have the size of the first layer." << std::endl;
+			return false;
+		}
+
+		uint stride = image.getChannelAmount();
+		uint channelAmount = layer.channelAmount > 0 ? math::min(layer.channelAmount, stride) : stride;
+		std::string prefix = layer.name.empty() ? "" : layer.name + ".";
+		for (uint i = 0; i < channelAmount; i++)
+		{
+			Channel channel;
+			channel.name = prefix + (channelAmount == 1 ? "Y" : colourNames[i]);
+			channel.data = reinterpret_cast<const float*>(image.getData()) + i;
+			channel.stride = stride;
+			channel.rowStride = size_t(image.getWidth()) * stride;
+			channel.values = layer.values;
+			channels.push_back(channel);
+		}
+	}
+
+	// Readers expect the channels sorted by name
+	std::sort(channels.begin(), channels.end());
+	for (size_t i = 1; i < channels.size(); i++)
+	{
+		if (channels[i].name == channels[i - 1].name)
+		{
+			std::cerr << "EXR channel " << channels[i].name << " is written twice." << std::endl;
+			return false;
+		}
+	}
+	return !channels.empty();
+}
+
+}	// namespace
+
+bool writeExr(const std::string &baseFileName, const std::vector<ExrLayer> &layers, const ExrOptions &options)
+{
+	trace::Scope scope("write exr", "io");
+	std::string fileName = withExtension(baseFileName, ".exr");
+	std::vector<Channel> channels;
+	std::vector<std::unique_ptr<Image>> converted;
+	if (layers.empty() || !collectChannels(layers, channels, converted))
+	{
+		std::cerr << "Could not write " << fileName << "." << std::endl;
+		return false;
+	}
+
+	uint width = layers[0].image->getWidth();
+	uint height = layers[0].image->getHeight();
+	std::vector<Chunk> chunks;
+	if (options.tiled)
+	{
+		uint tileSize = math::max(options.tileSize, 1u);
+		for (uint tileY = 0; tileY * tileSize < height; tileY++)
+		{
+			for (uint tileX = 0; tileX * tileSize < width; tileX++)
+			{
+				Chunk chunk;
+				chunk.x = tileX * tileSize;
+				chunk.y = tileY * tileSize;
+				chunk.width = math::min(tileSize, width - chunk.x);
+				chunk.height = math::min(tileSize, height - chunk.y);
+				chunk.tileX = tileX;
+				chunk.tileY = tileY;
+				chunks.push_back(chunk);
+			}
+		}
+	}
+	else
+	{
+		uint scanlines = options.compression == ExrCompressionZip ? zipScanlines : 1;
+		for (uint y = 0; y < height; y += scanlines)
+		{
+			Chunk chunk;
+			chunk.y = y;
+			chunk.width = width;
+			chunk.height = math::min(scanlines, height - y);
+			chunks.push_back(chunk);
+		}
+	}
+
+	std::vector<char> buffer;
+	buffer.reserve(size_t(width) * height * channels.size() * (options.pixelType == ExrPixelTypeHalf ? 2 : 4));
+	ExrOptions headerOptions = options;
+	headerOptions.tileSize = math::max(options.tileSize, 1u);
+	putHeader(buffer, channels, width, height, headerOptions);
+
+	// Offsets of the chunks from the start of the file, filled in as they are written
+	size_t offsetTable = buffer.size();
+	buffer.resize(buffer.size() + chunks.size() * sizeof(uint64_t));
+
+	std::vector<byte> samples;
+	std::vector<byte> predicted;
+	std::vector<byte> compressed;
+	for (size_t i = 0; i < chunks.size(); i++)
+	{
+		const Chunk &chunk = chunks[i];
+		uint64_t offset = buffer.size();
+		for (uint byteIndex = 0; byteIndex < sizeof(offset); byteIndex++)
+			buffer[offsetTable + i * sizeof(offset) + byteIndex] = char(offset >> (8 * byteIndex));
+
+		gatherSamples(channels, chunk, height, options.pixelType, samples);
+		compress(samples, options.compression, predicted, compressed);
+		putChunk(buffer, chunk, options.tiled, compressed);
+	}
+
+	return writeBuffer(fileName, buffer);
+}
+
+bool writeExr(const std::string &baseFileName, const Image &image, const ExrOptions &options)
+{
+	return writeExr(baseFileName, std::vector<ExrLayer>(1, ExrLayer("", image)), options);
+}
+
+ExrTileWriter::~ExrTileWriter()
+{
+	if (file.is_open())
+		close();
+}
+
+bool ExrTileWriter::open(const std::string &baseFileName, uint _width, uint _height, uint _tileSize, const ExrOptions &_options)
+{
+	if (file.is_open())
+		close();
+
+	fileName = withExtension(baseFileName, ".exr");
+	width = math::max(_width, 1u);
+	height = math::max(_height, 1u);
+	options = _options;
+	options.tiled = true;
+	options.tileSize = math::max(_tileSize, 1u);
+	tilesX = (width + options.tileSize - 1) / options.tileSize;
+	tilesY = (height + options.tileSize - 1) / options.tileSize;
+	offsets.assign(size_t(tilesX) * tilesY, 0);
+	// Render tiles start at the bottom of the image and EXR tiles at the top of the data, rows are added
+	// above the image so that both grids match
+	padding = tilesY * options.tileSize - height;
+
+	file.open(fileName, std::ios::binary);
+	if (!file.is_open())
+	{
+		std::cerr << "Could not open file " << fileName << " for writing." << std::endl;
+		return false;
+	}
+
+	// The offsets are only known once all the tiles are written
+	std::vector<char> header;
+	putHeader(header, colourChannels(nullptr, 0), width, height, options, -int(padding), true);
+	offsetTable = header.size();
+	header.resize(header.size() + offsets.size() * sizeof(uint64_t));
+	file.write(header.data(), std::streamsize(header.size()));
+	return bool(file);
+}
+
+void ExrTileWriter::writeTile(uint x, uint y, uint tileWidth, uint tileHeight, const float *pixels)
+{
+	trace::Scope scope("write exr tile", "io");
+
+	// Compressed outside of the lock, by the render thread
+	static thread_local std::vector<float> padded;
+	static thread_local std::vector<byte> samples;
+	static thread_local std::vector<byte> predicted;
+	static thread_local std::vector<byte> compressed;
+	static thread_local std::vector<char> buffer;
+	Chunk chunk;
+	chunk.width = tileWidth;
+	chunk.height = tileHeight;
+	chunk.tileX = x / options.tileSize;
+	chunk.tileY = tilesY - 1 - y / options.tileSize;
+	if (chunk.tileY == 0 && padding > 0)
+	{
+		chunk.height += padding;
+		padded.assign(size_t(tileWidth) * chunk.height * 3, 0.0f);
+		std::copy(pixels, pixels + size_t(tileWidth) * tileHeight * 3, padded.begin());
+		pixels = padded.data();
+	}
+	gatherSamples(colourChannels(pixels, tileWidth), chunk, chunk.height, options.pixelType, samples);
+	compress(samples, options.compression, predicted, compressed);
+	buffer.clear();
+	putChunk(buffer, chunk, true, compressed);
+
+	std::lock_guard<std::mutex> lock(mutex);
+	offsets[size_t(chunk.tileY) * tilesX + chunk.tileX] = uint64_t(file.tellp());
+	file.write(buffer.data(), std::streamsize(buffer.size()));
+}
+
+bool ExrTileWriter::close()
+{
+	std::lock_guard<std::mutex> lock(mutex);
+	if (!file.is_open())
+		return false;
+
+	bool complete = std::find(offsets.begin(), offsets.end(), 0) == offsets.end();
+	if (!complete)
+		std::cerr << "Some tiles of " << fileName << " were not written." << std::endl;
+
+	std::vector<char> table;
+	for (uint64_t offset : offsets)
+		put(table, offset);
+	file.seekp(std::streamoff(offsetTable));
+	file.write(table.data(), std::streamsize(table.size()));
+	file.close();
+	if (!file)
+	{
+		std::cerr << "Could not write file " << fileName << "." << std::endl;
+		return false;
+	}
+
+	std::cout << "Result written to " << fileName << std::endl;
+	return complete;
+}
+
+}	// namespace file
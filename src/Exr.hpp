@@ -0,0 +1,96 @@
+#pragma once
+
+#include "Common.hpp"
+
+#include "File.hpp"
+#include "Image.hpp"
+#include "TileSink.hpp"
+
+#include <cstdint>
+#include <fstream>
+#include <mutex>
+#include <string>
+#include <vector>
+
+// OpenEXR output, single part, scanline or tiled, without external libraries
+namespace file
+{
+
+enum ExrCompression
+{
+	ExrCompressionNone,
+	// Run length, per scanline or tile
+	ExrCompressionRle,
+	// Deflate, per block of 16 scanlines or per tile
+	ExrCompressionZip
+};
+
+enum ExrPixelType
+{
+	ExrPixelTypeHalf,
+	ExrPixelTypeFloat
+};
+
+// A float image written as channels R, G and B, or Y when only one channel is written.
+// Channel names are prefixed with the layer name and a dot, unless it is empty.
+struct ExrLayer
+{
+	std::string name;
+	const Image *image = nullptr;
+	ExrValues values = ExrValuesColour;
+	// All the channels of the image when 0
+	uint channelAmount = 0;
+
+	ExrLayer(const std::string &_name, const Image &_image, ExrValues _values = ExrValuesColour, uint _channelAmount = 0)
+	: name(_name)
+	, image(&_image)
+	, values(_values)
+	, channelAmount(_channelAmount)
+	{}
+};
+
+struct ExrOptions
+{
+	ExrPixelType pixelType = ExrPixelTypeHalf;
+	ExrCompression compression = ExrCompressionZip;
+	// Square tiles instead of scanlines
+	bool tiled = false;
+	uint tileSize = 64;
+};
+
+// Layers must all have the size of the first one
+bool writeExr(const std::string &baseFileName, const std::vector<ExrLayer> &layers, const ExrOptions &options = ExrOptions());
+bool writeExr(const std::string &baseFileName, const Image &image, const ExrOptions &options = ExrOptions());
+
+// Tiled EXR written while rendering, see Renderer::setTileSink. Tiles go to the file as they arrive, in any
+// order, so only the tiles in flight are held in memory. Pixels are written as colours (ExrValuesColour).
+class ExrTileWriter : public TileSink
+{
+private:
+	std::string fileName;
+	std::ofstream file;
+	std::mutex mutex;
+	ExrOptions options;
+	uint width = 0;
+	uint height = 0;
+	uint tilesX = 0;
+	uint tilesY = 0;
+	// Rows above the image, in the top tile
+	uint padding = 0;
+	size_t offsetTable = 0;
+	std::vector<uint64_t> offsets;
+
+public:
+	ExrTileWriter() {}
+	ExrTileWriter(const ExrTileWriter &other) = delete;
+	ExrTileWriter &operator=(const ExrTileWriter &other) = delete;
+	~ExrTileWriter();
+
+	// The tile size must be the one of the renderer, the tiled option is implied
+	bool open(const std::string &baseFileName, uint _width, uint _height, uint _tileSize, const ExrOptions &_options = ExrOptions());
+	virtual void writeTile(uint x, uint y, uint tileWidth, uint tileHeight, const float *pixels) override;
+	// Completes the file once every tile has been written
+	bool close();
+};
+
+}	// namespace file
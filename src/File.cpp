@@ -0,0 +1,389 @@
+#include "File.hpp"
+#include "Trace.hpp"
+
+#include <algorithm>
+#include <cctype>
+#include <cstdint>
+#include <cstdlib>
+#include <cstring>
+#include <fstream>
+#include <iostream>
+#include <vector>
+
+namespace file
+{
+
+namespace
+{
+
+// Header followed by room for the samples
+std::vector<char> makeBuffer(const std::string &header, size_t dataSize)
+{
+	std::vector<char> buffer(header.size() + dataSize);
+	std::copy(header.begin(), header.end(), buffer.begin());
+	return buffer;
+}
+
+// Next header field, skipping whitespace and comments
+bool readHeaderField(std::istream &is, std::string &field)
+{
+	field.clear();
+	int c = is.get();
+	while (is && (std::isspace(c) || c == '#'))
+	{
+		if (c == '#')
+		{
+			while (is && c != '\n')
+				c = is.get();
+		}
+		c = is.get();
+	}
+	while (is && !std::isspace(c))
+	{
+		field += char(c);
+		c = is.get();
+	}
+	// The single whitespace after the last field is consumed, binary samples start right after it
+	return !field.empty();
+}
+
+bool readUint(std::istream &is, uint &value)
+{
+	std::string field;
+	if (!readHeaderField(is, field))
+		return false;
+	char *end = nullptr;
+	unsigned long parsed = std::strtoul(field.c_str(), &end, 10);
+	value = uint(parsed);
+	return *end == '\0' && field[0] != '-';
+}
+
+// Header of the image file, the stream is left on the first sample
+bool readImageHeader(std::istream &is, ImageFileInfo &info)
+{
+	std::string magic;
+	if (!readHeaderField(is, magic) || !readUint(is, info.width) || !readUint(is, info.height) || info.width == 0 || info.height == 0)
+		return false;
+
+	if (magic == "P3" || magic == "P6")
+	{
+		if (!readUint(is, info.maxValue) || info.maxValue == 0 || info.maxValue >= 65536)
+			return false;
+		info.binary = magic == "P6";
+		info.linear = false;
+		info.channelAmount = 3;
+		info.sampleSize = info.maxValue < 256 ? 1 : 2;
+		info.bottomFirst = false;
+	}
+	else if (magic == "PF" || magic == "Pf")
+	{
+		// A negative scale marks little endian samples
+		std::string scale;
+		if (!readHeaderField(is, scale))
+			return false;
+		info.binary = true;
+		info.linear = true;
+		info.channelAmount = magic == "PF" ? 3 : 1;
+		info.sampleSize = sizeof(float);
+		info.littleEndian = std::atof(scale.c_str()) < 0;
+		info.bottomFirst = true;
+	}
+	else
+	{
+		return false;
+	}
+
+	info.dataOffset = uint64_t(is.tellg());
+	return bool(is);
+}
+
+// Binary samples of consecutive pixels, as 3 floats per pixel
+void decodeSamples(const ImageFileInfo &info, const unsigned char *bytes, size_t pixelAmount, float *pixels)
+{
+	size_t valueAmount = pixelAmount * 3;
+	if (!info.linear)
+	{
+		float scale = 1.0f / float(info.maxValue);
+		for (size_t i = 0; i < valueAmount; i++)
+		{
+			uint value = info.sampleSize == 1 ? bytes[i] : (uint(bytes[2 * i]) << 8) | bytes[2 * i + 1];
+			pixels[i] = math::min(float(value) * scale, 1.0f);
+		}
+		return;
+	}
+
+	// Grey samples are spread over the 3 channels
+	const uint16_t endianness = 1;
+	bool swap = (*reinterpret_cast<const byte*>(&endianness) == 1) != info.littleEndian;
+	for (size_t i = 0; i < valueAmount; i++)
+	{
+		unsigned char sample[sizeof(float)];
+		std::memcpy(sample, bytes + (info.channelAmount == 3 ? i : i / 3) * sizeof(float), sizeof(float));
+		if (swap)
+			std::reverse(sample, sample + sizeof(float));
+		std::memcpy(&pixels[i], sample, sizeof(float));
+	}
+}
+
+// A row of samples at a time, seeking to each
+bool readBinaryRegion(std::istream &is, const ImageFileInfo &info, uint col, uint row, uint width, uint height, float *pixels)
+{
+	size_t pixelSize = size_t(info.channelAmount) * info.sampleSize;
+	std::vector<unsigned char> bytes(size_t(width) * pixelSize);
+	for (uint y = 0; y < height; y++)
+	{
+		// PPM rows are stored from the top, PFM ones from the bottom like in images
+		uint fileRow = info.bottomFirst ? row + y : info.height - 1 - (row + y);
+		is.seekg(std::streamoff(info.dataOffset + (uint64_t(fileRow) * info.width + col) * pixelSize));
+		if (!is.read(reinterpret_cast<char*>(bytes.data()), std::streamsize(bytes.size())))
+			return false;
+		decodeSamples(info, bytes.data(), width, pixels + size_t(y) * width * 3);
+	}
+	return true;
+}
+
+bool readAsciiSamples(std::istream &is, const ImageFileInfo &info, std::vector<float> &pixels)
+{
+	size_t rowSize = size_t(info.width) * 3;
+	float scale = 1.0f / float(info.maxValue);
+	pixels.resize(rowSize * info.height);
+	// Top row first in the file
+	for (uint row = 0; row < info.height; row++)
+	{
+		float *out = &pixels[(info.height - 1 - row) * rowSize];
+		for (size_t i = 0; i < rowSize; i++)
+		{
+			uint value = 0;
+			if (!readUint(is, value))
+				return false;
+			out[i] = math::min(float(value) * scale, 1.0f);
+		}
+	}
+	return true;
+}
+
+}	// namespace
+
+std::string withExtension(const std::string &baseFileName, const std::string &extension)
+{
+	if (baseFileName.size() > extension.size() &&
+		baseFileName.compare(baseFileName.size() - extension.size(), extension.size(), extension) == 0)
+	{
+		return baseFileName;
+	}
+	return baseFileName + extension;
+}
+
+bool writeBuffer(const std::string &fileName, const std::vector<char> &buffer)
+{
+	std::ofstream file(fileName, std::ios::binary);
+	if (!file.is_open())
+	{
+		std::cerr << "Could not open file " << fileName << " for writing." << std::endl;
+		return false;
+	}
+
+	file.write(buffer.data(), std::streamsize(buffer.size()));
+	file.close();
+	if (!file)
+	{
+		std::cerr << "Could not write file " << fileName << "." << std::endl;
+		return false;
+	}
+
+	std::cout << "Result written to " << fileName << std::endl;
+	return true;
+}
+
+const Image *floatImage(const Image &image, std::unique_ptr<Image> &converted)
+{
+	ImageDesc desc = image.getDesc();
+	bool floatFormat = desc.format == ImageFormat::r32f || desc.format == ImageFormat::r32g32b32f;
+	if (floatFormat && desc.layout == ImageLayout::Linear)
+		return &image;
+	if (!Image::isColourFormat(desc.format))
+		return nullptr;
+
+	// Tiled float images keep their format and are only linearized
+	if (!floatFormat)
+		desc.format = ImageFormat::r32g32b32f;
+	desc.layout = ImageLayout::Linear;
+	converted.reset(new Image(desc));
+	image.convertTo(*converted);
+	return converted.get();
+}
+
+bool writePpm(const std::string& baseFileName, const Image &colourImage, int range)
+{
+	trace::Scope scope("write ppm", "io");
+	std::string fileName = withExtension(baseFileName, ".ppm");
+	std::unique_ptr<Image> converted;
+	const Image *source = floatImage(colourImage, converted);
+	if (!source)
+	{
+		std::cerr << "Could not write " << fileName << ", only colour images are supported." << std::endl;
+		return false;
+	}
+	const Image &image = *source;
+
+	uint width = image.getWidth();
+	uint height = image.getHeight();
+	uint channelAmount = image.getChannelAmount();
+	const float *pixels = reinterpret_cast<const float*>(image.getData());
+	size_t valueAmount = size_t(width) * height * channelAmount;
+
+	int maxValue = math::max(1, range);
+	if (range <= 0)
+	{
+		for (size_t i = 0; i < valueAmount; i++)
+			maxValue = math::max(int(pixels[i]), maxValue);
+	}
+	maxValue = math::min(maxValue, 65535);
+	// Samples are big endian when they take two bytes
+	uint sampleSize = maxValue < 256 ? 1 : 2;
+
+	std::string header = "P6\n" + std::to_string(width) + " " + std::to_string(height) + "\n" + std::to_string(maxValue) + "\n";
+	size_t dataSize = size_t(width) * height * 3 * sampleSize;
+	std::vector<char> buffer = makeBuffer(header, dataSize);
+
+	// Rows are stored from the top, the image starts at the bottom
+	byte *out = reinterpret_cast<byte*>(&buffer[header.size()]);
+	for (int row = int(height) - 1; row >= 0; row--)
+	{
+		const float *in = pixels + size_t(row) * width * channelAmount;
+		for (uint col = 0; col < width; col++)
+		{
+			for (uint channel = 0; channel < 3; channel++)
+			{
+				int value = math::clamp(int(in[channelAmount == 3 ? channel : 0]), 0, maxValue);
+				if (sampleSize == 2)
+					*out++ = byte(value >> 8);
+				*out++ = byte(value);
+			}
+			in += channelAmount;
+		}
+	}
+
+	return writeBuffer(fileName, buffer);
+}
+
+float decodeValue(float value, ExrValues values)
+{
+	const float scale = float(1.0 / 255.99);
+	switch (values)
+	{
+		case ExrValuesColour:
+		{
+			// Undo gammaCorrect
+			value *= scale;
+			return value * value;
+		}
+		case ExrValuesUnit:
+			return value * scale;
+		default:
+			return value;
+	}
+}
+
+bool writePfm(const std::string& baseFileName, const Image &colourImage, ExrValues values)
+{
+	trace::Scope scope("write pfm", "io");
+	std::string fileName = withExtension(baseFileName, ".pfm");
+	std::unique_ptr<Image> converted;
+	const Image *source = floatImage(colourImage, converted);
+	if (!source)
+	{
+		std::cerr << "Could not write " << fileName << ", only colour images are supported." << std::endl;
+		return false;
+	}
+	const Image &image = *source;
+
+	uint width = image.getWidth();
+	uint height = image.getHeight();
+	uint channelAmount = image.getChannelAmount();
+	const float *pixels = reinterpret_cast<const float*>(image.getData());
+	size_t valueAmount = size_t(width) * height * channelAmount;
+
+	// A negative scale marks little endian samples
+	const uint16_t endianness = 1;
+	bool littleEndian = *reinterpret_cast<const byte*>(&endianness) == 1;
+	std::string header = std::string(channelAmount == 3 ? "PF" : "Pf") + "\n" +
+		std::to_string(width) + " " + std::to_string(height) + "\n" + (littleEndian ? "-1.0" : "1.0") + "\n";
+	size_t dataSize = valueAmount * sizeof(float);
+	std::vector<char> buffer = makeBuffer(header, dataSize);
+
+	// Rows are stored from the bottom like in the image, only the values change
+	char *out = &buffer[header.size()];
+	for (size_t i = 0; i < valueAmount; i++)
+	{
+		float value = decodeValue(pixels[i], values);
+		// The header leaves the samples unaligned
+		std::memcpy(out + i * sizeof(float), &value, sizeof(float));
+	}
+
+	return writeBuffer(fileName, buffer);
+}
+
+bool readImageInfo(const std::string &fileName, ImageFileInfo &info)
+{
+	std::ifstream file(fileName, std::ios::binary);
+	if (!file.is_open())
+	{
+		std::cerr << "Could not open file " << fileName << " for reading." << std::endl;
+		return false;
+	}
+	if (!readImageHeader(file, info))
+	{
+		std::cerr << "Could not read " << fileName << ", only PPM and PFM images are supported." << std::endl;
+		return false;
+	}
+	return true;
+}
+
+bool readImageRegion(const std::string &fileName, const ImageFileInfo &info, uint col, uint row, uint width, uint height, float *pixels)
+{
+	trace::Scope scope("read image region", "io");
+	std::ifstream file(fileName, std::ios::binary);
+	if (!info.binary || col + width > info.width || row + height > info.height ||
+		!file.is_open() || !readBinaryRegion(file, info, col, row, width, height, pixels))
+	{
+		std::cerr << "Could not read a region of " << fileName << "." << std::endl;
+		return false;
+	}
+	return true;
+}
+
+bool readImage(const std::string &fileName, std::vector<float> &pixels, uint &width, uint &height, bool &linear)
+{
+	trace::Scope scope("read image", "io");
+	std::ifstream file(fileName, std::ios::binary);
+	if (!file.is_open())
+	{
+		std::cerr << "Could not open file " << fileName << " for reading." << std::endl;
+		return false;
+	}
+
+	ImageFileInfo info;
+	bool valid = readImageHeader(file, info);
+	if (valid && info.binary)
+	{
+		pixels.resize(size_t(info.width) * info.height * 3);
+		valid = readBinaryRegion(file, info, 0, 0, info.width, info.height, pixels.data());
+	}
+	else if (valid)
+	{
+		valid = readAsciiSamples(file, info, pixels);
+	}
+
+	if (!valid)
+	{
+		std::cerr << "Could not read " << fileName << ", only PPM and PFM images are supported." << std::endl;
+		return false;
+	}
+	width = info.width;
+	height = info.height;
+	linear = info.linear;
+	return true;
+}
+
+}	// namespace file
@@ -5,62 +5,69 @@
 #include "Image.hpp"
 #include "Vec3.hpp"
 
-#include <fstream>
-#include <iostream>
+#include <cstdint>
+#include <memory>
 #include <string>
+#include <vector>
 
 namespace file
 {
 
-// By default (range <= 0) the maximum value is searched in the image during traversal.
-bool writePpm(const std::string& baseFileName, const Image &image, int range = -1)
+// Header of a PPM or PFM file, enough to read parts of its samples
+struct ImageFileInfo
 {
-	std::string fileName(baseFileName);
-	std::string extension(".ppm");
-	if (baseFileName.size() <= extension.size() ||
-		baseFileName.compare(baseFileName.size() - extension.size(), extension.size(), extension) != 0)
-	{
-		fileName += extension;
-	}
-	std::ofstream file(fileName);
+	uint width = 0;
+	uint height = 0;
+	// Binary files can be read in parts, ASCII PPMs (P3) only as a whole
+	bool binary = false;
+	// PFM samples are linear colours, PPM ones are gamma corrected
+	bool linear = false;
+	uint channelAmount = 3;
+	uint sampleSize = 1;
+	uint maxValue = 255;
+	bool littleEndian = false;
+	bool bottomFirst = false;
+	uint64_t dataOffset = 0;
 
-	if (!file.is_open())
-	{
-		std::cerr << "Could not open file " << fileName << " for writing." << std::endl;
-		return false;
-	}
+	ImageFileInfo() {}
+};
 
-	uint width = image.getWidth();
-	uint height = image.getHeight();
+// Appends the extension unless the name already ends with it
+std::string withExtension(const std::string &baseFileName, const std::string &extension);
+// The whole buffer goes out in a single write
+bool writeBuffer(const std::string &fileName, const std::vector<char> &buffer);
+// The image itself when it stores 32 bit floats linearly, for other colour formats and layouts a linear float
+// copy owned by converted. Null for integer images.
+const Image *floatImage(const Image &image, std::unique_ptr<Image> &converted);
 
-	// PPM header
-	file << "P3\n" << width << " " << height << "\n";
-	std::streampos headerPosForRange = file.tellp();
-	// 5 placeholder spaces (maximum supported by PPM is 65535)
-	file << "     \n";
+// How the values stored in an image are written to float formats, PFM and EXR
+enum ExrValues
+{
+	// As the integrators write them, gamma corrected and scaled to 255.99, converted back to linear colours
+	ExrValuesColour,
+	// Scaled to 255.99 without gamma correction, like the depth and normal visualizers
+	ExrValuesUnit,
+	// Written as stored
+	ExrValuesRaw
+};
 
-	int maxValue = math::max(1, range);
-	Real colourArray[3];
-	for (int row = int(height) - 1; row >= 0; row--)
-	{
-		for (int col = 0; col < int(width); col++)
-		{
-			image.load(col, row, (byte*)colourArray);
-			Vec3 colour(colourArray[0], colourArray[1], colourArray[2]);
-			if (range <= 0)
-				maxValue = math::max(int(max(colour)), maxValue);
-			file << int(colour.r) << " " << int(colour.g) << " " << int(colour.b) << "\n";
-		}
-	}
-	maxValue = math::min(maxValue, 65535);
+// Converts a stored value as written with values
+float decodeValue(float value, ExrValues values);
 
-	file.seekp(headerPosForRange);
-	file << maxValue;
+// Binary PPM (P6) of a colour image, one byte per channel when the maximum value is below 256 and two otherwise.
+// By default (range <= 0) the maximum value is searched in the image first.
+bool writePpm(const std::string& baseFileName, const Image &image, int range = -1);
 
-	file.close();
-	std::cout << "Result written to " << fileName << std::endl;
+// Floating point PFM of an image. By default the values are colours as the integrators write them, gamma corrected
+// and scaled to 255.99, converted back to linear colours with white at 1.
+bool writePfm(const std::string& baseFileName, const Image &image, ExrValues values = ExrValuesColour);
 
-	return true;
-}
+// Reads a PPM (P3 or P6, 8 or 16 bits per channel) or PFM file as 3 floats per pixel, rows from the bottom one
+// like in images. PPM values are scaled to 0 to 1 and stay gamma corrected, linear tells PFM values apart.
+bool readImage(const std::string &fileName, std::vector<float> &pixels, uint &width, uint &height, bool &linear);
+// Only the header, to read the samples later
+bool readImageInfo(const std::string &fileName, ImageFileInfo &info);
+// width by height pixels from (col, row) of a binary file, like readImage but without reading the rest of the file
+bool readImageRegion(const std::string &fileName, const ImageFileInfo &info, uint col, uint row, uint width, uint height, float *pixels);
 
 }	// namespace file
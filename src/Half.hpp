@@ -0,0 +1,90 @@
+#pragma once
+
+#include "Common.hpp"
+
+#include <cstdint>
+#include <cstring>
+
+// IEEE 754 half precision floats, stored as their 16 bits
+
+// Rounds to the nearest half, ties to even. Too large values become infinities.
+inline uint16_t floatToHalf(float value)
+{
+	uint32_t bits;
+	std::memcpy(&bits, &value, sizeof(bits));
+	uint32_t sign = (bits >> 16) & 0x8000;
+	uint32_t exponent = (bits >> 23) & 0xff;
+	uint32_t mantissa = bits & 0x7fffff;
+
+	// Infinity or NaN, which keeps a mantissa bit set
+	if (exponent == 0xff)
+		return uint16_t(sign | 0x7c00 | (mantissa ? 0x200 | (mantissa >> 13) : 0));
+
+	int halfExponent = int(exponent) - 127 + 15;
+	if (halfExponent >= 0x1f)
+		return uint16_t(sign | 0x7c00);
+
+	uint32_t half;
+	uint32_t remainder;
+	uint32_t halfway;
+	if (halfExponent <= 0)
+	{
+		// Denormal, or zero when even rounding cannot reach the smallest denormal
+		if (halfExponent < -10)
+			return uint16_t(sign);
+		mantissa |= 0x800000;
+		uint shift = uint(14 - halfExponent);
+		half = mantissa >> shift;
+		remainder = mantissa & ((1u << shift) - 1);
+		halfway = 1u << (shift - 1);
+	}
+	else
+	{
+		half = (uint32_t(halfExponent) << 10) | (mantissa >> 13);
+		remainder = mantissa & 0x1fff;
+		halfway = 0x1000;
+	}
+	// A carry out of the mantissa correctly moves to the next exponent, or to infinity
+	if (remainder > halfway || (remainder == halfway && (half & 1)))
+		half++;
+	return uint16_t(sign | half);
+}
+
+inline float halfToFloat(uint16_t value)
+{
+	uint32_t sign = uint32_t(value & 0x8000) << 16;
+	uint32_t exponent = (value >> 10) & 0x1f;
+	uint32_t mantissa = value & 0x3ff;
+
+	uint32_t bits;
+	if (exponent == 0x1f)
+	{
+		bits = sign | 0x7f800000 | (mantissa << 13);
+	}
+	else if (exponent == 0)
+	{
+		if (mantissa == 0)
+		{
+			bits = sign;
+		}
+		else
+		{
+			// Normalize the denormal
+			exponent = 127 - 15 + 1;
+			while (!(mantissa & 0x400))
+			{
+				mantissa <<= 1;
+				exponent--;
+			}
+			bits = sign | (exponent << 23) | ((mantissa & 0x3ff) << 13);
+		}
+	}
+	else
+	{
+		bits = sign | ((exponent + 127 - 15) << 23) | (mantissa << 13);
+	}
+
+	float result;
+	std::memcpy(&result, &bits, sizeof(result));
+	return result;
+}
@@ -0,0 +1,27 @@
+#include "Hitable.hpp"
+
+bool Hitable::hitWithSDF(const Vec3 &point, Real epsilon, HitRecord &rec) const
+{
+	rec.t = evaluateSDF(point);
+	if (math::abs(rec.t) <= epsilon)
+	{
+		rec.point = point;
+		rec.normal = evaluateNormalFromSDF(point, epsilon * 0.1);
+		rec.u = 0;
+		rec.v = 0;
+		rec.uvDensity = 0;
+		rec.hitable = this;
+		return true;
+	}
+	return false;
+}
+
+Vec3 Hitable::evaluateNormalFromSDF(const Vec3 &point, Real epsilon) const
+{
+	// Generic normal evaluation by gradient
+	Vec3 normal;
+	normal.x = evaluateSDF(point + Vec3(epsilon, 0, 0)) - evaluateSDF(point - Vec3(epsilon, 0, 0));
+	normal.y = evaluateSDF(point + Vec3(0, epsilon, 0)) - evaluateSDF(point - Vec3(0, epsilon, 0));
+	normal.z = evaluateSDF(point + Vec3(0, 0, epsilon)) - evaluateSDF(point - Vec3(0, 0, epsilon));
+	return normalize(normal);
+}
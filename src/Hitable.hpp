@@ -2,6 +2,7 @@
 
 #include "Common.hpp"
 
+#include "BoundingBox.hpp"
 #include "Math.hpp"
 #include "Ray.hpp"
 #include "Transform.hpp"
@@ -15,7 +16,14 @@ struct HitRecord
 	Real t = 0;
 	Vec3 point;
 	Vec3 normal;
+	// Surface coordinates, and how many uv units a unit of distance covers around the point (0 when unknown)
+	Real u = 0;
+	Real v = 0;
+	Real uvDensity = 0;
 	const Hitable *hitable = nullptr;
+
+	// Width of the footprint of the ray in uv units, for texture filtering
+	Real uvFootprint(const Ray &r) const { return r.spread() * t * uvDensity; }
 };
 
 class Hitable
@@ -33,27 +41,6 @@ public:
 	virtual bool hitWithSDF(const Vec3 &point, Real epsilon, HitRecord &rec) const;
 	virtual Real evaluateSDF(const Vec3 &point) const { return math::maxReal(); }
 	virtual Vec3 evaluateNormalFromSDF(const Vec3 &point, Real epsilon) const;
+	// World space bounds, returns false for hitables without finite bounds
+	virtual bool boundingBox(BoundingBox &box) const { return false; }
 };
-
-bool Hitable::hitWithSDF(const Vec3 &point, Real epsilon, HitRecord &rec) const
-{
-	rec.t = evaluateSDF(point);
-	if (math::abs(rec.t) <= epsilon)
-	{
-		rec.point = point;
-		rec.normal = evaluateNormalFromSDF(point, epsilon * 0.1);
-		rec.hitable = this;
-		return true;
-	}
-	return false;
-}
-
-Vec3 Hitable::evaluateNormalFromSDF(const Vec3 &point, Real epsilon) const
-{
-	// Generic normal evaluation by gradient
-	Vec3 normal;
-	normal.x = evaluateSDF(point + Vec3(epsilon, 0, 0)) - evaluateSDF(point - Vec3(epsilon, 0, 0));
-	normal.y = evaluateSDF(point + Vec3(0, epsilon, 0)) - evaluateSDF(point - Vec3(0, epsilon, 0));
-	normal.z = evaluateSDF(point + Vec3(0, 0, epsilon)) - evaluateSDF(point - Vec3(0, 0, epsilon));
-	return normalize(normal);
-}
@@ -0,0 +1,491 @@
+#include "Image.hpp"
+#include "Half.hpp"
+
+#include <cstdint>
+
+namespace
+{
+
+// Pixels are converted through blocks of floats, 4 channels each
+const size_t conversionBlockSize = 64;
+
+uint formatChannelAmount(ImageFormat format)
+{
+	switch (format)
+	{
+		case ImageFormat::r32f:
+		case ImageFormat::r32ui:
+		case ImageFormat::r32si:
+			return 1;
+		case ImageFormat::r32g32b32f:
+		case ImageFormat::r32g32b32ui:
+		case ImageFormat::r32g32b32si:
+		case ImageFormat::r11g11b10f:
+			return 3;
+		case ImageFormat::r16g16b16a16f:
+		case ImageFormat::r8g8b8a8un:
+			return 4;
+		default:
+			return 0;
+	}
+}
+
+uint formatPixelSize(ImageFormat format)
+{
+	uint channels = formatChannelAmount(format);
+	switch (format)
+	{
+		case ImageFormat::r32f:
+		case ImageFormat::r32g32b32f:
+			return sizeof(float) * channels;
+		case ImageFormat::r32ui:
+		case ImageFormat::r32g32b32ui:
+			return sizeof(uint) * channels;
+		case ImageFormat::r32si:
+		case ImageFormat::r32g32b32si:
+			return sizeof(int) * channels;
+		case ImageFormat::r16g16b16a16f:
+			return sizeof(uint16_t) * channels;
+		case ImageFormat::r8g8b8a8un:
+			return sizeof(byte) * channels;
+		case ImageFormat::r11g11b10f:
+			return sizeof(uint32_t);
+		default:
+			return 0;
+	}
+}
+
+// Unsigned floats of r11g11b10f, with a 5 bit exponent. Negative values become 0 and too large ones the
+// largest finite value.
+uint32_t packUnsignedFloat(float value, uint mantissaBits)
+{
+	uint32_t bits;
+	std::memcpy(&bits, &value, sizeof(bits));
+	uint32_t exponent = (bits >> 23) & 0xff;
+	uint32_t mantissa = bits & 0x7fffff;
+	uint32_t maxFinite = (30u << mantissaBits) | ((1u << mantissaBits) - 1);
+	if (exponent == 0xff)
+		return mantissa ? (31u << mantissaBits) | 1 : (bits >> 31 ? 0 : 31u << mantissaBits);
+	if ((bits >> 31) || value == 0.0f)
+		return 0;
+
+	int packedExponent = int(exponent) - 127 + 15;
+	uint shift = 23 - mantissaBits;
+	uint32_t packed;
+	if (packedExponent <= 0)
+	{
+		// Denormal
+		shift += uint(1 - packedExponent);
+		if (shift > 24)
+			return 0;
+		mantissa |= 0x800000;
+		packed = mantissa >> shift;
+	}
+	else
+	{
+		packed = (uint32_t(packedExponent) << mantissaBits) | (mantissa >> shift);
+	}
+	// Round to nearest, ties to even, a carry moves to the next exponent
+	uint32_t remainder = mantissa & ((1u << shift) - 1);
+	uint32_t halfway = 1u << (shift - 1);
+	if (remainder > halfway || (remainder == halfway && (packed & 1)))
+		packed++;
+	return packed > maxFinite ? maxFinite : packed;
+}
+
+float unpackUnsignedFloat(uint32_t packed, uint mantissaBits)
+{
+	uint32_t exponent = packed >> mantissaBits;
+	uint32_t mantissa = packed & ((1u << mantissaBits) - 1);
+	uint32_t bits;
+	if (exponent == 31)
+	{
+		bits = 0x7f800000 | (mantissa << (23 - mantissaBits));
+	}
+	else if (exponent == 0)
+	{
+		// Denormal, mantissa * 2^(-14 - mantissaBits)
+		bits = uint32_t(127 - 14 - int(mantissaBits)) << 23;
+		float unit;
+		std::memcpy(&unit, &bits, sizeof(unit));
+		return float(mantissa) * unit;
+	}
+	else
+	{
+		bits = ((exponent - 15 + 127) << 23) | (mantissa << (23 - mantissaBits));
+	}
+	float value;
+	std::memcpy(&value, &bits, sizeof(value));
+	return value;
+}
+
+byte toUnsignedNormalized(float value)
+{
+	// Also sends NaN to 0
+	return value >= 255.0f ? 255 : value > 0.0f ? byte(value) : 0;
+}
+
+void decodePixels(const byte *in, ImageFormat format, float *out, size_t amount)
+{
+	switch (format)
+	{
+		case ImageFormat::r32f:
+		{
+			const float *pixels = reinterpret_cast<const float*>(in);
+			for (size_t i = 0; i < amount; i++, out += 4)
+			{
+				out[0] = pixels[i];
+				out[1] = 0.0f;
+				out[2] = 0.0f;
+				out[3] = 1.0f;
+			}
+			break;
+		}
+		case ImageFormat::r32g32b32f:
+		{
+			const float *pixels = reinterpret_cast<const float*>(in);
+			for (size_t i = 0; i < amount; i++, out += 4, pixels += 3)
+			{
+				out[0] = pixels[0];
+				out[1] = pixels[1];
+				out[2] = pixels[2];
+				out[3] = 1.0f;
+			}
+			break;
+		}
+		case ImageFormat::r16g16b16a16f:
+		{
+			const uint16_t *pixels = reinterpret_cast<const uint16_t*>(in);
+			for (size_t i = 0; i < amount * 4; i++)
+				out[i] = halfToFloat(pixels[i]);
+			break;
+		}
+		case ImageFormat::r8g8b8a8un:
+		{
+			for (size_t i = 0; i < amount; i++, out += 4, in += 4)
+			{
+				out[0] = float(in[0]);
+				out[1] = float(in[1]);
+				out[2] = float(in[2]);
+				out[3] = float(in[3]) * (1.0f / 255.0f);
+			}
+			break;
+		}
+		case ImageFormat::r11g11b10f:
+		{
+			const uint32_t *pixels = reinterpret_cast<const uint32_t*>(in);
+			for (size_t i = 0; i < amount; i++, out += 4)
+			{
+				out[0] = unpackUnsignedFloat(pixels[i] & 0x7ff, 6);
+				out[1] = unpackUnsignedFloat((pixels[i] >> 11) & 0x7ff, 6);
+				out[2] = unpackUnsignedFloat(pixels[i] >> 22, 5);
+				out[3] = 1.0f;
+			}
+			break;
+		}
+		default:
+		{
+			for (size_t i = 0; i < amount; i++, out += 4)
+			{
+				out[0] = out[1] = out[2] = 0.0f;
+				out[3] = 1.0f;
+			}
+		}
+	}
+}
+
+void encodePixels(const float *in, float scale, ImageFormat format, byte *out, size_t amount)
+{
+	switch (format)
+	{
+		case ImageFormat::r32f:
+		{
+			float *pixels = reinterpret_cast<float*>(out);
+			for (size_t i = 0; i < amount; i++, in += 4)
+				pixels[i] = in[0] * scale;
+			break;
+		}
+		case ImageFormat::r32g32b32f:
+		{
+			float *pixels = reinterpret_cast<float*>(out);
+			for (size_t i = 0; i < amount; i++, in += 4, pixels += 3)
+			{
+				pixels[0] = in[0] * scale;
+				pixels[1] = in[1] * scale;
+				pixels[2] = in[2] * scale;
+			}
+			break;
+		}
+		case ImageFormat::r16g16b16a16f:
+		{
+			uint16_t *pixels = reinterpret_cast<uint16_t*>(out);
+			for (size_t i = 0; i < amount; i++, in += 4, pixels += 4)
+			{
+				pixels[0] = floatToHalf(in[0] * scale);
+				pixels[1] = floatToHalf(in[1] * scale);
+				pixels[2] = floatToHalf(in[2] * scale);
+				pixels[3] = floatToHalf(in[3]);
+			}
+			break;
+		}
+		case ImageFormat::r8g8b8a8un:
+		{
+			for (size_t i = 0; i < amount; i++, in += 4, out += 4)
+			{
+				out[0] = toUnsignedNormalized(in[0] * scale);
+				out[1] = toUnsignedNormalized(in[1] * scale);
+				out[2] = toUnsignedNormalized(in[2] * scale);
+				out[3] = toUnsignedNormalized(in[3] * 255.0f + 0.5f);
+			}
+			break;
+		}
+		case ImageFormat::r11g11b10f:
+		{
+			uint32_t *pixels = reinterpret_cast<uint32_t*>(out);
+			for (size_t i = 0; i < amount; i++, in += 4)
+			{
+				pixels[i] = packUnsignedFloat(in[0] * scale, 6) |
+					(packUnsignedFloat(in[1] * scale, 6) << 11) |
+					(packUnsignedFloat(in[2] * scale, 5) << 22);
+			}
+			break;
+		}
+		default:
+			break;
+	}
+}
+
+}	// namespace
+
+bool ImageDesc::operator==(const ImageDesc &other) const
+{
+	return width == other.width &&
+		height == other.height &&
+		format == other.format &&
+		layout == other.layout &&
+		(layout == ImageLayout::Linear || blockSize == other.blockSize);
+}
+
+uint Image::positionToIndex(int x, int y) const
+{
+	x = math::clamp(x, 0, int(descriptor.width - 1));
+	y = math::clamp(y, 0, int(descriptor.height - 1));
+	return uint(pixelOffset(uint(x), uint(y)) * pixelSizeInBytes);
+}
+
+size_t Image::pixelOffset(uint x, uint y) const
+{
+	if (descriptor.layout == ImageLayout::Linear)
+		return x + size_t(y) * descriptor.width;
+
+	uint mask = (1u << blockShift) - 1;
+	size_t block = (x >> blockShift) + size_t(y >> blockShift) * blocksPerRow;
+	return (block << (2 * blockShift)) + ((y & mask) << blockShift) + (x & mask);
+}
+
+uint Image::contiguousPixels(uint x, uint stopX) const
+{
+	if (descriptor.layout == ImageLayout::Linear)
+		return stopX - x;
+	uint blockEnd = ((x >> blockShift) + 1) << blockShift;
+	return math::min(blockEnd, stopX) - x;
+}
+
+template <typename Function>
+void Image::forEachRun(uint x, uint y, uint width, uint height, Function copy) const
+{
+	if (x >= descriptor.width || y >= descriptor.height)
+		return;
+
+	uint stopX = math::min(x + width, descriptor.width);
+	uint stopY = math::min(y + height, descriptor.height);
+	for (uint row = y; row < stopY; row++)
+	{
+		size_t tileOffset = size_t(row - y) * width;
+		for (uint col = x; col < stopX;)
+		{
+			uint amount = contiguousPixels(col, stopX);
+			copy(pixelOffset(col, row), tileOffset + (col - x), amount);
+			col += amount;
+		}
+	}
+}
+
+Image::Image(const ImageDesc &desc)
+{
+	descriptor.width = math::max(desc.width, 1u);
+	descriptor.height = math::max(desc.height, 1u);
+	descriptor.format = desc.format;
+	descriptor.layout = desc.layout;
+	descriptor.blockSize = 1;
+	if (descriptor.layout == ImageLayout::Tiled)
+	{
+		while ((1u << blockShift) < desc.blockSize)
+			blockShift++;
+		descriptor.blockSize = 1u << blockShift;
+	}
+
+	aspectRatio = Real(descriptor.width) / Real(descriptor.height);
+
+	channelAmount = formatChannelAmount(descriptor.format);
+	pixelSizeInBytes = formatPixelSize(descriptor.format);
+
+	// Tiled images are padded to whole blocks
+	blocksPerRow = (descriptor.width + descriptor.blockSize - 1) >> blockShift;
+	uint blockRows = (descriptor.height + descriptor.blockSize - 1) >> blockShift;
+	dataSize = pixelSizeInBytes * (blocksPerRow << blockShift) * (blockRows << blockShift);
+	data = new byte[dataSize]();
+}
+
+Image::Image(const Image &other)
+: Image(other.descriptor)
+{
+	std::memcpy(data, other.data, dataSize);
+}
+
+Image &Image::operator=(const Image &other)
+{
+	if (this == &other)
+		return *this;
+
+	if (descriptor != other.descriptor)
+	{
+		delete[] data;
+		descriptor = other.descriptor;
+		aspectRatio = other.aspectRatio;
+		channelAmount = other.channelAmount;
+		pixelSizeInBytes = other.pixelSizeInBytes;
+		dataSize = other.dataSize;
+		blockShift = other.blockShift;
+		blocksPerRow = other.blocksPerRow;
+		data = new byte[dataSize];
+	}
+
+	std::memcpy(data, other.data, dataSize);
+	return *this;
+}
+
+void Image::store(int x, int y, const byte *in)
+{
+	uint index = positionToIndex(x, y);
+	std::memcpy(&data[index], in, pixelSizeInBytes);
+}
+
+void Image::load(int x, int y, byte *out) const
+{
+	uint index = positionToIndex(x, y);
+	std::memcpy(out, &data[index], pixelSizeInBytes);
+}
+
+void Image::storeTile(uint x, uint y, uint width, uint height, const byte *in)
+{
+	forEachRun(x, y, width, height, [&](size_t imageOffset, size_t tileOffset, uint amount)
+	{
+		std::memcpy(data + imageOffset * pixelSizeInBytes, in + tileOffset * pixelSizeInBytes, amount * pixelSizeInBytes);
+	});
+}
+
+void Image::loadTile(uint x, uint y, uint width, uint height, byte *out) const
+{
+	forEachRun(x, y, width, height, [&](size_t imageOffset, size_t tileOffset, uint amount)
+	{
+		std::memcpy(out + tileOffset * pixelSizeInBytes, data + imageOffset * pixelSizeInBytes, amount * pixelSizeInBytes);
+	});
+}
+
+bool Image::isColourFormat(ImageFormat format)
+{
+	switch (format)
+	{
+		case ImageFormat::r32f:
+		case ImageFormat::r32g32b32f:
+		case ImageFormat::r16g16b16a16f:
+		case ImageFormat::r8g8b8a8un:
+		case ImageFormat::r11g11b10f:
+			return true;
+		default:
+			return false;
+	}
+}
+
+void Image::convertPixels(const byte *in, ImageFormat inFormat, byte *out, ImageFormat outFormat, size_t amount, float scale)
+{
+	if (inFormat == outFormat && scale == 1.0f)
+	{
+		std::memcpy(out, in, amount * formatPixelSize(inFormat));
+		return;
+	}
+
+	uint inPixelSize = formatPixelSize(inFormat);
+	uint outPixelSize = formatPixelSize(outFormat);
+
+	float block[conversionBlockSize * 4];
+	while (amount > 0)
+	{
+		size_t blockAmount = amount < conversionBlockSize ? amount : conversionBlockSize;
+		decodePixels(in, inFormat, block, blockAmount);
+		encodePixels(block, scale, outFormat, out, blockAmount);
+		in += blockAmount * inPixelSize;
+		out += blockAmount * outPixelSize;
+		amount -= blockAmount;
+	}
+}
+
+void Image::convertTo(Image &other, float scale) const
+{
+	if (descriptor.width != other.descriptor.width || descriptor.height != other.descriptor.height)
+		return;
+	if (descriptor.layout == ImageLayout::Linear && other.descriptor.layout == ImageLayout::Linear)
+	{
+		convertPixels(data, descriptor.format, other.data, other.descriptor.format, size_t(descriptor.width) * descriptor.height, scale);
+		return;
+	}
+
+	// Runs of pixels contiguous in both images
+	for (uint row = 0; row < descriptor.height; row++)
+	{
+		for (uint col = 0; col < descriptor.width;)
+		{
+			uint amount = math::min(contiguousPixels(col, descriptor.width), other.contiguousPixels(col, descriptor.width));
+			convertPixels(data + pixelOffset(col, row) * pixelSizeInBytes, descriptor.format,
+				other.data + other.pixelOffset(col, row) * other.pixelSizeInBytes, other.descriptor.format, amount, scale);
+			col += amount;
+		}
+	}
+}
+
+void Image::storeColour(int x, int y, const float *rgb)
+{
+	uint index = positionToIndex(x, y);
+	if (descriptor.format == ImageFormat::r32g32b32f)
+	{
+		std::memcpy(&data[index], rgb, 3 * sizeof(float));
+		return;
+	}
+	float pixel[4] = { rgb[0], rgb[1], rgb[2], 1.0f };
+	encodePixels(pixel, 1.0f, descriptor.format, &data[index], 1);
+}
+
+void Image::loadColour(int x, int y, float *rgb) const
+{
+	uint index = positionToIndex(x, y);
+	if (descriptor.format == ImageFormat::r32g32b32f)
+	{
+		std::memcpy(rgb, &data[index], 3 * sizeof(float));
+		return;
+	}
+	float pixel[4];
+	decodePixels(&data[index], descriptor.format, pixel, 1);
+	rgb[0] = pixel[0];
+	rgb[1] = pixel[1];
+	rgb[2] = pixel[2];
+}
+
+void Image::storeColourTile(uint x, uint y, uint width, uint height, const float *rgb)
+{
+	forEachRun(x, y, width, height, [&](size_t imageOffset, size_t tileOffset, uint amount)
+	{
+		convertPixels(reinterpret_cast<const byte*>(rgb + tileOffset * 3), ImageFormat::r32g32b32f,
+			data + imageOffset * pixelSizeInBytes, descriptor.format, amount);
+	});
+}
@@ -4,6 +4,7 @@
 
 #include "Math.hpp"
 
+#include <cstddef>
 #include <cstring>	// For memcpy
 
 enum class ImageFormat
@@ -32,26 +33,59 @@ enum class ImageFormat
 	r32g32b32ui,
 	r32g32b32si,
 
+	// Packed, 16 or 8 bits per channel
+	// 4 channels
+	r16g16b16a16f,
+	r8g8b8a8un,
+
+	// 3 channels, floats without sign or sign bit in 32 bits
+	// (6 and 5 bit mantissas, 5 bit exponents)
+	r11g11b10f,
+
 	Count
 };
 
+// Order of the pixels in memory
+enum class ImageLayout
+{
+	// Row after row, from the bottom one
+	Linear,
+	// Square blocks of pixels, each stored as a small linear image, in the order of a linear image.
+	// The image is padded to whole blocks.
+	Tiled
+};
+
 // Descriptor for the image construction
 struct ImageDesc
 {
 	uint width = 1;
 	uint height = 1;
 	ImageFormat format = ImageFormat::r32f;
+	ImageLayout layout = ImageLayout::Linear;
+	// Side of the blocks of tiled images, rounded up to a power of two. The default matches the render tiles.
+	uint blockSize = 64;
 
 	bool operator==(const ImageDesc &other) const;
 	bool operator!=(const ImageDesc &other) const { return !(*this == other); }
 };
 
-bool ImageDesc::operator==(const ImageDesc &other) const
+// Samples of an image as an array of T, valid as long as the image. Rows are contiguous and go from the
+// bottom up, so a whole image or row can be walked as a flat array.
+template <typename T>
+struct ImageView
 {
-	return width == other.width &&
-		height == other.height &&
-		format == other.format;
-}
+	T *data = nullptr;
+	uint width = 0;
+	uint height = 0;
+	// Values of type T in a pixel and in a row
+	uint pixelStride = 0;
+	size_t rowStride = 0;
+
+	T *row(uint y) const { return data + y * rowStride; }
+	T *pixel(uint x, uint y) const { return row(y) + x * pixelStride; }
+	size_t size() const { return rowStride * height; }
+	bool valid() const { return data != nullptr; }
+};
 
 class Image
 {
@@ -64,14 +98,28 @@ private:
 	uint channelAmount = 0;
 	uint pixelSizeInBytes = 0;
 	uint dataSize = 0;
+	// Tiled layout, blocks of 2^blockShift pixels a side
+	uint blockShift = 0;
+	uint blocksPerRow = 0;
 
 	uint positionToIndex(int x, int y) const;
+	// Position of a pixel in the image, in pixels and without clamping
+	size_t pixelOffset(uint x, uint y) const;
+	// How many pixels of the row are contiguous in memory from x on, up to stopX
+	uint contiguousPixels(uint x, uint stopX) const;
+	// Calls copy(image offset, tile offset, amount), in pixels, for every contiguous run of a tile clipped to
+	// the image
+	template <typename Function>
+	void forEachRun(uint x, uint y, uint width, uint height, Function copy) const;
+	template <typename T, typename ImageType>
+	static ImageView<T> makeView(ImageType &image);
 
 public:
 	Image(const ImageDesc &desc);
+	Image(const Image &other);
 	~Image() { delete[] data; }
 
-	void operator=(const Image &other);
+	Image &operator=(const Image &other);
 
 	ImageDesc getDesc() const { return descriptor; }
 	uint getWidth() const { return descriptor.width; }
@@ -79,97 +127,55 @@ public:
 	Real getAspectRatio() const { return aspectRatio; }
 	uint getChannelAmount() const { return channelAmount; }
 	uint getPixelSizeInBytes() const { return pixelSizeInBytes; }
+	ImageLayout getLayout() const { return descriptor.layout; }
+	// Samples in the order of the layout
 	const byte *getData() const { return data; }
 	void store(int x, int y, const byte *in);
 	void load(int x, int y, byte *out) const;
-};
-
-uint Image::positionToIndex(int x, int y) const
-{
-	x = math::clamp(x, 0, int(descriptor.width - 1));
-	y = math::clamp(y, 0, int(descriptor.height - 1));
-	return uint(x + y * descriptor.width) * pixelSizeInBytes;
-}
-
-Image::Image(const ImageDesc &desc)
-{
-	descriptor.width = math::max(desc.width, 1u);
-	descriptor.height = math::max(desc.height, 1u);
-	descriptor.format = desc.format;
-
-	aspectRatio = Real(descriptor.width) / Real(descriptor.height);
-
-	// Number of channels
-	switch (descriptor.format)
-	{
-		case ImageFormat::r32f:
-		case ImageFormat::r32ui:
-		case ImageFormat::r32si:
-		{
-			channelAmount = 1;
-			break;
-		}
-		case ImageFormat::r32g32b32f:
-		case ImageFormat::r32g32b32ui:
-		case ImageFormat::r32g32b32si:
-		{
-			channelAmount = 3;
-			break;
-		}
-		default:
-			channelAmount = 0;
-	};
-
-	// Number of bytes in one pixel
-	switch (descriptor.format)
-	{
-		case ImageFormat::r32f:
-		case ImageFormat::r32g32b32f:
-		{
-			pixelSizeInBytes = sizeof(float);
-			break;
-		}
-		case ImageFormat::r32ui:
-		case ImageFormat::r32g32b32ui:
-		{
-			pixelSizeInBytes = sizeof(uint);
-			break;
-		}
-		case ImageFormat::r32si:
-		case ImageFormat::r32g32b32si:
-		{
-			pixelSizeInBytes = sizeof(int);
-			break;
-		}
-		default:
-			pixelSizeInBytes = 0;
-	};
-	pixelSizeInBytes *= channelAmount;
-
-	dataSize = pixelSizeInBytes * descriptor.width * descriptor.height;
-	data = new byte[dataSize]();
-}
-
-void Image::operator=(const Image &other)
-{
-	if (descriptor != other.descriptor)
-	{
-		delete[] data;
-		std::memcpy(this, &other, sizeof(other));
-		data = new byte[dataSize];
-	}
-
-	std::memcpy(data, other.data, dataSize);
-}
 
-void Image::store(int x, int y, const byte *in)
-{
-	uint index = positionToIndex(x, y);
-	std::memcpy(&data[index], in, pixelSizeInBytes);
-}
+	// Bulk access, without the clamping of store and load. Rows are only contiguous in linear images, getRow
+	// returns null for tiled ones.
+	uint getRowSizeInBytes() const { return pixelSizeInBytes * descriptor.width; }
+	byte *getRow(uint y) { return descriptor.layout == ImageLayout::Linear ? data + size_t(y) * getRowSizeInBytes() : nullptr; }
+	const byte *getRow(uint y) const { return descriptor.layout == ImageLayout::Linear ? data + size_t(y) * getRowSizeInBytes() : nullptr; }
+	// Tiles of width by height packed pixels in the image format, in any layout, one copy per contiguous run of
+	// pixels. Parts outside of the image are skipped.
+	void storeTile(uint x, uint y, uint width, uint height, const byte *in);
+	void loadTile(uint x, uint y, uint width, uint height, byte *out) const;
+	// Views of the samples of linear images as T, invalid for tiled images or when pixels are not made of whole Ts
+	template <typename T>
+	ImageView<T> view() { return makeView<T>(*this); }
+	template <typename T>
+	ImageView<const T> view() const { return makeView<const T>(*this); }
+
+	// Colour formats convert to and from floats, all but the integer ones do.
+	// Colours keep the range the integrators write, 0 to 255.99 for displayable ones, which the normalized
+	// formats store as is (r8g8b8a8un bytes are truncated like in PPM files). Alpha goes from 0 to 1.
+	static bool isColourFormat(ImageFormat format);
+	// Converts amount pixels of one colour format into another, multiplying colours by scale on the way.
+	// Missing channels read as 0, and alpha as 1.
+	static void convertPixels(const byte *in, ImageFormat inFormat, byte *out, ImageFormat outFormat, size_t amount, float scale = 1.0f);
+	// Whole image into another of the same size, in the format and layout of the other. Tiled images are
+	// linearized this way before being written or uploaded.
+	void convertTo(Image &other, float scale = 1.0f) const;
+	// Pixel as red, green and blue floats, in any colour format
+	void storeColour(int x, int y, const float *rgb);
+	void loadColour(int x, int y, float *rgb) const;
+	// Tile of packed red, green and blue floats, converted row by row
+	void storeColourTile(uint x, uint y, uint width, uint height, const float *rgb);
+};
 
-void Image::load(int x, int y, byte *out) const
+template <typename T, typename ImageType>
+ImageView<T> Image::makeView(ImageType &image)
 {
-	uint index = positionToIndex(x, y);
-	std::memcpy(out, &data[index], pixelSizeInBytes);
+	ImageView<T> view;
+	if (image.descriptor.layout != ImageLayout::Linear || image.pixelSizeInBytes == 0 || image.pixelSizeInBytes % sizeof(T) != 0)
+		return view;
+
+	view.data = reinterpret_cast<T*>(image.data);
+	view.width = image.descriptor.width;
+	view.height = image.descriptor.height;
+	view.pixelStride = image.pixelSizeInBytes / sizeof(T);
+	view.rowStride = size_t(view.pixelStride) * view.width;
+	return view;
 }
@@ -0,0 +1,164 @@
+#include "ImageTexture.hpp"
+#include "File.hpp"
+#include "TextureProgram.hpp"
+
+#include <cmath>
+
+const uint ImageTexture::blockSize;
+
+Vec3 ImageTexture::texel(uint level, int x, int y) const
+{
+	// Repeated
+	int width = int(levelWidths[level]);
+	int height = int(levelHeights[level]);
+	x %= width;
+	y %= height;
+	x = x < 0 ? x + width : x;
+	y = y < 0 ? y + height : y;
+	float colour[3];
+	if (cache)
+		cache->loadTexel(cachedTexture, level, uint(x), uint(y), colour);
+	else
+		levels[level].loadColour(uint(x), uint(y), colour);
+	return Vec3(colour[0], colour[1], colour[2]);
+}
+
+Vec3 ImageTexture::sampleBilinear(uint level, Real u, Real v) const
+{
+	Real x = u * Real(levelWidths[level]) - Real(0.5);
+	Real y = v * Real(levelHeights[level]) - Real(0.5);
+	Real x0 = std::floor(x);
+	Real y0 = std::floor(y);
+	Real tx = x - x0;
+	Real ty = y - y0;
+	int ix = int(x0);
+	int iy = int(y0);
+
+	Vec3 bottom = texel(level, ix, iy) * (1 - tx) + texel(level, ix + 1, iy) * tx;
+	Vec3 top = texel(level, ix, iy + 1) * (1 - tx) + texel(level, ix + 1, iy + 1) * tx;
+	return bottom * (1 - ty) + top * ty;
+}
+
+bool ImageTexture::load(const std::string &fileName)
+{
+	std::vector<float> pixels;
+	uint width = 0;
+	uint height = 0;
+	bool linear = false;
+	if (!file::readImage(fileName, pixels, width, height, linear))
+		return false;
+
+	// Undo the gamma correction of the integrators
+	if (!linear)
+	{
+		for (float &value : pixels)
+			value *= value;
+	}
+	setTexels(pixels.data(), width, height);
+	return true;
+}
+
+bool ImageTexture::open(const std::string &fileName, TextureCache &textureCache)
+{
+	TextureCache::TextureId texture = textureCache.addFile(fileName);
+	if (texture == TextureCache::invalidTexture)
+		return false;
+
+	levels.clear();
+	levelWidths.clear();
+	levelHeights.clear();
+	for (uint level = 0; level < textureCache.getLevelAmount(texture); level++)
+	{
+		levelWidths.push_back(textureCache.getLevelWidth(texture, level));
+		levelHeights.push_back(textureCache.getLevelHeight(texture, level));
+	}
+	cache = &textureCache;
+	cachedTexture = texture;
+	return true;
+}
+
+void ImageTexture::setTexels(const float *colours, uint width, uint height)
+{
+	cache = nullptr;
+	cachedTexture = TextureCache::invalidTexture;
+	levels.clear();
+	levelWidths.assign(1, width);
+	levelHeights.assign(1, height);
+	ImageDesc desc;
+	desc.width = width;
+	desc.height = height;
+	desc.format = format;
+	desc.layout = ImageLayout::Tiled;
+	desc.blockSize = blockSize;
+	levels.emplace_back(desc);
+	levels.back().storeColourTile(0, 0, width, height, colours);
+
+	// Each level averages 2 by 2 texels of the previous one, the last texel of odd sizes is left out
+	std::vector<float> previous(colours, colours + size_t(width) * height * 3);
+	std::vector<float> current;
+	while (width > 1 || height > 1)
+	{
+		uint levelWidth = math::max(width / 2, 1u);
+		uint levelHeight = math::max(height / 2, 1u);
+		current.resize(size_t(levelWidth) * levelHeight * 3);
+		for (uint y = 0; y < levelHeight; y++)
+		{
+			uint y0 = math::min(2 * y, height - 1);
+			uint y1 = math::min(2 * y + 1, height - 1);
+			for (uint x = 0; x < levelWidth; x++)
+			{
+				uint x0 = math::min(2 * x, width - 1);
+				uint x1 = math::min(2 * x + 1, width - 1);
+				for (uint c = 0; c < 3; c++)
+				{
+					float sum = previous[(size_t(y0) * width + x0) * 3 + c] + previous[(size_t(y0) * width + x1) * 3 + c] +
+						previous[(size_t(y1) * width + x0) * 3 + c] + previous[(size_t(y1) * width + x1) * 3 + c];
+					current[(size_t(y) * levelWidth + x) * 3 + c] = sum * 0.25f;
+				}
+			}
+		}
+
+		width = levelWidth;
+		height = levelHeight;
+		desc.width = width;
+		desc.height = height;
+		levels.emplace_back(desc);
+		levelWidths.push_back(width);
+		levelHeights.push_back(height);
+		levels.back().storeColourTile(0, 0, width, height, current.data());
+		previous.swap(current);
+	}
+}
+
+Vec3 ImageTexture::sample(const Vec3& position) const
+{
+	return sampleSurface(TextureCoordinates(position, position.x, position.y));
+}
+
+Vec3 ImageTexture::sampleSurface(const TextureCoordinates &coordinates) const
+{
+	if (levelWidths.empty())
+		return Vec3();
+
+	// Level where a texel covers the footprint
+	Real texels = coordinates.footprint * Real(math::max(levelWidths[0], levelHeights[0]));
+	Real level = texels > 1 ? std::log2(texels) : 0;
+	uint lastLevel = uint(levelWidths.size() - 1);
+	if (level >= Real(lastLevel))
+		return sampleBilinear(lastLevel, coordinates.u, coordinates.v);
+
+	uint level0 = uint(level);
+	Real t = level - Real(level0);
+	Vec3 colour = sampleBilinear(level0, coordinates.u, coordinates.v);
+	if (t > 0)
+		colour = colour * (1 - t) + sampleBilinear(level0 + 1, coordinates.u, coordinates.v) * t;
+	return colour;
+}
+
+uint ImageTexture::compile(TextureProgram &program) const
+{
+	TextureNode node;
+	node.op = TextureOp::Image;
+	node.texture = this;
+	return program.addNode(node);
+}
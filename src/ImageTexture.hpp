@@ -0,0 +1,55 @@
+#pragma once
+
+#include "Common.hpp"
+
+#include "Image.hpp"
+#include "Texture.hpp"
+#include "TextureCache.hpp"
+#include "Vec3.hpp"
+
+#include <string>
+#include <vector>
+
+// Texture read from an image and mapped by the uv coordinates of surfaces, repeated beyond 0 to 1.
+// The texels are kept as a mip pyramid of linear colours, each level in tiled blocks so that neighbouring texels
+// share cache lines. Samples are filtered trilinearly, between the two levels closest to their footprint.
+// Opened textures leave their texels to a TextureCache instead, which loads them when first sampled.
+class ImageTexture : public Texture
+{
+private:
+	std::vector<Image> levels;
+	std::vector<uint> levelWidths;
+	std::vector<uint> levelHeights;
+	ImageFormat format;
+	TextureCache *cache = nullptr;
+	TextureCache::TextureId cachedTexture = TextureCache::invalidTexture;
+
+	Vec3 texel(uint level, int x, int y) const;
+	Vec3 sampleBilinear(uint level, Real u, Real v) const;
+
+public:
+	// Side of the blocks texels are stored in
+	static const uint blockSize = 8;
+
+	// Texels are stored in a float colour format, half floats unless told otherwise
+	ImageTexture(ImageFormat _format = ImageFormat::r16g16b16a16f) : format(_format) {}
+
+	// PPM or PFM file, PPM colours are gamma corrected like the ones written by file::writePpm
+	bool load(const std::string &fileName);
+	// Same files, only the header is read and the texels are loaded through the cache as they are sampled
+	bool open(const std::string &fileName, TextureCache &textureCache = TextureCache::global());
+	// Linear colours, 3 floats per texel, rows from the bottom one. Builds the mip pyramid.
+	void setTexels(const float *colours, uint width, uint height);
+
+	uint getLevelAmount() const { return uint(levelWidths.size()); }
+	uint getLevelWidth(uint level) const { return levelWidths[level]; }
+	uint getLevelHeight(uint level) const { return levelHeights[level]; }
+	// Only for textures which are not cached
+	const Image &getLevel(uint level) const { return levels[level]; }
+	bool isCached() const { return cache != nullptr; }
+
+	// The x and y coordinates of the position are used as uvs
+	virtual Vec3 sample(const Vec3& position) const override;
+	virtual Vec3 sampleSurface(const TextureCoordinates &coordinates) const override;
+	virtual uint compile(TextureProgram &program) const override;
+};
@@ -0,0 +1,70 @@
+#include "Instance.hpp"
+
+Instance::Instance(const Hitable &_geometry, const Transform &t, const Material *materialOverride)
+: geometry(_geometry)
+{
+	transform = t;
+	material = materialOverride;
+}
+
+// Bring a record found in geometry space back to world space
+void Instance::toWorld(const Ray &r, HitRecord &rec) const
+{
+	rec.t *= transform.scale();
+	rec.point = r.to(rec.t);
+	rec.normal = transform.applyRotation(rec.normal);
+	rec.uvDensity *= transform.inverseScale();
+	if (material)
+		rec.hitable = this;
+}
+
+bool Instance::hit(const Ray &r, Real minDist, Real maxDist, HitRecord &rec) const
+{
+	// Distances along the normalized local ray are divided by the scale
+	Ray ray = transform.applyInverse(r);
+	Real invScale = transform.inverseScale();
+	if (!geometry.hit(ray, minDist * invScale, maxDist * invScale, rec))
+		return false;
+
+	toWorld(r, rec);
+	return true;
+}
+
+bool Instance::hitWithSDF(const Vec3 &point, Real epsilon, HitRecord &rec) const
+{
+	// Scenes only ever lower the distance they are given
+	rec.t = math::maxReal();
+	bool hit = geometry.hitWithSDF(transform.applyInverse(point), epsilon * transform.inverseScale(), rec);
+	if (rec.t != math::maxReal())
+		rec.t *= transform.scale();
+	if (hit)
+	{
+		rec.point = point;
+		rec.normal = transform.applyRotation(rec.normal);
+		if (material)
+			rec.hitable = this;
+	}
+	return hit;
+}
+
+Real Instance::evaluateSDF(const Vec3 &point) const
+{
+	Real dist = geometry.evaluateSDF(transform.applyInverse(point));
+	if (dist == math::maxReal())
+		return dist;
+	return dist * transform.scale();
+}
+
+Vec3 Instance::evaluateNormalFromSDF(const Vec3 &point, Real epsilon) const
+{
+	return transform.applyRotation(geometry.evaluateNormalFromSDF(transform.applyInverse(point), epsilon * transform.inverseScale()));
+}
+
+bool Instance::boundingBox(BoundingBox &box) const
+{
+	BoundingBox geometryBox;
+	if (!geometry.boundingBox(geometryBox))
+		return false;
+	box = transform.apply(geometryBox);
+	return true;
+}
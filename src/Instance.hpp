@@ -0,0 +1,30 @@
+#pragma once
+
+#include "Common.hpp"
+
+#include "Hitable.hpp"
+
+class Material;
+
+// Places shared geometry (e.g. a TriangleMesh or a Scene) in the world with its own transform.
+// The geometry is referenced, not copied, so it must outlive all its instances. Its own transform
+// and acceleration structure are kept, the instance transform is applied on top.
+// When a material is given, it replaces the materials of the geometry for this instance.
+class Instance : public Hitable
+{
+private:
+	const Hitable &geometry;
+
+	void toWorld(const Ray &r, HitRecord &rec) const;
+
+public:
+	Instance(const Hitable &_geometry, const Transform &t, const Material *materialOverride = nullptr);
+
+	virtual bool hit(const Ray &r, Real minDist, Real maxDist, HitRecord &rec) const override;
+	virtual bool hitWithSDF(const Vec3 &point, Real epsilon, HitRecord &rec) const override;
+	virtual Real evaluateSDF(const Vec3 &point) const override;
+	virtual Vec3 evaluateNormalFromSDF(const Vec3 &point, Real epsilon) const override;
+	virtual bool boundingBox(BoundingBox &box) const override;
+
+	const Hitable &getGeometry() const { return geometry; }
+};
@@ -0,0 +1,23 @@
+#include "Lambertian.hpp"
+
+Lambertian::Lambertian(const Vec3 &albedo)
+{
+	texture = new ConstantTexture(albedo);
+	ownedTexture = true;
+	program.compile(*texture);
+}
+
+Lambertian::~Lambertian()
+{
+	if (ownedTexture)
+		delete texture;
+}
+
+bool Lambertian::scatter(const Ray &rIn, const HitRecord &hr, Vec3 &attenuation, Ray &scattered) const
+{
+	statsIncrement(ScatterLambertian);
+	Vec3 lambertianOut = hr.normal + sampleUnitSphere();
+	scattered = spawnRay(hr.point, hr.normal, lambertianOut);
+	attenuation = program.evaluate(TextureCoordinates(hr.point, hr.u, hr.v, hr.uvFootprint(rIn)));
+	return true;
+}
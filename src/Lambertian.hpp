@@ -7,37 +7,20 @@
 #include "Math.hpp"
 #include "Sampling.hpp"
 #include "Texture.hpp"
+#include "TextureProgram.hpp"
 
+// The texture is compiled when the material is made, it must be complete by then
 class Lambertian : public Material
 {
 private:
 	const Texture *texture = nullptr;
 	bool ownedTexture = false;
+	TextureProgram program;
 
 public:
 	Lambertian(const Vec3 &albedo);
-	Lambertian(const Texture &_texture) { texture = &_texture; }
+	Lambertian(const Texture &_texture) : texture(&_texture), program(_texture) {}
 	~Lambertian();
 
 	virtual bool scatter(const Ray &rIn, const HitRecord &hr, Vec3 &attenuation, Ray &scattered) const override;
 };
-
-Lambertian::Lambertian(const Vec3 &albedo)
-{
-	texture = new ConstantTexture(albedo);
-	ownedTexture = true;
-}
-
-Lambertian::~Lambertian()
-{
-	if (ownedTexture)
-		delete texture;
-}
-
-bool Lambertian::scatter(const Ray &rIn, const HitRecord &hr, Vec3 &attenuation, Ray &scattered) const
-{
-	Vec3 lambertianOut = hr.normal + sampleUnitSphere();
-	scattered = Ray(hr.point, lambertianOut);
-	attenuation = texture->sample(hr.point);
-	return true;
-}
@@ -0,0 +1,75 @@
+#include "MappedFile.hpp"
+
+#include <fstream>
+#include <iostream>
+
+#if defined(_WIN32)
+#define RAYTRACER_NO_MMAP
+#else
+#include <fcntl.h>
+#include <sys/mman.h>
+#include <sys/stat.h>
+#include <unistd.h>
+#endif
+
+bool MappedFile::open(const std::string &fileName)
+{
+	close();
+
+#ifndef RAYTRACER_NO_MMAP
+	int fd = ::open(fileName.c_str(), O_RDONLY);
+	if (fd >= 0)
+	{
+		struct stat fileStat;
+		if (fstat(fd, &fileStat) == 0 && fileStat.st_size > 0)
+		{
+			void *address = mmap(nullptr, size_t(fileStat.st_size), PROT_READ, MAP_PRIVATE, fd, 0);
+			if (address != MAP_FAILED)
+			{
+				data = static_cast<const byte *>(address);
+				dataSize = size_t(fileStat.st_size);
+				mapped = true;
+			}
+		}
+		::close(fd);
+		if (mapped)
+			return true;
+	}
+#endif
+
+	std::ifstream file(fileName, std::ios::binary | std::ios::ate);
+	if (!file.is_open())
+	{
+		std::cerr << "Could not open file " << fileName << " for reading." << std::endl;
+		return false;
+	}
+
+	std::streamoff size = file.tellg();
+	if (size <= 0)
+		return false;
+	fallbackData.resize(size_t(size));
+	file.seekg(0);
+	file.read(reinterpret_cast<char *>(fallbackData.data()), size);
+	if (!file)
+	{
+		fallbackData.clear();
+		return false;
+	}
+
+	data = fallbackData.data();
+	dataSize = fallbackData.size();
+	return true;
+}
+
+void MappedFile::close()
+{
+#ifndef RAYTRACER_NO_MMAP
+	if (mapped)
+		munmap(const_cast<byte *>(data), dataSize);
+#endif
+	fallbackData.clear();
+	fallbackData.shrink_to_fit();
+	data = nullptr;
+	dataSize = 0;
+	mapped = false;
+}
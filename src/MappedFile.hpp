@@ -0,0 +1,31 @@
+#pragma once
+
+#include "Common.hpp"
+
+#include <cstddef>
+#include <string>
+#include <vector>
+
+// Read-only view of a whole file. The file is memory mapped where supported, so its content is paged
+// in on access instead of being read up front. Elsewhere it is read into memory once.
+class MappedFile
+{
+private:
+	const byte *data = nullptr;
+	size_t dataSize = 0;
+	bool mapped = false;
+	std::vector<byte> fallbackData;
+
+public:
+	MappedFile() {}
+	MappedFile(const MappedFile &other) = delete;
+	MappedFile &operator=(const MappedFile &other) = delete;
+	~MappedFile() { close(); }
+
+	bool open(const std::string &fileName);
+	void close();
+
+	bool isOpen() const { return data != nullptr; }
+	const byte *getData() const { return data; }
+	size_t getSize() const { return dataSize; }
+};
@@ -4,6 +4,7 @@
 
 #include "Hitable.hpp"
 #include "Ray.hpp"
+#include "Stats.hpp"
 #include "Vec3.hpp"
 
 class Material
@@ -15,7 +16,7 @@ public:
 	virtual Vec3 emitted(const Vec3 &p) const { return Vec3(); }
 };
 
-Real schlick(Real cosine, Real refractionIndex)
+inline Real schlick(Real cosine, Real refractionIndex)
 {
 	// Assuming air is the outside medium
 	const Real mediumRefractionIndex = 1;
@@ -24,6 +24,16 @@ inline Real maxReal()
 	return std::numeric_limits<Real>::max();
 }
 
+// Smallest distance accepted for a hit, to absorb the error left in intersection routines
+inline Real minHitDistance()
+{
+#ifdef RAYTRACER_DOUBLE_PRECISION
+	return Real(1e-7);
+#else
+	return Real(1e-4);
+#endif
+}
+
 inline uint min(uint a, uint b)
 {
 	return a < b ? a : b;
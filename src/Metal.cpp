@@ -0,0 +1,23 @@
+#include "Metal.hpp"
+
+bool Metal::scatter(const Ray &rIn, const HitRecord &hr, Vec3 &attenuation, Ray &scattered) const
+{
+	statsIncrement(ScatterMetal);
+	Vec3 reflected = reflect(rIn.direction(), hr.normal);
+	if (roughness)
+	{
+		// Regenerate reflected rays that fall below the surface
+		uint count = 0;
+		Vec3 reflectedAttempt;
+		do
+		{
+			reflectedAttempt = reflected + roughness * sampleUnitSphere();
+			count++;
+		}
+		while (count < 10 && dot(hr.normal, reflectedAttempt) < 0.0);
+		reflected = reflectedAttempt;
+	}
+	scattered = spawnRay(hr.point, hr.normal, reflected);
+	attenuation = albedo;
+	return dot(reflected, hr.normal) > 0;
+}
@@ -0,0 +1,179 @@
+#include "Noise.hpp"
+
+#include <cmath>
+#include <cstdint>
+
+namespace noise
+{
+
+namespace
+{
+
+// Mixes the lattice coordinates, the low 4 bits pick the gradient
+inline uint32_t hashLattice(int32_t x, int32_t y, int32_t z)
+{
+	uint32_t h = (uint32_t(x) * 0x8da6b343u) ^ (uint32_t(y) * 0xd8163841u) ^ (uint32_t(z) * 0xcb1ab31fu);
+	h ^= h >> 15;
+	h *= 0x2c1b3c6du;
+	h ^= h >> 12;
+	return h;
+}
+
+// Dot product with one of the 12 edge directions of a cube, 4 of them repeated
+inline float gradient(uint32_t hash, float x, float y, float z)
+{
+	uint32_t h = hash & 15;
+	float u = h < 8 ? x : y;
+	float v = h < 4 ? y : (h == 12 || h == 14 ? x : z);
+	return ((h & 1) ? -u : u) + ((h & 2) ? -v : v);
+}
+
+inline float fade(float t)
+{
+	return t * t * t * (t * (t * 6.0f - 15.0f) + 10.0f);
+}
+
+// Lattice cell below the coordinate, by truncation which vectorizes without SSE4.1. Coordinates are well within
+// the range of int32_t.
+inline int32_t floorToInt(float x)
+{
+	int32_t truncated = int32_t(x);
+	return truncated - int32_t(x < float(truncated));
+}
+
+inline float lerp(float t, float a, float b)
+{
+	return a + t * (b - a);
+}
+
+inline float perlinLane(float x, float y, float z)
+{
+	int32_t ix = floorToInt(x);
+	int32_t iy = floorToInt(y);
+	int32_t iz = floorToInt(z);
+	x -= float(ix);
+	y -= float(iy);
+	z -= float(iz);
+	float u = fade(x);
+	float v = fade(y);
+	float w = fade(z);
+
+	float n000 = gradient(hashLattice(ix, iy, iz), x, y, z);
+	float n100 = gradient(hashLattice(ix + 1, iy, iz), x - 1.0f, y, z);
+	float n010 = gradient(hashLattice(ix, iy + 1, iz), x, y - 1.0f, z);
+	float n110 = gradient(hashLattice(ix + 1, iy + 1, iz), x - 1.0f, y - 1.0f, z);
+	float n001 = gradient(hashLattice(ix, iy, iz + 1), x, y, z - 1.0f);
+	float n101 = gradient(hashLattice(ix + 1, iy, iz + 1), x - 1.0f, y, z - 1.0f);
+	float n011 = gradient(hashLattice(ix, iy + 1, iz + 1), x, y - 1.0f, z - 1.0f);
+	float n111 = gradient(hashLattice(ix + 1, iy + 1, iz + 1), x - 1.0f, y - 1.0f, z - 1.0f);
+
+	float n00 = lerp(u, n000, n100);
+	float n10 = lerp(u, n010, n110);
+	float n01 = lerp(u, n001, n101);
+	float n11 = lerp(u, n011, n111);
+	return lerp(w, lerp(v, n00, n10), lerp(v, n01, n11));
+}
+
+}	// namespace
+
+Real perlin(const Vec3 &position)
+{
+	return Real(perlinLane(float(position.x), float(position.y), float(position.z)));
+}
+
+Real turbulence(const Vec3 &position, uint octaves)
+{
+	float x = float(position.x);
+	float y = float(position.y);
+	float z = float(position.z);
+	float sum = 0.0f;
+	float weight = 1.0f;
+	for (uint octave = 0; octave < octaves; octave++)
+	{
+		sum += weight * std::fabs(perlinLane(x, y, z));
+		x *= 2.0f;
+		y *= 2.0f;
+		z *= 2.0f;
+		weight *= 0.5f;
+	}
+	return Real(sum);
+}
+
+// In stages over all the lanes, each a short loop the compiler turns into vector instructions. A single loop
+// over perlinLane is too large a body for it.
+void perlinBatch(const float *x, const float *y, const float *z, float *values)
+{
+	int32_t ix[batchSize];
+	int32_t iy[batchSize];
+	int32_t iz[batchSize];
+	float px[batchSize];
+	float py[batchSize];
+	float pz[batchSize];
+	for (uint i = 0; i < batchSize; i++)
+	{
+		ix[i] = floorToInt(x[i]);
+		iy[i] = floorToInt(y[i]);
+		iz[i] = floorToInt(z[i]);
+		px[i] = x[i] - float(ix[i]);
+		py[i] = y[i] - float(iy[i]);
+		pz[i] = z[i] - float(iz[i]);
+	}
+
+	// Corners in the order of perlinLane, x first
+	float corners[8][batchSize];
+	for (uint corner = 0; corner < 8; corner++)
+	{
+		int32_t dx = int32_t(corner & 1);
+		int32_t dy = int32_t((corner >> 1) & 1);
+		int32_t dz = int32_t(corner >> 2);
+		for (uint i = 0; i < batchSize; i++)
+		{
+			uint32_t hash = hashLattice(ix[i] + dx, iy[i] + dy, iz[i] + dz);
+			corners[corner][i] = gradient(hash, px[i] - float(dx), py[i] - float(dy), pz[i] - float(dz));
+		}
+	}
+
+	for (uint i = 0; i < batchSize; i++)
+	{
+		float u = fade(px[i]);
+		float v = fade(py[i]);
+		float w = fade(pz[i]);
+		float n00 = lerp(u, corners[0][i], corners[1][i]);
+		float n10 = lerp(u, corners[2][i], corners[3][i]);
+		float n01 = lerp(u, corners[4][i], corners[5][i]);
+		float n11 = lerp(u, corners[6][i], corners[7][i]);
+		values[i] = lerp(w, lerp(v, n00, n10), lerp(v, n01, n11));
+	}
+}
+
+void turbulenceBatch(const float *x, const float *y, const float *z, uint octaves, float *values)
+{
+	float px[batchSize];
+	float py[batchSize];
+	float pz[batchSize];
+	float octave[batchSize];
+	for (uint i = 0; i < batchSize; i++)
+	{
+		px[i] = x[i];
+		py[i] = y[i];
+		pz[i] = z[i];
+		values[i] = 0.0f;
+	}
+
+	// Same order of operations as turbulence
+	float weight = 1.0f;
+	for (uint o = 0; o < octaves; o++)
+	{
+		perlinBatch(px, py, pz, octave);
+		for (uint i = 0; i < batchSize; i++)
+		{
+			values[i] += weight * std::fabs(octave[i]);
+			px[i] *= 2.0f;
+			py[i] *= 2.0f;
+			pz[i] *= 2.0f;
+		}
+		weight *= 0.5f;
+	}
+}
+
+}	// namespace noise
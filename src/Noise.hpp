@@ -0,0 +1,28 @@
+#pragma once
+
+#include "Common.hpp"
+
+#include "Vec3.hpp"
+
+// Gradient noise
+//
+// Improved Perlin noise, with lattice gradients picked by an integer hash instead of a permutation table so that
+// every step is plain arithmetic. The batch functions evaluate batchSize positions at once, in stages of fixed
+// size loops the compiler vectorizes. They pay off with the vector selects of SSE4.1 and later, see
+// RAYTRACER_NATIVE_ARCH. Both paths compute in float and give the same values up to fused multiply-adds.
+namespace noise
+{
+
+// Positions evaluated together by the batch functions
+const uint batchSize = 8;
+
+// Between about -1 and 1
+Real perlin(const Vec3 &position);
+// Sum of the absolute noise of octaves, each twice the frequency and half the weight of the previous one
+Real turbulence(const Vec3 &position, uint octaves);
+
+// batchSize positions, by coordinate
+void perlinBatch(const float *x, const float *y, const float *z, float *values);
+void turbulenceBatch(const float *x, const float *y, const float *z, uint octaves, float *values);
+
+}	// namespace noise
@@ -0,0 +1,114 @@
+#include "NoiseTexture.hpp"
+#include "Noise.hpp"
+#include "TextureProgram.hpp"
+
+#include <cmath>
+
+namespace
+{
+
+// Scaled coordinates of a batch of positions, the last one repeated past the amount
+void loadLanes(const Vec3 *positions, uint amount, Real scale, float *x, float *y, float *z)
+{
+	for (uint i = 0; i < noise::batchSize; i++)
+	{
+		const Vec3 &position = positions[math::min(i, amount - 1)];
+		x[i] = float(scale * position.x);
+		y[i] = float(scale * position.y);
+		z[i] = float(scale * position.z);
+	}
+}
+
+uint compileLeaf(TextureProgram &program, TextureOp op, const Texture &texture)
+{
+	TextureNode node;
+	node.op = op;
+	node.texture = &texture;
+	return program.addNode(node);
+}
+
+inline Real marbleShade(Real scale, Real z, Real turbulence)
+{
+	return 0.5 * (1 + std::sin(scale * z + 10 * turbulence));
+}
+
+}	// namespace
+
+Vec3 NoiseTexture::sample(const Vec3& position) const
+{
+	return albedo * (0.5 * (1 + noise::perlin(scale * position)));
+}
+
+void NoiseTexture::sampleMany(const Vec3 *positions, uint amount, Vec3 *colours) const
+{
+	float x[noise::batchSize];
+	float y[noise::batchSize];
+	float z[noise::batchSize];
+	float values[noise::batchSize];
+	for (uint start = 0; start < amount; start += noise::batchSize)
+	{
+		uint count = math::min(noise::batchSize, amount - start);
+		loadLanes(positions + start, count, scale, x, y, z);
+		noise::perlinBatch(x, y, z, values);
+		for (uint i = 0; i < count; i++)
+			colours[start + i] = albedo * (0.5 * (1 + Real(values[i])));
+	}
+}
+
+uint NoiseTexture::compile(TextureProgram &program) const
+{
+	return compileLeaf(program, TextureOp::Noise, *this);
+}
+
+Vec3 TurbulenceTexture::sample(const Vec3& position) const
+{
+	return albedo * noise::turbulence(scale * position, octaves);
+}
+
+void TurbulenceTexture::sampleMany(const Vec3 *positions, uint amount, Vec3 *colours) const
+{
+	float x[noise::batchSize];
+	float y[noise::batchSize];
+	float z[noise::batchSize];
+	float values[noise::batchSize];
+	for (uint start = 0; start < amount; start += noise::batchSize)
+	{
+		uint count = math::min(noise::batchSize, amount - start);
+		loadLanes(positions + start, count, scale, x, y, z);
+		noise::turbulenceBatch(x, y, z, octaves, values);
+		for (uint i = 0; i < count; i++)
+			colours[start + i] = albedo * Real(values[i]);
+	}
+}
+
+uint TurbulenceTexture::compile(TextureProgram &program) const
+{
+	return compileLeaf(program, TextureOp::Turbulence, *this);
+}
+
+Vec3 MarbleTexture::sample(const Vec3& position) const
+{
+	// The turbulence is not scaled, only the stripes
+	return albedo * marbleShade(scale, position.z, noise::turbulence(position, octaves));
+}
+
+void MarbleTexture::sampleMany(const Vec3 *positions, uint amount, Vec3 *colours) const
+{
+	float x[noise::batchSize];
+	float y[noise::batchSize];
+	float z[noise::batchSize];
+	float values[noise::batchSize];
+	for (uint start = 0; start < amount; start += noise::batchSize)
+	{
+		uint count = math::min(noise::batchSize, amount - start);
+		loadLanes(positions + start, count, 1, x, y, z);
+		noise::turbulenceBatch(x, y, z, octaves, values);
+		for (uint i = 0; i < count; i++)
+			colours[start + i] = albedo * marbleShade(scale, positions[start + i].z, Real(values[i]));
+	}
+}
+
+uint MarbleTexture::compile(TextureProgram &program) const
+{
+	return compileLeaf(program, TextureOp::Marble, *this);
+}
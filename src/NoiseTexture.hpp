@@ -0,0 +1,58 @@
+#pragma once
+
+#include "Common.hpp"
+
+#include "Texture.hpp"
+#include "Vec3.hpp"
+
+// Procedural textures on gradient noise, see Noise.hpp. Positions are scaled by a frequency and the albedo is
+// modulated by the noise. sampleMany evaluates them noise::batchSize at a time.
+
+// Noise remapped to 0 to 1
+class NoiseTexture : public Texture
+{
+private:
+	Vec3 albedo;
+	Real scale = 1;
+
+public:
+	NoiseTexture(Real _scale = 1, const Vec3 &_albedo = Vec3(1, 1, 1)) : albedo(_albedo), scale(_scale) {}
+
+	virtual Vec3 sample(const Vec3& position) const override;
+	virtual void sampleMany(const Vec3 *positions, uint amount, Vec3 *colours) const override;
+	virtual uint compile(TextureProgram &program) const override;
+};
+
+// Sum of octaves of absolute noise, veins like smoke or clouds
+class TurbulenceTexture : public Texture
+{
+private:
+	Vec3 albedo;
+	Real scale = 1;
+	uint octaves = 7;
+
+public:
+	TurbulenceTexture(Real _scale = 1, uint _octaves = 7, const Vec3 &_albedo = Vec3(1, 1, 1))
+	: albedo(_albedo), scale(_scale), octaves(_octaves) {}
+
+	virtual Vec3 sample(const Vec3& position) const override;
+	virtual void sampleMany(const Vec3 *positions, uint amount, Vec3 *colours) const override;
+	virtual uint compile(TextureProgram &program) const override;
+};
+
+// Stripes along z of the given frequency, their phase shifted by turbulence
+class MarbleTexture : public Texture
+{
+private:
+	Vec3 albedo;
+	Real scale = 1;
+	uint octaves = 7;
+
+public:
+	MarbleTexture(Real _scale = 1, uint _octaves = 7, const Vec3 &_albedo = Vec3(1, 1, 1))
+	: albedo(_albedo), scale(_scale), octaves(_octaves) {}
+
+	virtual Vec3 sample(const Vec3& position) const override;
+	virtual void sampleMany(const Vec3 *positions, uint amount, Vec3 *colours) const override;
+	virtual uint compile(TextureProgram &program) const override;
+};
@@ -2,18 +2,54 @@
 
 #include "Common.hpp"
 
+#include "Image.hpp"
+#include "Vec3.hpp"
 #include "Viewport.hpp"
 
+// What is known of a pixel besides its colour
+struct PixelState
+{
+	uint samples = 1;
+	// Variance of the estimated colour, on the luminance of linear colours
+	float variance = 0.0f;
+};
+
 // Inherit this class to allow the Renderer to render individual pixels.
 // Define prerecorded inputs and outputs for each inherited type.
 class PixelRenderer
 {
 protected:
 	Viewport viewport;
+	// Where renderPixel stores the pixels, if anywhere
+	Image *image = nullptr;
 
 public:
-	PixelRenderer(const Viewport &vp) { viewport = vp; }
+	PixelRenderer(const Viewport &vp, Image *img = nullptr) { viewport = vp; image = img; }
+	virtual ~PixelRenderer() {}
+
+	// Colour of the pixel, in the range the integrators store in images
+	virtual Vec3 shadePixel(uint col, uint row) const = 0;
+	// Also fills in the state of the pixel, integrators which take several samples override it
+	virtual Vec3 shadePixelWithState(uint col, uint row, PixelState &state) const
+	{
+		state = PixelState();
+		return shadePixel(col, row);
+	}
+
+	// Shades the pixel and stores it in the image
+	virtual void renderPixel(uint col, uint row) const
+	{
+		Vec3 colour = shadePixel(col, row);
+		if (!image)
+			return;
+
+		float colourArray[3];
+		colourArray[0] = colour.r;
+		colourArray[1] = colour.g;
+		colourArray[2] = colour.b;
+		image->storeColour(int(col), int(row), colourArray);
+	}
 
-	virtual void renderPixel(uint col, uint row) const = 0;
 	const Viewport &getViewport() const { return viewport; }
+	Image *getImage() const { return image; }
 };
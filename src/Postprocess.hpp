@@ -2,8 +2,14 @@
 
 #include "Vec3.hpp"
 
-Vec3 gammaCorrect(const Vec3 &colour)
+inline Vec3 gammaCorrect(const Vec3 &colour)
 {
 	// Gamma 2 correction
 	return sqrt(colour);
 }
+
+// Relative luminance of a linear colour, with Rec. 709 primaries
+inline Real luminance(const Vec3 &colour)
+{
+	return Real(0.2126) * colour.r + Real(0.7152) * colour.g + Real(0.0722) * colour.b;
+}
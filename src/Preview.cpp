@@ -0,0 +1,56 @@
+#include "Preview.hpp"
+
+Vec3 Preview::getColour(const Ray &r) const
+{
+	statsIncrement(Rays);
+	HitRecord rec;
+	if (scene.hit(r, math::minHitDistance(), math::maxReal(), rec))
+	{
+		const Material *material = rec.hitable ? rec.hitable->getMaterial() : nullptr;
+		Vec3 emission = material ? material->emitted(rec.point) : Vec3();
+		Vec3 scattering;
+
+		Ray scattered;
+		Vec3 attenuation;
+		if (material && material->scatter(r, rec, attenuation, scattered))
+		{
+			if (useFakeLight)
+			{
+				scattering += attenuation * fakeAmbientLight;
+				scattering += attenuation * fakeLightColor * math::max(0.0, dot(scattered.direction(), fakeLightDirection));
+			}
+			else
+			{
+				scattering += attenuation * scene.background().sample(scattered.direction());
+			}
+		}
+
+		return emission + scattering;
+	}
+
+	return scene.background().sample(r.direction());
+}
+
+Preview::Preview(const Scene &s, const Camera &cam, const Viewport &vp, Image &img)
+: PixelRenderer(vp, &img)
+, camera(cam)
+, scene(s)
+{
+	setFakeLightDirection(Vec3(-1, -1, 1));
+}
+
+Vec3 Preview::shadePixel(uint col, uint row) const
+{
+	Real u = Real(col) + 0.5;
+	Real v = Real(row) + 0.5;
+	u *= viewport.widthInv();
+	v *= viewport.heightInv();
+	Ray r = camera.getRay(u, v, false);
+	Vec3 colour = getColour(r);
+
+	u = Real(col + uniformRand()) * viewport.widthInv();
+	v = Real(row + uniformRand()) * viewport.heightInv();
+	r = camera.getRay(u, v, false);
+	colour += getColour(r);
+	return 255.99 * gammaCorrect(colour);
+}
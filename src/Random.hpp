@@ -4,9 +4,21 @@
 
 #include <random>
 
-inline Real uniformRand()
+// Each thread draws from its own engine, starting from the default seed
+inline std::default_random_engine &randomEngine()
 {
 	static thread_local std::default_random_engine engine;
+	return engine;
+}
+
+// Restart the sequence of the calling thread only
+inline void seedRandom(uint seed)
+{
+	randomEngine().seed(seed);
+}
+
+inline Real uniformRand()
+{
 	std::uniform_real_distribution<Real> distribution(0.0, 1.0);
-	return distribution(engine);
+	return distribution(randomEngine());
 }
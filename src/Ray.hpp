@@ -4,17 +4,81 @@
 
 #include "Vec3.hpp"
 
+#include <cstdint>
+#include <cstring>	// For memcpy
+
 class Ray
 {
 private:
 	Vec3 o;
 	Vec3 d;
+	// Growth of the width of the ray footprint per unit of distance, 0 for rays of no known width
+	Real s = 0;
 
 public:
 	Ray() { o = Vec3(); d = Vec3(0, 0, -1); }
-	Ray(const Vec3 &_o, const Vec3 &_d) { o = _o; d = normalize(_d); }
+	Ray(const Vec3 &_o, const Vec3 &_d, Real _spread = 0) { o = _o; d = normalize(_d); s = _spread; }
 
 	const Vec3 &origin() const { return o; }
 	const Vec3 &direction() const { return d; }
+	Real spread() const { return s; }
 	inline Vec3 to(Real t) const { return o + t * d; }
 };
+
+// Integer view of Real used to step by units in the last place
+template <typename T>
+struct RealBits;
+
+template <>
+struct RealBits<float>
+{
+	typedef int32_t Integer;
+	static float origin() { return 1.0f / 32.0f; }
+	static float floatScale() { return 1.0f / 65536.0f; }
+	static float intScale() { return 256.0f; }
+};
+
+template <>
+struct RealBits<double>
+{
+	typedef int64_t Integer;
+	static double origin() { return 1.0 / 32.0; }
+	static double floatScale() { return 1.0 / 35184372088832.0; }	// 2^-45
+	static double intScale() { return 256.0; }
+};
+
+// Move a point lying on a surface away from it along the normal, on the side the direction points to.
+// The offset is a fixed number of ulps, so it scales with the magnitude of the coordinates instead of
+// relying on a global epsilon. From "A Fast and Robust Method for Avoiding Self-Intersection",
+// Wächter and Binder, Ray Tracing Gems.
+inline Vec3 offsetRayOrigin(const Vec3 &p, const Vec3 &n, const Vec3 &direction)
+{
+	typedef RealBits<Real> Bits;
+	typedef Bits::Integer Integer;
+
+	Vec3 normal = dot(n, direction) >= 0 ? n : -n;
+	Vec3 res;
+	for (uint i = 0; i < 3; i++)
+	{
+		Real value = p[i];
+		if (math::abs(value) < Bits::origin())
+		{
+			res[i] = value + Bits::floatScale() * normal[i];
+			continue;
+		}
+
+		Integer offset = Integer(Bits::intScale() * normal[i]);
+		Integer bits;
+		std::memcpy(&bits, &value, sizeof(Real));
+		bits += value < 0 ? -offset : offset;
+		std::memcpy(&value, &bits, sizeof(Real));
+		res[i] = value;
+	}
+	return res;
+}
+
+// Ray leaving a surface hit point, offset to avoid self-intersection
+inline Ray spawnRay(const Vec3 &point, const Vec3 &normal, const Vec3 &direction)
+{
+	return Ray(offsetRayOrigin(point, normal, direction), direction);
+}
@@ -0,0 +1,82 @@
+#include "Raymarch.hpp"
+
+Vec3 Raymarch::getColour(const Ray &r, uint bounces) const
+{
+	statsIncrement(Rays);
+	bool hit = false;
+	HitRecord rec;
+	Real dist = 0.0;
+	uint iteration = 0;
+	for (; iteration < maxRayIterations; iteration++)
+	{
+		Vec3 point = r.to(dist);
+		rec.t = math::maxReal();
+		hit = scene.hitWithSDF(point, hitEpsilon, rec);
+
+		rec.t = math::abs(rec.t);
+		dist += rec.t;
+
+		if (hit || dist < rec.t || dist > maxRayLength)
+			break;
+	}
+	statsAdd(RaymarchIterations, math::min(iteration + 1, maxRayIterations));
+
+	if (hit)
+	{
+		Ray scattered;
+		Vec3 attenuation;
+		const Material *material = rec.hitable ? rec.hitable->getMaterial() : nullptr;
+		Vec3 emission = material ? material->emitted(rec.point) : Vec3();
+
+		if (bounces < maxBounces && material && material->scatter(r, rec, attenuation, scattered))
+		{
+			statsIncrement(Bounces);
+			Vec3 pushNormal = dot(rec.normal, scattered.direction()) >= 0.0 ? rec.normal : -rec.normal;
+			scattered = Ray(scattered.origin() + pushNormal * hitEpsilon, scattered.direction());
+			return emission + getColour(scattered, bounces + 1) * attenuation;
+		}
+		else
+		{
+			return emission;
+		}
+	}
+
+	return scene.background().sample(r.direction());
+}
+
+Raymarch::Raymarch(const Scene &s, const Camera &cam, const Viewport &vp, Image &im)
+: PixelRenderer(vp, &im)
+, camera(cam)
+, scene(s)
+{}
+
+Vec3 Raymarch::shadePixel(uint col, uint row) const
+{
+	Real u = Real(col);
+	Real v = Real(row);
+	if (samplesPerPixel > 1)
+	{
+		u += uniformRand();
+		v += uniformRand();
+	}
+	else
+	{
+		u += 0.5;
+		v += 0.5;
+	}
+	u *= viewport.widthInv();
+	v *= viewport.heightInv();
+	Ray r = camera.getRay(u, v);
+	Vec3 colour = getColour(r);
+
+	for (uint i = 1; i < samplesPerPixel; i++)
+	{
+		u = Real(col + uniformRand()) * viewport.widthInv();
+		v = Real(row + uniformRand()) * viewport.heightInv();
+		r = camera.getRay(u, v);
+		colour += getColour(r);
+	}
+
+	colour /= samplesPerPixel;
+	return 255.99 * gammaCorrect(colour);
+}
@@ -0,0 +1,77 @@
+#include "Raytrace.hpp"
+
+// TODO: this is recursive, try iterative
+Vec3 Raytrace::getColour(const Ray &r, uint bounces) const
+{
+	statsIncrement(Rays);
+	HitRecord rec;
+	if (scene.hit(r, math::minHitDistance(), math::maxReal(), rec))
+	{
+		Ray scattered;
+		Vec3 attenuation;
+		const Material *material = rec.hitable ? rec.hitable->getMaterial() : nullptr;
+		Vec3 emission = material ? material->emitted(rec.point) : Vec3();
+		if (bounces < maxBounces && material && material->scatter(r, rec, attenuation, scattered))
+		{
+			statsIncrement(Bounces);
+			return emission + getColour(scattered, bounces + 1) * attenuation;
+		}
+		else
+			return emission;
+	}
+
+	return scene.background().sample(r.direction());
+}
+
+Raytrace::Raytrace(const Scene &s, const Camera &cam, const Viewport &vp, Image &img)
+: PixelRenderer(vp, &img)
+, camera(cam)
+, scene(s)
+{}
+
+Vec3 Raytrace::samplePixel(uint col, uint row, PixelState *state) const
+{
+	Real u = Real(col);
+	Real v = Real(row);
+	if (samplesPerPixel > 1)
+	{
+		u += uniformRand();
+		v += uniformRand();
+	}
+	else
+	{
+		u += 0.5;
+		v += 0.5;
+	}
+	u *= viewport.widthInv();
+	v *= viewport.heightInv();
+	Ray r = camera.getRay(u, v);
+	Vec3 colour = getColour(r);
+
+	// Running mean and sum of squared differences of the sample luminances
+	Real mean = luminance(colour);
+	Real squaredDifferences = 0;
+	for (uint i = 1; i < samplesPerPixel; i++)
+	{
+		u = Real(col + uniformRand()) * viewport.widthInv();
+		v = Real(row + uniformRand()) * viewport.heightInv();
+		r = camera.getRay(u, v);
+		Vec3 sample = getColour(r);
+		colour += sample;
+		if (state)
+		{
+			Real delta = luminance(sample) - mean;
+			mean += delta / Real(i + 1);
+			squaredDifferences += delta * (luminance(sample) - mean);
+		}
+	}
+
+	colour /= samplesPerPixel;
+	if (state)
+	{
+		// Variance of the mean of the samples
+		state->samples = samplesPerPixel;
+		state->variance = samplesPerPixel > 1 ? float(squaredDifferences / Real(samplesPerPixel - 1) / Real(samplesPerPixel)) : 0.0f;
+	}
+	return 255.99 * gammaCorrect(colour);
+}
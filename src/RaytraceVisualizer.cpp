@@ -0,0 +1,64 @@
+#include "RaytraceVisualizer.hpp"
+
+Vec3 RaytraceVisualizer::getBounceColour(const Ray &r, uint bounces) const
+{
+	statsIncrement(Rays);
+	HitRecord rec;
+	if (scene.hit(r, math::minHitDistance(), math::maxReal(), rec))
+	{
+		Ray scattered;
+		Vec3 attenuation;
+		const Material *material = rec.hitable ? rec.hitable->getMaterial() : nullptr;
+		if (bounces < maxBounces && material && material->scatter(r, rec, attenuation, scattered))
+		{
+			statsIncrement(Bounces);
+			return getBounceColour(scattered, bounces + 1);
+		}
+	}
+	return Vec3(1, 1, 1) * (Real(bounces) / Real(maxBounces));
+}
+
+RaytraceVisualizer::RaytraceVisualizer(RaytraceVisualizerType type, const Scene &s, const Camera &cam, const Viewport &vp, Image &image)
+: Raytrace(s, cam, vp, image)
+, visualizerType(type)
+{}
+
+Vec3 RaytraceVisualizer::shadePixel(uint col, uint row) const
+{
+	Real u = Real(col) + 0.5;
+	Real v = Real(row) + 0.5;
+	u *= viewport.widthInv();
+	v *= viewport.heightInv();
+	bool useDepthOfField = false;
+	Ray r = camera.getRay(u, v, useDepthOfField);
+
+	Vec3 colour;
+	switch(visualizerType)
+	{
+		case RaytraceVisualizerTypeDepth:
+		{
+			statsIncrement(Rays);
+			HitRecord rec;
+			if (scene.hit(r, math::minHitDistance(), math::maxReal(), rec))
+				colour = Vec3(1, 1, 1) / (1.0 + rec.t);
+			break;
+		}
+		case RaytraceVisualizerTypeNormal:
+		{
+			statsIncrement(Rays);
+			HitRecord rec;
+			if (scene.hit(r, math::minHitDistance(), math::maxReal(), rec))
+				colour = rec.normal * 0.5 + 0.5;
+			break;
+		}
+		case RaytraceVisualizerTypeBounces:
+		{
+			colour = getBounceColour(r, 0);
+			colour = gammaCorrect(colour);
+			break;
+		}
+		default:
+			break;
+	}
+	return 255.99 * colour;
+}
@@ -0,0 +1,78 @@
+#include "Rect.hpp"
+
+Rect::Rect(const Transform &t, Real width, Real height, const Material &_material)
+{
+	transform = t;
+	halfWidth = width * 0.5;
+	halfHeight = height * 0.5;
+	material = &_material;
+}
+
+bool Rect::hit(const Ray &r, Real minDist, Real maxDist, HitRecord &rec) const
+{
+	Ray ray = transform.applyInverse(r);
+
+	// Distances in rect space are divided by the scale
+	Real t = -ray.origin().z / ray.direction().z;
+	Real hitDistance = t * transform.scale();
+	if (!(hitDistance > minDist && hitDistance < maxDist))
+		return false;
+
+	Real x = ray.origin().x + t * ray.direction().x;
+	if (x < -halfWidth || x > halfWidth)
+		return false;
+
+	Real y = ray.origin().y + t * ray.direction().y;
+	if (y < -halfHeight || y > halfHeight)
+		return false;
+
+	rec.t = hitDistance;
+	rec.point = r.to(rec.t);
+	rec.normal = transform.applyRotation(Vec3(0.0, 0.0, ray.direction().z > 0.0 ? -1.0 : 1.0));
+	// The whole rect maps to the unit square
+	rec.u = Real(0.5) + x / (2 * halfWidth);
+	rec.v = Real(0.5) + y / (2 * halfHeight);
+	rec.uvDensity = transform.inverseScale() / (2 * math::min(halfWidth, halfHeight));
+	rec.hitable = this;
+
+	return true;
+}
+
+Real Rect::evaluateSDF(const Vec3 &point) const
+{
+	Vec3 p = transform.applyInverse(point);
+	Vec3 a(-halfWidth, -halfHeight, 0.0);
+	Vec3 b( halfWidth, -halfHeight, 0.0);
+	Vec3 c( halfWidth,  halfHeight, 0.0);
+	Vec3 d(-halfWidth,  halfHeight, 0.0);
+	Vec3 ba = b - a; Vec3 pa = p - a;
+	Vec3 cb = c - b; Vec3 pb = p - b;
+	Vec3 dc = d - c; Vec3 pc = p - c;
+	Vec3 ad = a - d; Vec3 pd = p - d;
+	Vec3 nor = cross(ba, ad);
+
+	return sqrt(
+		(math::sign(dot(cross(ba, nor), pa)) +
+		math::sign(dot(cross(cb, nor), pb)) +
+		math::sign(dot(cross(dc, nor), pc)) +
+		math::sign(dot(cross(ad, nor), pd)) < 3.0)
+		?
+		math::min(math::min(math::min(
+		(ba * math::clamp(dot(ba, pa) / ba.squaredLength(), 0.0, 1.0) - pa).squaredLength(),
+		(cb * math::clamp(dot(cb, pb) / cb.squaredLength(), 0.0, 1.0) - pb).squaredLength()),
+		(dc * math::clamp(dot(dc, pc) / dc.squaredLength(), 0.0, 1.0) - pc).squaredLength()),
+		(ad * math::clamp(dot(ad, pd) / ad.squaredLength(), 0.0, 1.0) - pd).squaredLength())
+		:
+		dot(nor, pa) * dot(nor, pa) / nor.squaredLength());
+}
+
+Vec3 Rect::evaluateNormalFromSDF(const Vec3 &point, Real epsilon) const
+{
+	return transform.applyRotation(Vec3(0.0, 0.0, transform.applyInverse(point).z > 0.0 ? 1.0 : -1.0));
+}
+
+bool Rect::boundingBox(BoundingBox &box) const
+{
+	box = transform.apply(BoundingBox(Vec3(-halfWidth, -halfHeight, 0.0), Vec3(halfWidth, halfHeight, 0.0)));
+	return true;
+}
@@ -0,0 +1,286 @@
+#include "Renderer.hpp"
+#include "Trace.hpp"
+
+#include <algorithm>
+
+void Renderer::renderTile(const PixelRenderer &pixelRenderer, uint tileX, uint tileY, uint tileSize) const
+{
+	const Viewport &vp = pixelRenderer.getViewport();
+
+	uint tileOffsetX = tileX * tileSize;
+	uint tileOffsetY = tileY * tileSize;
+
+	uint stopX = math::min(tileOffsetX + tileSize, vp.width());
+	uint stopY = math::min(tileOffsetY + tileSize, vp.height());
+	statsAdd(Pixels, (stopX - tileOffsetX) * (stopY - tileOffsetY));
+
+	// Shaded into a buffer per thread, then committed in one go
+	static thread_local TileBuffer tile;
+	tile.reset(tileOffsetX, tileOffsetY, stopX - tileOffsetX, stopY - tileOffsetY, sampleImage || varianceImage);
+	tile.shade(pixelRenderer);
+	if (tileSink)
+		tileSink->writeTile(tile.getX(), tile.getY(), tile.getWidth(), tile.getHeight(), tile.getColours());
+
+	std::unique_lock<std::mutex> lock;
+	if (frameShared)
+		lock = std::unique_lock<std::mutex>(frameMutex);
+	tile.commit(tileSink ? nullptr : pixelRenderer.getImage(), sampleImage, varianceImage);
+}
+
+void Renderer::renderTiles(const PixelRenderer &pixelRenderer, uint threadIndex)
+{
+	const Viewport &vp = pixelRenderer.getViewport();
+	uint tilesX = (vp.width() + tileSize - 1) / tileSize;
+	uint tilesY = (vp.height() + tileSize - 1) / tileSize;
+	uint tileAmount = tilesX * tilesY;
+	uint tileIndex = 0;
+	while (true)
+	{
+		tileIndex = renderCounter++;
+		if (tileIndex >= tileAmount)
+			break;
+
+		uint tileY = tileIndex / tilesX;
+		uint tileX = tileIndex % tilesX;
+		indexToGrid(tileX, tileY, tileIndex);
+
+#ifdef RAYTRACER_STATS
+		const bool timeTile = true;
+#else
+		const bool timeTile = tileCostsEnabled;
+#endif
+		std::chrono::steady_clock::time_point tileStart;
+		if (timeTile)
+			tileStart = std::chrono::steady_clock::now();
+
+		{
+			trace::Scope scope("tile", "render", "x", tileX, "y", tileY);
+			renderTile(pixelRenderer, tileX, tileY, tileSize);
+		}
+
+		if (timeTile)
+		{
+			uint64_t tileNanoseconds = std::chrono::duration_cast<std::chrono::nanoseconds>(std::chrono::steady_clock::now() - tileStart).count();
+#ifdef RAYTRACER_STATS
+			stats::Counters &counters = stats::threadCounters();
+			if (tileCostsEnabled)
+				tileCosts.record(tileX, tileY, tileNanoseconds, counters.values[stats::Rays]);
+			counters.values[stats::Tiles]++;
+			counters.values[stats::TileNanoseconds] += tileNanoseconds;
+			counters.maxTileNanoseconds = std::max(counters.maxTileNanoseconds, tileNanoseconds);
+			// Before taking the next tile, so that all counts are collected when the last thread finishes.
+			// This also restarts the counts of the thread for its next tile.
+			renderStats.collect(threadIndex);
+#else
+			(void)threadIndex;
+			tileCosts.record(tileX, tileY, tileNanoseconds, 0);
+#endif
+		}
+	}
+
+	if (tileIndex - tileAmount == nThreads - 1)
+		finish();
+}
+
+void Renderer::renderPixels(const PixelRenderer &pixelRenderer, uint threadIndex)
+{
+	const Viewport &vp = pixelRenderer.getViewport();
+	uint pixelAmount = vp.width() * vp.height();
+	// Taken a batch at a time, so that the counts are collected once per batch
+	uint batchAmount = (pixelAmount + pixelBatchSize - 1) / pixelBatchSize;
+	uint batchIndex = 0;
+	while (true)
+	{
+		batchIndex = renderCounter++;
+		if (batchIndex >= batchAmount)
+			break;
+
+		uint stopIndex = math::min((batchIndex + 1) * pixelBatchSize, pixelAmount);
+		for (uint pixelIndex = batchIndex * pixelBatchSize; pixelIndex < stopIndex; pixelIndex++)
+		{
+			uint row = pixelIndex / vp.width();
+			uint col = pixelIndex % vp.width();
+			indexToGrid(col, row, pixelIndex);
+
+			pixelRenderer.renderPixel(col, row);
+		}
+		statsAdd(Pixels, stopIndex - batchIndex * pixelBatchSize);
+#ifdef RAYTRACER_STATS
+		// Before taking the next batch, like tiles
+		renderStats.collect(threadIndex);
+#else
+		(void)threadIndex;
+#endif
+	}
+
+	if (batchIndex - batchAmount == nThreads - 1)
+		finish();
+}
+
+void Renderer::renderInternal(const PixelRenderer &pixelRenderer, uint threadIndex)
+{
+	trace::Scope scope("render thread", "render", "thread", threadIndex);
+#ifdef RAYTRACER_STATS
+	// Leave out whatever this thread counted before rendering
+	stats::threadCounters().reset();
+#endif
+	(this->*renderFunction)(pixelRenderer, threadIndex);
+}
+
+void Renderer::indexToGrid(uint &gridX, uint &gridY, const uint index) const
+{
+	uint gridXY = indexToGridMap[index];
+	gridX = gridXY & 0xffff;
+	gridY = (gridXY >> 16) & 0xffff;
+}
+
+void Renderer::makeGrid(uint width, uint height)
+{
+	uint gridSize = width * height;
+	indexToGridMap = new uint[gridSize];
+	uint mapIndex = 0;
+#if 0
+	// Border to border grid
+	for (uint y = 0; y < height; y++)
+	{
+		for (uint x = 0; x < width; x++)
+		{
+			// Left to right, bottom to top
+			// uint gridXY = ((y & 0xffff) << 16) | (x & 0xffff);
+			// Left to right, top to bottom
+			uint gridXY = (((height - 1 - y) & 0xffff) << 16) | (x & 0xffff);
+			indexToGridMap[mapIndex++] = gridXY;
+		}
+	}
+#else
+	// Center spiral grid, starting left, then up
+	const int leftBound = -int(width) / 2;
+	const int rightBound = int(width + 1) / 2;
+	const int topBound = int(height) / 2;
+	const int bottomBound = -int(height - 1) / 2;
+	int x = 0;
+	int y = 0;
+	int dx = 0;
+	int dy = -1;
+	int temp = 0;
+	uint maxSize = math::max(width, height);
+	maxSize *= maxSize;
+	for (uint i = 0; i < maxSize; i++)
+	{
+		// Within bounds
+		if (x >= leftBound && x < rightBound && y >= bottomBound && y <= topBound)
+		{
+			uint gridXY = (((y - bottomBound) & 0xffff) << 16) | ((x - leftBound) & 0xffff);
+			indexToGridMap[mapIndex++] = gridXY;
+		}
+		// Turn
+		if (x == -y || (x > 0 && x == y) || (x < 0 && x + 1 == y))
+		{
+			temp = dy;
+			dy = -dx;
+			dx = temp;
+		}
+		// Move
+		x += dx;
+		y += dy;
+	}
+#endif
+}
+
+void Renderer::init(const PixelRenderer &pixelRenderer, RenderFunctionType type)
+{
+	const Viewport &vp = pixelRenderer.getViewport();
+
+	switch (type)
+	{
+		case RenderFunctionPixels:
+		{
+			renderFunction = &Renderer::renderPixels;
+
+			uint width = vp.width();
+			uint height = vp.height();
+			makeGrid(width, height);
+
+			break;
+		}
+		case RenderFunctionTiles:
+		default:
+		{
+			renderFunction = &Renderer::renderTiles;
+
+			uint width = (vp.width() + tileSize - 1) / tileSize;
+			uint height = (vp.height() + tileSize - 1) / tileSize;
+			makeGrid(width, height);
+
+			if (tileCostsEnabled)
+				tileCosts.reset(vp.width(), vp.height(), tileSize);
+
+			break;
+		}
+	}
+
+	renderCounter = 0;
+	renderStats.begin(nThreads);
+	renderStart = std::chrono::steady_clock::now();
+}
+
+void Renderer::finish()
+{
+	renderStats.end(std::chrono::duration<double>(std::chrono::steady_clock::now() - renderStart).count());
+
+	if (finishCallback)
+	{
+		trace::Scope scope("finish callback", "render");
+		(*finishCallback)();
+	}
+	finishCallback = nullptr;
+
+	delete[] indexToGridMap;
+	indexToGridMap = nullptr;
+}
+
+Renderer::Renderer()
+{
+	setThreadCount(0);
+}
+
+void Renderer::setThreadCount(uint n)
+{
+	// Threads from a previous asynchronous render must be done before the count changes
+	waitForFinish();
+	nThreads = n > 0 ? n : math::max(std::thread::hardware_concurrency(), 1u);
+	futures.reserve(nThreads);
+}
+
+Renderer::~Renderer()
+{
+	waitForFinish();
+}
+
+void Renderer::render(const PixelRenderer &pixelRenderer, RenderFunctionType type)
+{
+	init(pixelRenderer, type);
+
+	for (uint i = 0; i < nThreads - 1; i++)
+		futures.push_back(std::async(std::launch::async, &Renderer::renderInternal, this, std::ref(pixelRenderer), i + 1));
+
+	renderInternal(pixelRenderer, 0);
+
+	waitForFinish();
+}
+
+void Renderer::renderAsync(const PixelRenderer &pixelRenderer, RenderFunctionType type)
+{
+	init(pixelRenderer, type);
+
+	for (uint i = 0; i < nThreads; i++)
+		futures.push_back(std::async(std::launch::async, &Renderer::renderInternal, this, std::ref(pixelRenderer), i));
+}
+
+void Renderer::waitForFinish()
+{
+	for (uint i = 0; i < futures.size(); i++)
+		futures[i].get();
+
+	futures.clear();
+}
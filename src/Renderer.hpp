@@ -4,10 +4,16 @@
 
 #include "Math.hpp"
 #include "PixelRenderer.hpp"
+#include "Stats.hpp"
+#include "TileBuffer.hpp"
+#include "TileCosts.hpp"
+#include "TileSink.hpp"
 #include "Viewport.hpp"
 
 #include <atomic>
+#include <chrono>
 #include <future>
+#include <mutex>
 #include <vector>
 
 enum RenderFunctionType
@@ -27,18 +33,28 @@ class Renderer
 {
 private:
 	const uint tileSize = 64;
+	const uint pixelBatchSize = 64;
 	uint nThreads = 1;
 	std::vector<std::future<void>> futures;
 	std::atomic<uint> renderCounter {0};
-	void (Renderer::*renderFunction)(const PixelRenderer &pixelRenderer);
+	void (Renderer::*renderFunction)(const PixelRenderer &pixelRenderer, uint threadIndex);
 	FinishCallbackFunctor *finishCallback = nullptr;
 	uint *indexToGridMap = nullptr;
+	stats::RenderStats renderStats;
+	TileCosts tileCosts;
+	bool tileCostsEnabled = false;
+	TileSink *tileSink = nullptr;
+	Image *sampleImage = nullptr;
+	Image *varianceImage = nullptr;
+	mutable std::mutex frameMutex;
+	bool frameShared = false;
+	std::chrono::steady_clock::time_point renderStart;
 
 	void renderTile(const PixelRenderer &pixelRenderer, uint tileX, uint tileY, uint tileSize) const;
-	void renderTiles(const PixelRenderer &pixelRenderer);
-	void renderPixels(const PixelRenderer &pixelRenderer);
+	void renderTiles(const PixelRenderer &pixelRenderer, uint threadIndex);
+	void renderPixels(const PixelRenderer &pixelRenderer, uint threadIndex);
 	// The async call can only take a constant pointer to member function, so this serves as a wrapper
-	void renderInternal(const PixelRenderer &pixelRenderer) { (this->*renderFunction)(pixelRenderer); }
+	void renderInternal(const PixelRenderer &pixelRenderer, uint threadIndex);
 	void indexToGrid(uint &gridX, uint &gridY, const uint index) const;
 	void makeGrid(uint width, uint height);
 	void init(const PixelRenderer &pixelRenderer, RenderFunctionType type);
@@ -52,209 +68,24 @@ public:
 	void renderAsync(const PixelRenderer &pixelRenderer, RenderFunctionType type = RenderFunctionTiles);
 	void waitForFinish();
 	void setFinishCallback(FinishCallbackFunctor &callback) { finishCallback = &callback; }
+	// Number of rendering threads, all hardware threads when 0. Takes effect on the next render.
+	void setThreadCount(uint n);
+	uint getThreadCount() const { return nThreads; }
+	// Statistics of the last render, complete once it has finished. Only counted with RAYTRACER_STATS.
+	const stats::RenderStats &getStats() const { return renderStats; }
+	// Record the time and rays spent on each tile of the next tiled renders, rays are only counted with RAYTRACER_STATS
+	void setTileCostsEnabled(bool enabled) { tileCostsEnabled = enabled; }
+	// Costs of the last tiled render, complete once it has finished
+	const TileCosts &getTileCosts() const { return tileCosts; }
+	// Tiled renders hand each finished tile to the sink instead of storing it in the image of the pixel renderer,
+	// which is then left untouched. Null to store pixels in the image again.
+	void setTileSink(TileSink *sink) { tileSink = sink; }
+	uint getTileSize() const { return tileSize; }
+	// Tiled renders also keep the sample count (r32ui image) and variance (r32f image) of every pixel, for
+	// integrators which report them. Null images are not written.
+	void setPixelStateImages(Image *samples, Image *variances) { sampleImage = samples; varianceImage = variances; }
+	// Whether the frame is read while rendering. Set before rendering; finished tiles are then committed holding
+	// the frame mutex, and readers holding it only see whole tiles. Headless renders commit without locking.
+	void setFrameShared(bool shared) { frameShared = shared; }
+	std::mutex &getFrameMutex() const { return frameMutex; }
 };
-
-void Renderer::renderTile(const PixelRenderer &pixelRenderer, uint tileX, uint tileY, uint tileSize) const
-{
-	const Viewport &vp = pixelRenderer.getViewport();
-
-	uint tileOffsetX = tileX * tileSize;
-	uint tileOffsetY = tileY * tileSize;
-
-	uint stopX = math::min(tileOffsetX + tileSize, vp.width());
-	uint stopY = math::min(tileOffsetY + tileSize, vp.height());
-	for (uint row = tileOffsetY; row < stopY; row++)
-	{
-		for (uint col = tileOffsetX; col < stopX; col++)
-		{
-			pixelRenderer.renderPixel(col, row);
-		}
-	}
-}
-
-void Renderer::renderTiles(const PixelRenderer &pixelRenderer)
-{
-	const Viewport &vp = pixelRenderer.getViewport();
-	uint tilesX = (vp.width() + tileSize - 1) / tileSize;
-	uint tilesY = (vp.height() + tileSize - 1) / tileSize;
-	uint tileAmount = tilesX * tilesY;
-	uint tileIndex = 0;
-	while (true)
-	{
-		tileIndex = renderCounter++;
-		if (tileIndex >= tileAmount)
-			break;
-
-		uint tileY = tileIndex / tilesX;
-		uint tileX = tileIndex % tilesX;
-		indexToGrid(tileX, tileY, tileIndex);
-
-		renderTile(pixelRenderer, tileX, tileY, tileSize);
-	}
-
-	if (tileIndex - tileAmount == nThreads - 1)
-		finish();
-}
-
-void Renderer::renderPixels(const PixelRenderer &pixelRenderer)
-{
-	const Viewport &vp = pixelRenderer.getViewport();
-	uint pixelAmount = vp.width() * vp.height();
-	uint pixelIndex = 0;
-	while (true)
-	{
-		pixelIndex = renderCounter++;
-		if (pixelIndex >= pixelAmount)
-			break;
-
-		uint row = pixelIndex / vp.width();
-		uint col = pixelIndex % vp.width();
-		indexToGrid(col, row, pixelIndex);
-
-		pixelRenderer.renderPixel(col, row);
-	}
-
-	if (pixelIndex - pixelAmount == nThreads - 1)
-		finish();
-}
-
-void Renderer::indexToGrid(uint &gridX, uint &gridY, const uint index) const
-{
-	uint gridXY = indexToGridMap[index];
-	gridX = gridXY & 0xffff;
-	gridY = (gridXY >> 16) & 0xffff;
-}
-
-void Renderer::makeGrid(uint width, uint height)
-{
-	uint gridSize = width * height;
-	indexToGridMap = new uint[gridSize];
-	uint mapIndex = 0;
-#if 0
-	// Border to border grid
-	for (uint y = 0; y < height; y++)
-	{
-		for (uint x = 0; x < width; x++)
-		{
-			// Left to right, bottom to top
-			// uint gridXY = ((y & 0xffff) << 16) | (x & 0xffff);
-			// Left to right, top to bottom
-			uint gridXY = (((height - 1 - y) & 0xffff) << 16) | (x & 0xffff);
-			indexToGridMap[mapIndex++] = gridXY;
-		}
-	}
-#else
-	// Center spiral grid, starting left, then up
-	const int leftBound = -int(width) / 2;
-	const int rightBound = int(width + 1) / 2;
-	const int topBound = int(height) / 2;
-	const int bottomBound = -int(height - 1) / 2;
-	int x = 0;
-	int y = 0;
-	int dx = 0;
-	int dy = -1;
-	int temp = 0;
-	uint maxSize = math::max(width, height);
-	maxSize *= maxSize;
-	for (uint i = 0; i < maxSize; i++)
-	{
-		// Within bounds
-		if (x >= leftBound && x < rightBound && y >= bottomBound && y <= topBound)
-		{
-			uint gridXY = (((y - bottomBound) & 0xffff) << 16) | ((x - leftBound) & 0xffff);
-			indexToGridMap[mapIndex++] = gridXY;
-		}
-		// Turn
-		if (x == -y || (x > 0 && x == y) || (x < 0 && x + 1 == y))
-		{
-			temp = dy;
-			dy = -dx;
-			dx = temp;
-		}
-		// Move
-		x += dx;
-		y += dy;
-	}
-#endif
-}
-
-void Renderer::init(const PixelRenderer &pixelRenderer, RenderFunctionType type)
-{
-	const Viewport &vp = pixelRenderer.getViewport();
-
-	switch (type)
-	{
-		case RenderFunctionPixels:
-		{
-			renderFunction = &Renderer::renderPixels;
-
-			uint width = vp.width();
-			uint height = vp.height();
-			makeGrid(width, height);
-
-			break;
-		}
-		case RenderFunctionTiles:
-		default:
-		{
-			renderFunction = &Renderer::renderTiles;
-
-			uint width = (vp.width() + tileSize - 1) / tileSize;
-			uint height = (vp.height() + tileSize - 1) / tileSize;
-			makeGrid(width, height);
-
-			break;
-		}
-	}
-
-	renderCounter = 0;
-}
-
-void Renderer::finish()
-{
-	if (finishCallback)
-		(*finishCallback)();
-	finishCallback = nullptr;
-
-	delete[] indexToGridMap;
-	indexToGridMap = nullptr;
-}
-
-Renderer::Renderer()
-{
-	nThreads = math::max(std::thread::hardware_concurrency(), 1u);
-	futures.reserve(nThreads);
-}
-
-Renderer::~Renderer()
-{
-	waitForFinish();
-}
-
-void Renderer::render(const PixelRenderer &pixelRenderer, RenderFunctionType type)
-{
-	init(pixelRenderer, type);
-
-	for (uint i = 0; i < nThreads - 1; i++)
-		futures.push_back(std::async(std::launch::async, &Renderer::renderInternal, this, std::ref(pixelRenderer)));
-
-	renderInternal(pixelRenderer);
-
-	waitForFinish();
-}
-
-void Renderer::renderAsync(const PixelRenderer &pixelRenderer, RenderFunctionType type)
-{
-	init(pixelRenderer, type);
-
-	for (uint i = 0; i < nThreads; i++)
-		futures.push_back(std::async(std::launch::async, &Renderer::renderInternal, this, std::ref(pixelRenderer)));
-}
-
-void Renderer::waitForFinish()
-{
-	for (uint i = 0; i < futures.size(); i++)
-		futures[i].get();
-
-	futures.clear();
-}
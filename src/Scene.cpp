@@ -0,0 +1,116 @@
+#include "Scene.hpp"
+#include "Trace.hpp"
+
+void Scene::build()
+{
+	trace::Scope scope("scene build", "scene", "hitables", int64_t(hitables.size()));
+	boundedHitables.clear();
+	unboundedHitables.clear();
+
+	std::vector<BoundingBox> bounds;
+	bounds.reserve(hitables.size());
+	for (const Hitable *hitable : hitables)
+	{
+		BoundingBox box;
+		if (hitable->boundingBox(box))
+		{
+			boundedHitables.push_back(hitable);
+			bounds.push_back(box);
+		}
+		else
+		{
+			unboundedHitables.push_back(hitable);
+		}
+	}
+
+	bvh.build(bounds);
+	built = true;
+}
+
+void Scene::build(const BvhNode *nodes, uint nodeAmount, const uint *references, uint referenceAmount)
+{
+	boundedHitables = hitables;
+	unboundedHitables.clear();
+	bvh.clear();
+	bvh.setData(nodes, nodeAmount, references, referenceAmount);
+	built = true;
+}
+
+void Scene::clear()
+{
+	hitables.clear();
+	boundedHitables.clear();
+	unboundedHitables.clear();
+	bvh.clear();
+	built = false;
+}
+
+bool Scene::hit(const Ray &r, Real minDist, Real maxDist, HitRecord &rec) const
+{
+	const std::vector<const Hitable *> &linearHitables = built ? unboundedHitables : hitables;
+	statsAdd(IntersectionTests, linearHitables.size());
+
+	bool hit = false;
+	Real closestHit = maxDist;
+	for (const Hitable *hitable : linearHitables)
+	{
+		HitRecord tmpRec;
+		if (hitable->hit(r, minDist, closestHit, tmpRec))
+		{
+			hit = true;
+			closestHit = tmpRec.t;
+			rec = tmpRec;
+		}
+	}
+
+	if (built)
+	{
+		RayIntersector intersector(boundedHitables);
+		if (bvh.intersect(r, minDist, closestHit, intersector))
+		{
+			hit = true;
+			rec = intersector.rec;
+		}
+	}
+
+	return hit;
+}
+
+bool Scene::hitWithSDF(const Vec3 &point, Real epsilon, HitRecord &rec) const
+{
+	for (const Hitable *hitable : hitables)
+	{
+		HitRecord tmpRec;
+		if (hitable->hitWithSDF(point, epsilon, tmpRec))
+		{
+			rec = tmpRec;
+			return true;
+		}
+		else if (math::abs(tmpRec.t) < math::abs(rec.t))
+		{
+			rec.t = tmpRec.t;
+		}
+	}
+	return false;
+}
+
+Real Scene::evaluateSDF(const Vec3 &point) const
+{
+	Real minDist = math::maxReal();
+	for (const Hitable *hitable : hitables)
+		minDist = math::min(minDist, hitable->evaluateSDF(point));
+	return minDist;
+}
+
+bool Scene::boundingBox(BoundingBox &box) const
+{
+	box = BoundingBox();
+	for (const Hitable *hitable : hitables)
+	{
+		BoundingBox hitableBox;
+		if (!hitable->boundingBox(hitableBox))
+			return false;
+		box.extend(hitableBox);
+	}
+	return !box.isEmpty();
+}
@@ -3,7 +3,10 @@
 #include "Common.hpp"
 
 #include "Background.hpp"
+#include "BoundingBox.hpp"
+#include "Bvh.hpp"
 #include "Hitable.hpp"
+#include "Stats.hpp"
 
 #include <vector>
 
@@ -13,6 +16,14 @@ private:
 	Background bg;
 	std::vector<const Hitable *> hitables;
 
+	// Acceleration structure over the bounded hitables, the others are tested one by one
+	Bvh bvh;
+	std::vector<const Hitable *> boundedHitables;
+	std::vector<const Hitable *> unboundedHitables;
+	bool built = false;
+
+	class RayIntersector;
+
 public:
 	Scene() {}
 	Scene(uint size) { hitables.reserve(size); }
@@ -21,51 +32,42 @@ public:
 	virtual bool hit(const Ray &r, Real minDist, Real maxDist, HitRecord &rec) const override;
 	virtual bool hitWithSDF(const Vec3 &point, Real epsilon, HitRecord &rec) const override;
 	virtual Real evaluateSDF(const Vec3 &point) const override;
+	virtual bool boundingBox(BoundingBox &box) const override;
 
 	void setBackground(const Background &_background) { bg = _background; }
 	const Background &background() const { return bg; }
-	void add(const Hitable &hitable) { hitables.push_back(&hitable); }
+	void add(const Hitable &hitable) { hitables.push_back(&hitable); built = false; }
+	// Build the acceleration structure, to be called once all hitables are added and before rendering.
+	// Until then, and after any new addition, hits are tested linearly.
+	void build();
+	// Use a prebuilt hierarchy over all the hitables, referenced in the order they were added.
+	// The data is not copied and must outlive the scene.
+	void build(const BvhNode *nodes, uint nodeAmount, const uint *references, uint referenceAmount);
+	// Remove all hitables, keeping the background
+	void clear();
+	uint size() const { return uint(hitables.size()); }
 };
 
-bool Scene::hit(const Ray &r, Real minDist, Real maxDist, HitRecord &rec) const
+class Scene::RayIntersector
 {
-	bool hit = false;
-	Real closestHit = maxDist;
-	for (const Hitable *hitable : hitables)
-	{
-		HitRecord tmpRec;
-		if (hitable->hit(r, minDist, closestHit, tmpRec))
-		{
-			hit = true;
-			closestHit = tmpRec.t;
-			rec = tmpRec;
-		}
-	}
-	return hit;
-}
+private:
+	const std::vector<const Hitable *> &hitables;
 
-bool Scene::hitWithSDF(const Vec3 &point, Real epsilon, HitRecord &rec) const
-{
-	for (const Hitable *hitable : hitables)
+public:
+	HitRecord rec;
+
+	RayIntersector(const std::vector<const Hitable *> &_hitables) : hitables(_hitables) {}
+
+	bool operator()(uint primitive, const Ray &r, Real minDist, Real &maxDist)
 	{
+		statsIncrement(IntersectionTests);
 		HitRecord tmpRec;
-		if (hitable->hitWithSDF(point, epsilon, tmpRec))
+		if (hitables[primitive]->hit(r, minDist, maxDist, tmpRec))
 		{
+			maxDist = tmpRec.t;
 			rec = tmpRec;
 			return true;
 		}
-		else if (math::abs(tmpRec.t) < math::abs(rec.t))
-		{
-			rec.t = tmpRec.t;
-		}
+		return false;
 	}
-	return false;
-}
-
-Real Scene::evaluateSDF(const Vec3 &point) const
-{
-	Real minDist = math::maxReal();
-	for (const Hitable *hitable : hitables)
-		minDist = math::min(minDist, hitable->evaluateSDF(point));
-	return minDist;
-}
+};
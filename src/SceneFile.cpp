@@ -0,0 +1,469 @@
+#include "SceneFile.hpp"
+#include "Trace.hpp"
+
+#include <cstring>
+#include <fstream>
+#include <iostream>
+
+SceneFileWriter::SceneFileWriter()
+{
+	// Same as the default Background
+	background.bottom = Vec3(1, 0, 0);
+	background.top = Vec3(0, 0, 1);
+}
+
+uint SceneFileWriter::addConstantTexture(const Vec3 &albedo)
+{
+	scenefile::TextureRecord record = {};
+	record.type = scenefile::TextureTypeConstant;
+	record.albedo = albedo;
+	textures.push_back(record);
+	return uint(textures.size() - 1);
+}
+
+uint SceneFileWriter::addCheckerTexture(uint texture1, uint texture2, const Vec3 &frequency)
+{
+	scenefile::TextureRecord record = {};
+	record.type = scenefile::TextureTypeChecker;
+	record.texture1 = texture1;
+	record.texture2 = texture2;
+	record.frequency = frequency;
+	textures.push_back(record);
+	return uint(textures.size() - 1);
+}
+
+uint SceneFileWriter::addLambertian(uint texture)
+{
+	scenefile::MaterialRecord record = {};
+	record.type = scenefile::MaterialTypeLambertian;
+	record.texture = texture;
+	materials.push_back(record);
+	return uint(materials.size() - 1);
+}
+
+uint SceneFileWriter::addMetal(const Vec3 &albedo, Real roughness)
+{
+	scenefile::MaterialRecord record = {};
+	record.type = scenefile::MaterialTypeMetal;
+	record.albedo = albedo;
+	record.parameter = roughness;
+	materials.push_back(record);
+	return uint(materials.size() - 1);
+}
+
+uint SceneFileWriter::addDielectric(const Vec3 &albedo, Real refractiveIndex)
+{
+	scenefile::MaterialRecord record = {};
+	record.type = scenefile::MaterialTypeDielectric;
+	record.albedo = albedo;
+	record.parameter = refractiveIndex;
+	materials.push_back(record);
+	return uint(materials.size() - 1);
+}
+
+uint SceneFileWriter::addDiffuseLight(const Vec3 &albedo)
+{
+	scenefile::MaterialRecord record = {};
+	record.type = scenefile::MaterialTypeDiffuseLight;
+	record.albedo = albedo;
+	materials.push_back(record);
+	return uint(materials.size() - 1);
+}
+
+uint SceneFileWriter::addMesh(std::vector<Vec3> positions, std::vector<uint> indices, std::vector<Vec3> normals, std::vector<Real> uvs)
+{
+	Mesh mesh;
+	mesh.positions = std::move(positions);
+	mesh.indices = std::move(indices);
+	if (normals.size() == mesh.positions.size())
+		mesh.normals = std::move(normals);
+	if (uvs.size() == mesh.positions.size() * 2)
+		mesh.uvs = std::move(uvs);
+
+	uint triangleAmount = uint(mesh.indices.size() / 3);
+	mesh.indices.resize(triangleAmount * 3);
+	std::vector<BoundingBox> triangleBounds(triangleAmount);
+	for (uint i = 0; i < triangleAmount; i++)
+	{
+		for (uint v = 0; v < 3; v++)
+			triangleBounds[i].extend(mesh.positions[mesh.indices[i * 3 + v]]);
+	}
+	Bvh bvh;
+	bvh.build(triangleBounds);
+	mesh.bvhNodes.assign(bvh.getNodes(), bvh.getNodes() + bvh.getNodeAmount());
+	mesh.bvhReferences.assign(bvh.getReferences(), bvh.getReferences() + bvh.getReferenceAmount());
+
+	meshes.push_back(std::move(mesh));
+	return uint(meshes.size() - 1);
+}
+
+void SceneFileWriter::addShape(uint type, const Transform &t, const Vec3 &size, uint material, uint mesh)
+{
+	scenefile::ShapeRecord record = {};
+	record.type = type;
+	record.material = material;
+	record.mesh = mesh;
+	record.rotation = t.rotation();
+	record.translation = t.translation();
+	record.scale = t.scale();
+	record.size = size;
+	shapes.push_back(record);
+}
+
+void SceneFileWriter::addSphere(const Vec3 &center, Real radius, uint material)
+{
+	addShape(scenefile::ShapeTypeSphere, Transform(Quat(), center, 1), Vec3(radius, radius, radius), material, 0);
+}
+
+void SceneFileWriter::addBox(const Transform &t, const Vec3 &extents, uint material)
+{
+	addShape(scenefile::ShapeTypeBox, t, extents, material, 0);
+}
+
+void SceneFileWriter::addRect(const Transform &t, Real width, Real height, uint material)
+{
+	addShape(scenefile::ShapeTypeRect, t, Vec3(width, height, 0), material, 0);
+}
+
+void SceneFileWriter::addMeshShape(uint mesh, const Transform &t, uint material)
+{
+	addShape(scenefile::ShapeTypeMesh, t, Vec3(), material, mesh);
+}
+
+void SceneFileWriter::setBackground(const Vec3 &bottom, const Vec3 &top)
+{
+	background.bottom = bottom;
+	background.top = top;
+}
+
+BoundingBox SceneFileWriter::shapeBounds(const scenefile::ShapeRecord &shape) const
+{
+	Transform t(shape.rotation, shape.translation, shape.scale);
+	switch (shape.type)
+	{
+		case scenefile::ShapeTypeSphere:
+		{
+			Vec3 radius(shape.size.x, shape.size.x, shape.size.x);
+			return BoundingBox(shape.translation - radius, shape.translation + radius);
+		}
+		case scenefile::ShapeTypeBox:
+		{
+			return t.apply(BoundingBox(shape.size * -0.5, shape.size * 0.5));
+		}
+		case scenefile::ShapeTypeRect:
+		{
+			Vec3 halfSize(shape.size.x * 0.5, shape.size.y * 0.5, 0.0);
+			return t.apply(BoundingBox(-halfSize, halfSize));
+		}
+		case scenefile::ShapeTypeMesh:
+		default:
+		{
+			const Mesh &mesh = meshes[shape.mesh];
+			return t.apply(mesh.bvhNodes.empty() ? BoundingBox() : mesh.bvhNodes[0].bounds);
+		}
+	}
+}
+
+bool SceneFileWriter::write(const std::string &fileName) const
+{
+	for (const scenefile::ShapeRecord &shape : shapes)
+	{
+		if (shape.material >= materials.size() || (shape.type == scenefile::ShapeTypeMesh && shape.mesh >= meshes.size()))
+		{
+			std::cerr << "Invalid shape reference, could not write " << fileName << "." << std::endl;
+			return false;
+		}
+	}
+
+	// Top level hierarchy over all shapes, in order
+	std::vector<BoundingBox> bounds;
+	bounds.reserve(shapes.size());
+	for (const scenefile::ShapeRecord &shape : shapes)
+		bounds.push_back(shapeBounds(shape));
+	Bvh sceneBvh;
+	sceneBvh.build(bounds);
+
+	std::vector<byte> buffer;
+	auto alignBuffer = [&buffer]()
+	{
+		buffer.resize((buffer.size() + scenefile::alignment - 1) / scenefile::alignment * scenefile::alignment, 0);
+	};
+	auto append = [&](const void *src, size_t size) -> uint64_t
+	{
+		alignBuffer();
+		uint64_t offset = buffer.size();
+		buffer.resize(buffer.size() + size);
+		if (size)
+			std::memcpy(&buffer[offset], src, size);
+		return offset;
+	};
+
+	std::vector<scenefile::Chunk> chunks;
+	const uint chunkAmount = 8;
+	buffer.resize(sizeof(scenefile::Header) + chunkAmount * sizeof(scenefile::Chunk), 0);
+	auto addChunk = [&](uint type, const void *src, uint count, size_t elementSize)
+	{
+		scenefile::Chunk chunk = {};
+		chunk.type = type;
+		chunk.count = count;
+		chunk.size = uint64_t(count) * elementSize;
+		chunk.offset = append(src, size_t(chunk.size));
+		chunks.push_back(chunk);
+	};
+
+	addChunk(scenefile::ChunkTypeTextures, textures.data(), uint(textures.size()), sizeof(scenefile::TextureRecord));
+	addChunk(scenefile::ChunkTypeMaterials, materials.data(), uint(materials.size()), sizeof(scenefile::MaterialRecord));
+	addChunk(scenefile::ChunkTypeShapes, shapes.data(), uint(shapes.size()), sizeof(scenefile::ShapeRecord));
+	addChunk(scenefile::ChunkTypeBackground, &background, 1, sizeof(scenefile::BackgroundRecord));
+	addChunk(scenefile::ChunkTypeSceneBvhNodes, sceneBvh.getNodes(), sceneBvh.getNodeAmount(), sizeof(BvhNode));
+	addChunk(scenefile::ChunkTypeSceneBvhReferences, sceneBvh.getReferences(), sceneBvh.getReferenceAmount(), sizeof(uint));
+
+	// Mesh buffers go in one blob, referenced by offset from the mesh records
+	alignBuffer();
+	uint64_t meshDataStart = buffer.size();
+	std::vector<scenefile::MeshRecord> meshRecords;
+	for (const Mesh &mesh : meshes)
+	{
+		scenefile::MeshRecord record = {};
+		record.vertexAmount = uint(mesh.positions.size());
+		record.triangleAmount = uint(mesh.indices.size() / 3);
+		record.bvhNodeAmount = uint(mesh.bvhNodes.size());
+		record.positions = append(mesh.positions.data(), mesh.positions.size() * sizeof(Vec3));
+		record.normals = mesh.normals.empty() ? 0 : append(mesh.normals.data(), mesh.normals.size() * sizeof(Vec3));
+		record.uvs = mesh.uvs.empty() ? 0 : append(mesh.uvs.data(), mesh.uvs.size() * sizeof(Real));
+		record.indices = append(mesh.indices.data(), mesh.indices.size() * sizeof(uint));
+		record.bvhNodes = append(mesh.bvhNodes.data(), mesh.bvhNodes.size() * sizeof(BvhNode));
+		record.bvhReferences = append(mesh.bvhReferences.data(), mesh.bvhReferences.size() * sizeof(uint));
+		meshRecords.push_back(record);
+	}
+	scenefile::Chunk meshDataChunk = {};
+	meshDataChunk.type = scenefile::ChunkTypeMeshData;
+	meshDataChunk.offset = meshDataStart;
+	meshDataChunk.size = buffer.size() - meshDataStart;
+	chunks.push_back(meshDataChunk);
+	addChunk(scenefile::ChunkTypeMeshes, meshRecords.data(), uint(meshRecords.size()), sizeof(scenefile::MeshRecord));
+	alignBuffer();
+
+	scenefile::Header header = {};
+	std::memcpy(header.magic, scenefile::magic, sizeof(header.magic));
+	header.version = scenefile::version;
+	header.byteOrderMark = scenefile::byteOrderMark;
+	header.realSize = sizeof(Real);
+	header.chunkAmount = uint(chunks.size());
+	header.fileSize = buffer.size();
+	std::memcpy(&buffer[0], &header, sizeof(header));
+	std::memcpy(&buffer[sizeof(header)], chunks.data(), chunks.size() * sizeof(scenefile::Chunk));
+
+	std::ofstream file(fileName, std::ios::binary);
+	if (!file.is_open())
+	{
+		std::cerr << "Could not open file " << fileName << " for writing." << std::endl;
+		return false;
+	}
+	file.write(reinterpret_cast<const char *>(buffer.data()), std::streamsize(buffer.size()));
+	return bool(file);
+}
+
+bool SceneFile::fail(const std::string &fileName, const char *reason)
+{
+	std::cerr << "Could not load scene file " << fileName << ": " << reason << "." << std::endl;
+	clear();
+	return false;
+}
+
+bool SceneFile::load(const std::string &fileName)
+{
+	trace::Scope scope("scene file load", "io");
+	clear();
+
+	if (!file.open(fileName))
+		return fail(fileName, "unreadable file");
+
+	if (file.getSize() < sizeof(scenefile::Header))
+		return fail(fileName, "truncated header");
+	const scenefile::Header *header = reinterpret_cast<const scenefile::Header *>(file.getData());
+	if (std::memcmp(header->magic, scenefile::magic, sizeof(header->magic)) != 0)
+		return fail(fileName, "not a scene file");
+	if (header->version != scenefile::version)
+		return fail(fileName, "unsupported version");
+	if (header->byteOrderMark != scenefile::byteOrderMark || header->realSize != sizeof(Real))
+		return fail(fileName, "written for a different platform or precision");
+	if (header->fileSize != file.getSize() || sizeof(scenefile::Header) + header->chunkAmount * sizeof(scenefile::Chunk) > file.getSize())
+		return fail(fileName, "truncated file");
+
+	uint textureAmount, materialAmount, shapeAmount, meshAmount, backgroundAmount, nodeAmount, referenceAmount;
+	const scenefile::TextureRecord *textureRecords = getChunk<scenefile::TextureRecord>(scenefile::ChunkTypeTextures, textureAmount);
+	const scenefile::MaterialRecord *materialRecords = getChunk<scenefile::MaterialRecord>(scenefile::ChunkTypeMaterials, materialAmount);
+	const scenefile::ShapeRecord *shapeRecords = getChunk<scenefile::ShapeRecord>(scenefile::ChunkTypeShapes, shapeAmount);
+	const scenefile::MeshRecord *meshRecords = getChunk<scenefile::MeshRecord>(scenefile::ChunkTypeMeshes, meshAmount);
+	const scenefile::BackgroundRecord *backgroundRecord = getChunk<scenefile::BackgroundRecord>(scenefile::ChunkTypeBackground, backgroundAmount);
+	const BvhNode *nodes = getChunk<BvhNode>(scenefile::ChunkTypeSceneBvhNodes, nodeAmount);
+	const uint *references = getChunk<uint>(scenefile::ChunkTypeSceneBvhReferences, referenceAmount);
+	if ((textureAmount && !textureRecords) || (materialAmount && !materialRecords) || (shapeAmount && !shapeRecords) ||
+		(meshAmount && !meshRecords) || (nodeAmount && !nodes) || (referenceAmount && !references) ||
+		referenceAmount != shapeAmount)
+	{
+		return fail(fileName, "malformed chunk table");
+	}
+	if (!Bvh::isValid(nodes, nodeAmount, references, referenceAmount, shapeAmount))
+		return fail(fileName, "invalid scene hierarchy");
+
+	textures.reserve(textureAmount);
+	for (uint i = 0; i < textureAmount; i++)
+	{
+		const scenefile::TextureRecord &record = textureRecords[i];
+		if (record.type == scenefile::TextureTypeChecker)
+		{
+			if (record.texture1 >= i || record.texture2 >= i)
+				return fail(fileName, "checker texture referencing an undefined texture");
+			textures.push_back(new CheckerTexture(*textures[record.texture1], *textures[record.texture2], record.frequency));
+		}
+		else if (record.type == scenefile::TextureTypeConstant)
+		{
+			textures.push_back(new ConstantTexture(record.albedo));
+		}
+		else
+		{
+			return fail(fileName, "unknown texture type");
+		}
+	}
+
+	materials.reserve(materialAmount);
+	for (uint i = 0; i < materialAmount; i++)
+	{
+		const scenefile::MaterialRecord &record = materialRecords[i];
+		switch (record.type)
+		{
+			case scenefile::MaterialTypeLambertian:
+			{
+				if (record.texture >= textureAmount)
+					return fail(fileName, "material referencing an undefined texture");
+				materials.push_back(new Lambertian(*textures[record.texture]));
+				break;
+			}
+			case scenefile::MaterialTypeMetal:
+			{
+				materials.push_back(new Metal(record.albedo, record.parameter));
+				break;
+			}
+			case scenefile::MaterialTypeDielectric:
+			{
+				materials.push_back(new Dielectric(record.albedo, record.parameter));
+				break;
+			}
+			case scenefile::MaterialTypeDiffuseLight:
+			{
+				materials.push_back(new DiffuseLight(record.albedo));
+				break;
+			}
+			default:
+			{
+				return fail(fileName, "unknown material type");
+			}
+		}
+	}
+
+	// Meshes are checked once, however many shapes use them
+	for (uint i = 0; i < meshAmount; i++)
+	{
+		const scenefile::MeshRecord &mesh = meshRecords[i];
+		const Vec3 *positions = getBuffer<Vec3>(mesh.positions, mesh.vertexAmount);
+		const uint *indices = getBuffer<uint>(mesh.indices, uint64_t(mesh.triangleAmount) * 3);
+		const BvhNode *meshNodes = getBuffer<BvhNode>(mesh.bvhNodes, mesh.bvhNodeAmount);
+		const uint *meshReferences = getBuffer<uint>(mesh.bvhReferences, mesh.triangleAmount);
+		if ((mesh.vertexAmount && !positions) || (mesh.triangleAmount && (!indices || !meshNodes || !meshReferences)))
+			return fail(fileName, "mesh buffers out of bounds");
+		for (uint64_t index = 0; index < uint64_t(mesh.triangleAmount) * 3; index++)
+		{
+			if (indices[index] >= mesh.vertexAmount)
+				return fail(fileName, "mesh index out of bounds");
+		}
+		if (mesh.triangleAmount && !Bvh::isValid(meshNodes, mesh.bvhNodeAmount, meshReferences, mesh.triangleAmount, mesh.triangleAmount))
+			return fail(fileName, "invalid mesh hierarchy");
+	}
+
+	// Count shapes of each kind so that spheres, boxes and rects are allocated once and never move
+	uint shapeCounts[4] = {};
+	for (uint i = 0; i < shapeAmount; i++)
+	{
+		const scenefile::ShapeRecord &record = shapeRecords[i];
+		if (record.type > scenefile::ShapeTypeMesh || record.material >= materialAmount ||
+			(record.type == scenefile::ShapeTypeMesh && record.mesh >= meshAmount))
+		{
+			return fail(fileName, "shape referencing undefined data");
+		}
+		shapeCounts[record.type]++;
+	}
+	spheres.reserve(shapeCounts[scenefile::ShapeTypeSphere]);
+	boxes.reserve(shapeCounts[scenefile::ShapeTypeBox]);
+	rects.reserve(shapeCounts[scenefile::ShapeTypeRect]);
+	meshes.reserve(shapeCounts[scenefile::ShapeTypeMesh]);
+
+	for (uint i = 0; i < shapeAmount; i++)
+	{
+		const scenefile::ShapeRecord &record = shapeRecords[i];
+		const Material &material = *materials[record.material];
+		Transform t(record.rotation, record.translation, record.scale);
+		switch (record.type)
+		{
+			case scenefile::ShapeTypeSphere:
+			{
+				spheres.emplace_back(record.translation, record.size.x, material);
+				scene.add(spheres.back());
+				break;
+			}
+			case scenefile::ShapeTypeBox:
+			{
+				boxes.emplace_back(t, record.size, material);
+				scene.add(boxes.back());
+				break;
+			}
+			case scenefile::ShapeTypeRect:
+			{
+				rects.emplace_back(t, record.size.x, record.size.y, material);
+				scene.add(rects.back());
+				break;
+			}
+			case scenefile::ShapeTypeMesh:
+			default:
+			{
+				// Buffers are used straight from the mapping, checked above
+				const scenefile::MeshRecord &mesh = meshRecords[record.mesh];
+				const Vec3 *positions = getBuffer<Vec3>(mesh.positions, mesh.vertexAmount);
+				const Vec3 *normals = getBuffer<Vec3>(mesh.normals, mesh.vertexAmount);
+				const Real *uvs = getBuffer<Real>(mesh.uvs, uint64_t(mesh.vertexAmount) * 2);
+				const uint *indices = getBuffer<uint>(mesh.indices, uint64_t(mesh.triangleAmount) * 3);
+				const BvhNode *meshNodes = getBuffer<BvhNode>(mesh.bvhNodes, mesh.bvhNodeAmount);
+				const uint *meshReferences = getBuffer<uint>(mesh.bvhReferences, mesh.triangleAmount);
+				meshes.push_back(new TriangleMesh(t, positions, normals, uvs, mesh.vertexAmount, indices, mesh.triangleAmount,
+					material, meshNodes, mesh.bvhNodeAmount, meshReferences));
+				scene.add(*meshes.back());
+				break;
+			}
+		}
+	}
+
+	if (backgroundRecord && backgroundAmount == 1)
+		scene.setBackground(Background(backgroundRecord->bottom, backgroundRecord->top));
+	scene.build(nodes, nodeAmount, references, referenceAmount);
+
+	return true;
+}
+
+void SceneFile::clear()
+{
+	scene.clear();
+	for (TriangleMesh *mesh : meshes)
+		delete mesh;
+	meshes.clear();
+	spheres.clear();
+	boxes.clear();
+	rects.clear();
+	for (Material *material : materials)
+		delete material;
+	materials.clear();
+	for (Texture *texture : textures)
+		delete texture;
+	textures.clear();
+	file.close();
+}
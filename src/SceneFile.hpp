@@ -0,0 +1,263 @@
+#pragma once
+
+#include "Common.hpp"
+
+#include "Background.hpp"
+#include "BoundingBox.hpp"
+#include "Box.hpp"
+#include "Bvh.hpp"
+#include "CheckerTexture.hpp"
+#include "ConstantTexture.hpp"
+#include "Dielectric.hpp"
+#include "DiffuseLight.hpp"
+#include "Lambertian.hpp"
+#include "MappedFile.hpp"
+#include "Material.hpp"
+#include "Metal.hpp"
+#include "Quat.hpp"
+#include "Rect.hpp"
+#include "Scene.hpp"
+#include "Sphere.hpp"
+#include "Texture.hpp"
+#include "Transform.hpp"
+#include "TriangleMesh.hpp"
+#include "Vec3.hpp"
+
+#include <cstdint>
+#include <string>
+#include <utility>
+#include <vector>
+
+// Binary scene files
+//
+// A scene file starts with a header and a table of chunks, each chunk being an array of plain records.
+// Records are stored in the native layout of the renderer, including the size of Real, so that a mapped
+// file is used in place: mesh buffers and bounding volume hierarchies are never parsed nor copied, only
+// textures, materials and shapes get instantiated. Indices and hierarchies are checked before use.
+namespace scenefile
+{
+
+const char magic[8] = { 'R', 'T', 'S', 'C', 'E', 'N', 'E', '\0' };
+const uint version = 1;
+const uint byteOrderMark = 0x01020304;
+const uint alignment = 16;
+
+enum ChunkType
+{
+	ChunkTypeTextures,
+	ChunkTypeMaterials,
+	ChunkTypeShapes,
+	ChunkTypeMeshes,
+	ChunkTypeBackground,
+	ChunkTypeSceneBvhNodes,
+	ChunkTypeSceneBvhReferences,
+	ChunkTypeMeshData
+};
+
+enum TextureType
+{
+	TextureTypeConstant,
+	TextureTypeChecker
+};
+
+enum MaterialType
+{
+	MaterialTypeLambertian,
+	MaterialTypeMetal,
+	MaterialTypeDielectric,
+	MaterialTypeDiffuseLight
+};
+
+enum ShapeType
+{
+	ShapeTypeSphere,
+	ShapeTypeBox,
+	ShapeTypeRect,
+	ShapeTypeMesh
+};
+
+struct Header
+{
+	char magic[8];
+	uint version;
+	uint byteOrderMark;
+	uint realSize;
+	uint chunkAmount;
+	uint64_t fileSize;
+};
+
+struct Chunk
+{
+	uint type;
+	uint count;
+	uint64_t offset;
+	uint64_t size;
+};
+
+struct TextureRecord
+{
+	uint type;
+	// Checker textures reference textures defined before them
+	uint texture1;
+	uint texture2;
+	Vec3 albedo;
+	Vec3 frequency;
+};
+
+struct MaterialRecord
+{
+	uint type;
+	// Lambertian materials only
+	uint texture;
+	// Roughness for metals, refractive index for dielectrics
+	Real parameter;
+	Vec3 albedo;
+};
+
+struct ShapeRecord
+{
+	uint type;
+	uint material;
+	// Mesh shapes only, several shapes can share a mesh
+	uint mesh;
+	Quat rotation;
+	Vec3 translation;
+	Real scale;
+	// Sphere: radius in x. Box: extents. Rect: width and height in x and y.
+	Vec3 size;
+};
+
+// Buffers are given as offsets from the start of the file, zero when absent
+struct MeshRecord
+{
+	uint vertexAmount;
+	uint triangleAmount;
+	uint bvhNodeAmount;
+	uint64_t positions;
+	uint64_t normals;
+	uint64_t uvs;
+	uint64_t indices;
+	uint64_t bvhNodes;
+	uint64_t bvhReferences;
+};
+
+struct BackgroundRecord
+{
+	Vec3 bottom;
+	Vec3 top;
+};
+
+}	// namespace scenefile
+
+// Collects a scene description and writes it as a binary scene file, with prebuilt hierarchies
+class SceneFileWriter
+{
+private:
+	struct Mesh
+	{
+		std::vector<Vec3> positions;
+		std::vector<Vec3> normals;
+		std::vector<Real> uvs;
+		std::vector<uint> indices;
+		std::vector<BvhNode> bvhNodes;
+		std::vector<uint> bvhReferences;
+	};
+
+	std::vector<scenefile::TextureRecord> textures;
+	std::vector<scenefile::MaterialRecord> materials;
+	std::vector<scenefile::ShapeRecord> shapes;
+	std::vector<Mesh> meshes;
+	scenefile::BackgroundRecord background;
+
+	void addShape(uint type, const Transform &t, const Vec3 &size, uint material, uint mesh);
+	BoundingBox shapeBounds(const scenefile::ShapeRecord &shape) const;
+
+public:
+	SceneFileWriter();
+
+	uint addConstantTexture(const Vec3 &albedo);
+	uint addCheckerTexture(uint texture1, uint texture2, const Vec3 &frequency);
+	uint addLambertian(uint texture);
+	uint addLambertian(const Vec3 &albedo) { return addLambertian(addConstantTexture(albedo)); }
+	uint addMetal(const Vec3 &albedo, Real roughness);
+	uint addDielectric(const Vec3 &albedo, Real refractiveIndex);
+	uint addDiffuseLight(const Vec3 &albedo);
+	uint addMesh(std::vector<Vec3> positions, std::vector<uint> indices,
+		std::vector<Vec3> normals = std::vector<Vec3>(), std::vector<Real> uvs = std::vector<Real>());
+
+	void addSphere(const Vec3 &center, Real radius, uint material);
+	void addBox(const Transform &t, const Vec3 &extents, uint material);
+	void addRect(const Transform &t, Real width, Real height, uint material);
+	void addMeshShape(uint mesh, const Transform &t, uint material);
+	void setBackground(const Vec3 &bottom, const Vec3 &top);
+
+	uint getTextureAmount() const { return uint(textures.size()); }
+	uint getMaterialAmount() const { return uint(materials.size()); }
+	uint getMeshAmount() const { return uint(meshes.size()); }
+	uint getShapeAmount() const { return uint(shapes.size()); }
+
+	bool write(const std::string &fileName) const;
+};
+
+// Loads a binary scene file and keeps it mapped for as long as the scene is in use
+class SceneFile
+{
+private:
+	MappedFile file;
+	std::vector<Texture *> textures;
+	std::vector<Material *> materials;
+	std::vector<Sphere> spheres;
+	std::vector<Box> boxes;
+	std::vector<Rect> rects;
+	std::vector<TriangleMesh *> meshes;
+	Scene scene;
+
+	template <typename T>
+	const T *getChunk(uint type, uint &count) const;
+	template <typename T>
+	const T *getBuffer(uint64_t offset, uint64_t count) const;
+	bool fail(const std::string &fileName, const char *reason);
+
+public:
+	SceneFile() {}
+	SceneFile(const SceneFile &other) = delete;
+	SceneFile &operator=(const SceneFile &other) = delete;
+	~SceneFile() { clear(); }
+
+	bool load(const std::string &fileName);
+	void clear();
+
+	const Scene &getScene() const { return scene; }
+};
+
+template <typename T>
+const T *SceneFile::getChunk(uint type, uint &count) const
+{
+	count = 0;
+	const scenefile::Header *header = reinterpret_cast<const scenefile::Header *>(file.getData());
+	const scenefile::Chunk *chunks = reinterpret_cast<const scenefile::Chunk *>(file.getData() + sizeof(scenefile::Header));
+	for (uint i = 0; i < header->chunkAmount; i++)
+	{
+		const scenefile::Chunk &chunk = chunks[i];
+		if (chunk.type != type)
+			continue;
+		// Compared without sums that could wrap around. A malformed chunk keeps its count, for the caller to tell
+		// it from a missing one.
+		count = chunk.count;
+		if (chunk.offset % alignof(T) != 0 || chunk.offset > file.getSize() || chunk.size > file.getSize() - chunk.offset ||
+			chunk.size != uint64_t(chunk.count) * sizeof(T))
+		{
+			return nullptr;
+		}
+		return reinterpret_cast<const T *>(file.getData() + chunk.offset);
+	}
+	return nullptr;
+}
+
+template <typename T>
+const T *SceneFile::getBuffer(uint64_t offset, uint64_t count) const
+{
+	if (offset == 0 || offset % alignof(T) != 0 || offset > file.getSize() || count > (file.getSize() - offset) / sizeof(T))
+		return nullptr;
+	return reinterpret_cast<const T *>(file.getData() + offset);
+}
@@ -0,0 +1,361 @@
+#include "SceneParser.hpp"
+#include "Trace.hpp"
+
+#include <cctype>
+#include <fstream>
+#include <sstream>
+
+template <typename T>
+bool SceneParser::readOptional(std::istream &is, T &value)
+{
+	is >> std::ws;
+	if (is.eof())
+		return true;
+	return bool(is >> value);
+}
+
+bool SceneParser::load(const std::string &fileName)
+{
+	trace::Scope scope("scene parse", "io");
+	std::ifstream file(fileName);
+	if (!file.is_open())
+	{
+		std::cerr << "Could not open file " << fileName << " for reading." << std::endl;
+		clear();
+		return false;
+	}
+	return parse(file, fileName);
+}
+
+bool SceneParser::parse(std::istream &is, const std::string &sourceName)
+{
+	clear();
+	size_t separator = sourceName.find_last_of('/');
+	directory = separator == std::string::npos ? "" : sourceName.substr(0, separator + 1);
+
+	std::string line;
+	std::string keyword;
+	std::string error;
+	std::istringstream statement;
+	uint lineNumber = 0;
+	while (std::getline(is, line))
+	{
+		lineNumber++;
+		size_t comment = line.find('#');
+		if (comment != std::string::npos)
+			line.erase(comment);
+
+		statement.clear();
+		statement.str(line);
+		if (!(statement >> keyword))
+			continue;
+
+		error.clear();
+		bool valid = parseStatement(keyword, statement, error);
+		if (valid && !(statement >> std::ws).eof())
+		{
+			valid = false;
+			error = "unexpected trailing parameters";
+		}
+		if (!valid)
+		{
+			if (error.empty())
+				error = "invalid parameters";
+			std::cerr << sourceName << ":" << lineNumber << ": " << keyword << ": " << error << "." << std::endl;
+			clear();
+			return false;
+		}
+	}
+
+	scene.build();
+	return true;
+}
+
+bool SceneParser::parseStatement(const std::string &keyword, std::istream &is, std::string &error)
+{
+	if (keyword == "sphere")
+	{
+		Vec3 center;
+		Real radius;
+		if (!(is >> center >> radius))
+			return false;
+		const Material *material = findMaterial(is, error);
+		if (!material)
+			return false;
+		spheres.emplace_back(center, radius, *material);
+		scene.add(spheres.back());
+	}
+	else if (keyword == "box")
+	{
+		Transform t;
+		Vec3 extents;
+		if (!(is >> t >> extents))
+			return false;
+		const Material *material = findMaterial(is, error);
+		if (!material)
+			return false;
+		boxes.emplace_back(t, extents, *material);
+		scene.add(boxes.back());
+	}
+	else if (keyword == "rect")
+	{
+		Transform t;
+		Real rectWidth;
+		Real rectHeight;
+		if (!(is >> t >> rectWidth >> rectHeight))
+			return false;
+		const Material *material = findMaterial(is, error);
+		if (!material)
+			return false;
+		rects.emplace_back(t, rectWidth, rectHeight, *material);
+		scene.add(rects.back());
+	}
+	else if (keyword == "material")
+	{
+		return parseMaterial(is, error);
+	}
+	else if (keyword == "texture")
+	{
+		return parseTexture(is, error);
+	}
+	else if (keyword == "background")
+	{
+		Vec3 bottom;
+		Vec3 top;
+		if (!(is >> bottom >> top))
+			return false;
+		scene.setBackground(Background(bottom, top));
+	}
+	else if (keyword == "camera")
+	{
+		CameraParameters p;
+		if (!(is >> p.position >> p.target >> p.up >> p.fovY) || !readOptional(is, p.aperture) || !readOptional(is, p.focusDistance))
+			return false;
+		cameraParameters = p;
+		cameraDefined = true;
+	}
+	else if (keyword == "resolution")
+	{
+		int w;
+		int h;
+		if (!(is >> w >> h) || w <= 0 || h <= 0)
+			return false;
+		width = uint(w);
+		height = uint(h);
+	}
+	else
+	{
+		error = "unknown statement";
+		return false;
+	}
+	return true;
+}
+
+bool SceneParser::parseTexture(std::istream &is, std::string &error)
+{
+	std::string name;
+	if (!(is >> name >> token))
+		return false;
+	if (textures.count(name))
+	{
+		error = "texture '" + name + "' already defined";
+		return false;
+	}
+
+	if (token == "constant")
+	{
+		Vec3 albedo;
+		if (!(is >> albedo))
+			return false;
+		constantTextures.emplace_back(albedo);
+		textures[name] = &constantTextures.back();
+	}
+	else if (token == "checker")
+	{
+		const Texture *texture1 = findTexture(is, error);
+		if (!texture1)
+			return false;
+		const Texture *texture2 = findTexture(is, error);
+		if (!texture2)
+			return false;
+		Vec3 frequency(1, 1, 1);
+		if (!readOptional(is, frequency))
+			return false;
+		checkerTextures.emplace_back(*texture1, *texture2, frequency);
+		textures[name] = &checkerTextures.back();
+	}
+	else if (token == "image")
+	{
+		std::string fileName;
+		if (!(is >> fileName))
+			return false;
+		if (fileName[0] != '/')
+			fileName = directory + fileName;
+		imageTextures.emplace_back();
+		if (!imageTextures.back().open(fileName))
+		{
+			imageTextures.pop_back();
+			error = "could not load texture image '" + fileName + "'";
+			return false;
+		}
+		textures[name] = &imageTextures.back();
+	}
+	else if (token == "noise")
+	{
+		Real scale = 1;
+		Vec3 albedo(1, 1, 1);
+		if (!(is >> scale) || !readOptional(is, albedo))
+			return false;
+		noiseTextures.emplace_back(scale, albedo);
+		textures[name] = &noiseTextures.back();
+	}
+	else if (token == "turbulence" || token == "marble")
+	{
+		Real scale = 1;
+		int octaves = 0;
+		Vec3 albedo(1, 1, 1);
+		if (!(is >> scale >> octaves) || octaves <= 0 || !readOptional(is, albedo))
+			return false;
+		if (token == "turbulence")
+		{
+			turbulenceTextures.emplace_back(scale, uint(octaves), albedo);
+			textures[name] = &turbulenceTextures.back();
+		}
+		else
+		{
+			marbleTextures.emplace_back(scale, uint(octaves), albedo);
+			textures[name] = &marbleTextures.back();
+		}
+	}
+	else
+	{
+		error = "unknown texture type '" + token + "'";
+		return false;
+	}
+	return true;
+}
+
+bool SceneParser::parseMaterial(std::istream &is, std::string &error)
+{
+	std::string name;
+	if (!(is >> name >> token))
+		return false;
+	if (materials.count(name))
+	{
+		error = "material '" + name + "' already defined";
+		return false;
+	}
+
+	if (token == "lambertian")
+	{
+		// Either a colour or the name of a texture
+		is >> std::ws;
+		if (std::isalpha(is.peek()) || is.peek() == '_')
+		{
+			const Texture *texture = findTexture(is, error);
+			if (!texture)
+				return false;
+			lambertians.emplace_back(*texture);
+		}
+		else
+		{
+			Vec3 albedo;
+			if (!(is >> albedo))
+				return false;
+			constantTextures.emplace_back(albedo);
+			lambertians.emplace_back(constantTextures.back());
+		}
+		materials[name] = &lambertians.back();
+	}
+	else if (token == "metal")
+	{
+		Vec3 albedo;
+		Real roughness = 0;
+		if (!(is >> albedo) || !readOptional(is, roughness))
+			return false;
+		metals.emplace_back(albedo, roughness);
+		materials[name] = &metals.back();
+	}
+	else if (token == "dielectric")
+	{
+		Real refractiveIndex;
+		Vec3 albedo(1, 1, 1);
+		if (!(is >> refractiveIndex) || !readOptional(is, albedo))
+			return false;
+		dielectrics.emplace_back(albedo, refractiveIndex);
+		materials[name] = &dielectrics.back();
+	}
+	else if (token == "light")
+	{
+		Vec3 albedo;
+		if (!(is >> albedo))
+			return false;
+		diffuseLights.emplace_back(albedo);
+		materials[name] = &diffuseLights.back();
+	}
+	else
+	{
+		error = "unknown material type '" + token + "'";
+		return false;
+	}
+	return true;
+}
+
+const Texture *SceneParser::findTexture(std::istream &is, std::string &error)
+{
+	if (!(is >> token))
+		return nullptr;
+	auto it = textures.find(token);
+	if (it == textures.end())
+	{
+		error = "undefined texture '" + token + "'";
+		return nullptr;
+	}
+	return it->second;
+}
+
+const Material *SceneParser::findMaterial(std::istream &is, std::string &error)
+{
+	if (!(is >> token))
+		return nullptr;
+	auto it = materials.find(token);
+	if (it == materials.end())
+	{
+		error = "undefined material '" + token + "'";
+		return nullptr;
+	}
+	return it->second;
+}
+
+void SceneParser::clear()
+{
+	scene.clear();
+	scene.setBackground(Background());
+	spheres.clear();
+	boxes.clear();
+	rects.clear();
+	materials.clear();
+	textures.clear();
+	lambertians.clear();
+	metals.clear();
+	dielectrics.clear();
+	diffuseLights.clear();
+	checkerTextures.clear();
+	imageTextures.clear();
+	noiseTextures.clear();
+	turbulenceTextures.clear();
+	marbleTextures.clear();
+	constantTextures.clear();
+	cameraParameters = CameraParameters();
+	width = 1024;
+	height = 640;
+	cameraDefined = false;
+}
+
+Camera SceneParser::createCamera(const Viewport &viewport) const
+{
+	const CameraParameters &p = cameraParameters;
+	Vec3 direction = p.target - p.position;
+	Real focusDistance = p.focusDistance > 0 ? p.focusDistance : direction.length();
+	return Camera(p.position, direction, p.up, p.fovY, viewport, p.aperture, focusDistance);
+}
@@ -0,0 +1,120 @@
+#pragma once
+
+#include "Common.hpp"
+
+#include "Background.hpp"
+#include "Box.hpp"
+#include "Camera.hpp"
+#include "CheckerTexture.hpp"
+#include "ConstantTexture.hpp"
+#include "Dielectric.hpp"
+#include "DiffuseLight.hpp"
+#include "ImageTexture.hpp"
+#include "Lambertian.hpp"
+#include "Material.hpp"
+#include "Metal.hpp"
+#include "NoiseTexture.hpp"
+#include "Rect.hpp"
+#include "Scene.hpp"
+#include "Sphere.hpp"
+#include "Texture.hpp"
+#include "Transform.hpp"
+#include "Vec3.hpp"
+#include "Viewport.hpp"
+
+#include <deque>
+#include <iostream>
+#include <string>
+#include <unordered_map>
+
+// Text scene files
+//
+// One statement per line, a keyword followed by its parameters. Vectors are three numbers, transforms are
+// a quaternion (w x y z), a translation and a scale. Textures and materials are named when declared and
+// referenced by name afterwards. Everything after a '#' is ignored.
+//
+//   resolution <width> <height>
+//   camera <position> <target> <up> <fovY> [<aperture> <focusDistance>]
+//   background <bottom> <top>
+//   texture <name> constant <albedo>
+//   texture <name> checker <texture1> <texture2> [<frequency>]
+//   texture <name> image <file>            (PPM or PFM, relative to the scene file)
+//   texture <name> noise <scale> [<albedo>]
+//   texture <name> turbulence <scale> <octaves> [<albedo>]
+//   texture <name> marble <scale> <octaves> [<albedo>]
+//   material <name> lambertian <albedo> | <texture>
+//   material <name> metal <albedo> [<roughness>]
+//   material <name> dielectric <refractiveIndex> [<albedo>]
+//   material <name> light <albedo>
+//   sphere <center> <radius> <material>
+//   box <transform> <extents> <material>
+//   rect <transform> <width> <height> <material>
+//
+// Objects are kept in chunked storage, so that they are neither copied nor allocated one by one.
+class SceneParser
+{
+public:
+	struct CameraParameters
+	{
+		Vec3 position = Vec3(0, 0, 0);
+		Vec3 target = Vec3(0, 0, -1);
+		Vec3 up = Vec3(0, 1, 0);
+		Real fovY = 40;
+		Real aperture = 0;
+		// Distance to the target when not positive
+		Real focusDistance = 0;
+	};
+
+private:
+	std::deque<ConstantTexture> constantTextures;
+	std::deque<CheckerTexture> checkerTextures;
+	std::deque<ImageTexture> imageTextures;
+	std::deque<NoiseTexture> noiseTextures;
+	std::deque<TurbulenceTexture> turbulenceTextures;
+	std::deque<MarbleTexture> marbleTextures;
+	std::deque<Lambertian> lambertians;
+	std::deque<Metal> metals;
+	std::deque<Dielectric> dielectrics;
+	std::deque<DiffuseLight> diffuseLights;
+	std::deque<Sphere> spheres;
+	std::deque<Box> boxes;
+	std::deque<Rect> rects;
+	std::unordered_map<std::string, const Texture *> textures;
+	std::unordered_map<std::string, const Material *> materials;
+	Scene scene;
+
+	CameraParameters cameraParameters;
+	uint width = 1024;
+	uint height = 640;
+	bool cameraDefined = false;
+
+	// Reused between statements
+	std::string token;
+	// Of the scene file, where relative paths start
+	std::string directory;
+
+	bool parseStatement(const std::string &keyword, std::istream &is, std::string &error);
+	bool parseTexture(std::istream &is, std::string &error);
+	bool parseMaterial(std::istream &is, std::string &error);
+	const Texture *findTexture(std::istream &is, std::string &error);
+	const Material *findMaterial(std::istream &is, std::string &error);
+	// Read optional trailing parameters, leaving the value untouched when the statement ends
+	template <typename T>
+	static bool readOptional(std::istream &is, T &value);
+
+public:
+	SceneParser() {}
+	SceneParser(const SceneParser &other) = delete;
+	SceneParser &operator=(const SceneParser &other) = delete;
+
+	bool load(const std::string &fileName);
+	bool parse(std::istream &is, const std::string &sourceName = "stream");
+	void clear();
+
+	const Scene &getScene() const { return scene; }
+	bool hasCamera() const { return cameraDefined; }
+	const CameraParameters &getCameraParameters() const { return cameraParameters; }
+	Viewport getViewport() const { return Viewport(width, height); }
+	Camera createCamera(const Viewport &viewport) const;
+	Camera createCamera() const { return createCamera(getViewport()); }
+};
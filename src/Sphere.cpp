@@ -0,0 +1,60 @@
+#include "Sphere.hpp"
+
+bool Sphere::hit(const Ray &r, Real minDist, Real maxDist, HitRecord &rec) const
+{
+	Vec3 center = transform.translation();
+	Real radius = transform.scale();
+	Vec3 oc = r.origin() - center;
+	Real a = dot(r.direction(), r.direction());
+	Real b = dot(oc, r.direction());
+	// Equivalent to b * b - a * c with c = dot(oc, oc) - radius * radius, but measured from the point
+	// of the ray closest to the center, which avoids cancellation when the sphere is large or far away
+	Vec3 perpendicular = oc - (b / a) * r.direction();
+	Real discriminant = a * (radius * radius - dot(perpendicular, perpendicular));
+	bool hit = false;
+	if (discriminant > 0.0)
+	{
+		discriminant = sqrt(discriminant);
+		minDist = minDist * a + b;
+		maxDist = maxDist * a + b;
+		if (-discriminant > minDist && -discriminant < maxDist)
+		{
+			hit = true;
+			discriminant = -discriminant;
+		}
+		else if (discriminant > minDist && discriminant < maxDist)
+		{
+			hit = true;
+		}
+		if (hit)
+		{
+			rec.t = (-b + discriminant) / a;
+			rec.point = r.to(rec.t);
+			rec.normal = (rec.point - center) / radius;
+			// Longitude and latitude, with the poles on the y axis
+			rec.u = Real(0.5) + atan2(rec.normal.z, rec.normal.x) / (2 * math::pi());
+			rec.v = Real(0.5) + asin(math::clamp(rec.normal.y, Real(-1), Real(1))) / math::pi();
+			rec.uvDensity = 1 / (math::pi() * radius);
+			rec.hitable = this;
+		}
+	}
+
+	return hit;
+}
+
+Real Sphere::evaluateSDF(const Vec3 &point) const
+{
+	return (point - transform.translation()).length() - transform.scale();
+}
+
+Vec3 Sphere::evaluateNormalFromSDF(const Vec3 &point, Real epsilon) const
+{
+	return (point - transform.translation()) * transform.inverseScale();
+}
+
+bool Sphere::boundingBox(BoundingBox &box) const
+{
+	Vec3 radius(transform.scale(), transform.scale(), transform.scale());
+	box = BoundingBox(transform.translation() - radius, transform.translation() + radius);
+	return true;
+}
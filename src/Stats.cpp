@@ -0,0 +1,107 @@
+#include "Stats.hpp"
+
+#include <fstream>
+#include <iostream>
+
+namespace stats
+{
+
+const char *counterName(Counter counter)
+{
+	switch (counter)
+	{
+		case Rays: return "rays";
+		case IntersectionTests: return "intersectionTests";
+		case BoundsTests: return "boundsTests";
+		case Bounces: return "bounces";
+		case RaymarchIterations: return "raymarchIterations";
+		case ScatterLambertian: return "scatterLambertian";
+		case ScatterMetal: return "scatterMetal";
+		case ScatterDielectric: return "scatterDielectric";
+		case ScatterDiffuseLight: return "scatterDiffuseLight";
+		case TextureTileLoads: return "textureTileLoads";
+		case Pixels: return "pixels";
+		case Tiles: return "tiles";
+		case TileNanoseconds: return "tileNanoseconds";
+		default: return "unknown";
+	}
+}
+
+void Counters::add(const Counters &other)
+{
+	for (uint i = 0; i < CounterAmount; i++)
+		values[i] += other.values[i];
+	if (other.maxTileNanoseconds > maxTileNanoseconds)
+		maxTileNanoseconds = other.maxTileNanoseconds;
+}
+
+bool RenderStats::enabled()
+{
+#ifdef RAYTRACER_STATS
+	return true;
+#else
+	return false;
+#endif
+}
+
+void RenderStats::begin(uint threadAmount)
+{
+	threads.assign(threadAmount, ThreadSlot());
+	total.reset();
+	seconds = 0.0;
+}
+
+void RenderStats::collect(uint threadIndex)
+{
+	Counters &counters = threadCounters();
+	threads[threadIndex].counters.add(counters);
+	counters.reset();
+}
+
+void RenderStats::end(double renderSeconds)
+{
+	total.reset();
+	for (const ThreadSlot &slot : threads)
+		total.add(slot.counters);
+	seconds = renderSeconds;
+}
+
+static void writeCounters(std::ostream &os, const Counters &counters, const char *indent)
+{
+	for (uint i = 0; i < CounterAmount; i++)
+		os << indent << "\"" << counterName(Counter(i)) << "\": " << counters.values[i] << ",\n";
+	os << indent << "\"maxTileNanoseconds\": " << counters.maxTileNanoseconds;
+}
+
+void RenderStats::writeJson(std::ostream &os) const
+{
+	os << "{\n";
+	os << "\t\"enabled\": " << (enabled() ? "true" : "false") << ",\n";
+	os << "\t\"seconds\": " << seconds << ",\n";
+	os << "\t\"total\": {\n";
+	writeCounters(os, total, "\t\t");
+	os << "\n\t},\n";
+	os << "\t\"threads\": [";
+	for (uint i = 0; i < threads.size(); i++)
+	{
+		os << (i > 0 ? ",\n" : "\n") << "\t\t{\n";
+		writeCounters(os, threads[i].counters, "\t\t\t");
+		os << "\n\t\t}";
+	}
+	os << "\n\t]\n";
+	os << "}\n";
+}
+
+bool RenderStats::writeJson(const std::string &fileName) const
+{
+	std::ofstream file(fileName);
+	if (!file.is_open())
+	{
+		std::cerr << "Could not open file " << fileName << " for writing." << std::endl;
+		return false;
+	}
+	writeJson(file);
+	return bool(file);
+}
+
+}	// namespace stats
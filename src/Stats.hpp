@@ -0,0 +1,96 @@
+#pragma once
+
+#include "Common.hpp"
+
+#include <cstdint>
+#include <ostream>
+#include <string>
+#include <vector>
+
+// Render statistics
+//
+// Hot paths count events with statsAdd and statsIncrement. They only compile to anything when
+// RAYTRACER_STATS is defined, then each thread counts in its own storage and the Renderer collects the
+// counts after every tile or batch of pixels, so that counting never contends between threads.
+namespace stats
+{
+
+enum Counter
+{
+	Rays,
+	IntersectionTests,
+	BoundsTests,
+	Bounces,
+	RaymarchIterations,
+	ScatterLambertian,
+	ScatterMetal,
+	ScatterDielectric,
+	ScatterDiffuseLight,
+	TextureTileLoads,
+	Pixels,
+	Tiles,
+	TileNanoseconds,
+	CounterAmount
+};
+
+const char *counterName(Counter counter);
+
+struct Counters
+{
+	uint64_t values[CounterAmount] = {};
+	uint64_t maxTileNanoseconds = 0;
+
+	void add(const Counters &other);
+	void reset() { *this = Counters(); }
+};
+
+// Counts of the calling thread
+inline Counters &threadCounters()
+{
+	static thread_local Counters counters;
+	return counters;
+}
+
+// Counts of one render, per rendering thread and merged
+class RenderStats
+{
+private:
+	// A cache line apart, so that threads collecting their counts never write to the same line. Padded rather
+	// than aligned, which vectors do not honour before C++17.
+	struct ThreadSlot
+	{
+		Counters counters;
+		char padding[64];
+	};
+
+	std::vector<ThreadSlot> threads;
+	Counters total;
+	double seconds = 0.0;
+
+public:
+	// Whether the counting is compiled in
+	static bool enabled();
+
+	void begin(uint threadAmount);
+	// Moves the counts of the calling thread to its slot, only that thread writes to it
+	void collect(uint threadIndex);
+	void end(double renderSeconds);
+
+	uint getThreadAmount() const { return uint(threads.size()); }
+	const Counters &getThread(uint threadIndex) const { return threads[threadIndex].counters; }
+	const Counters &getTotal() const { return total; }
+	double getSeconds() const { return seconds; }
+
+	void writeJson(std::ostream &os) const;
+	bool writeJson(const std::string &fileName) const;
+};
+
+}	// namespace stats
+
+#ifdef RAYTRACER_STATS
+#define statsAdd(counter, amount) (stats::threadCounters().values[stats::counter] += (amount))
+#else
+#define statsAdd(counter, amount) ((void)0)
+#endif
+
+#define statsIncrement(counter) statsAdd(counter, 1)
@@ -4,10 +4,37 @@
 
 #include "Vec3.hpp"
 
+// Where a texture is sampled on a surface: the point, its uv coordinates and the width of the footprint of the
+// sample in uv units, 0 for the finest detail
+struct TextureCoordinates
+{
+	Vec3 position;
+	Real u = 0;
+	Real v = 0;
+	Real footprint = 0;
+
+	TextureCoordinates() {}
+	TextureCoordinates(const Vec3 &_position, Real _u, Real _v, Real _footprint = 0)
+	: position(_position), u(_u), v(_v), footprint(_footprint) {}
+};
+
+class TextureProgram;
+
 class Texture
 {
 public:
 	virtual ~Texture() {}
 
 	virtual Vec3 sample(const Vec3& position) const = 0;
+	// Textures mapped by uvs override it, the others are sampled at the position
+	virtual Vec3 sampleSurface(const TextureCoordinates &coordinates) const { return sample(coordinates.position); }
+	// Adds the nodes of the texture to the program and returns the first one. By default a node sampling the
+	// texture through its virtual functions, see TextureProgram.cpp.
+	virtual uint compile(TextureProgram &program) const;
+	// Many positions at once, for textures with batched kernels
+	virtual void sampleMany(const Vec3 *positions, uint amount, Vec3 *colours) const
+	{
+		for (uint i = 0; i < amount; i++)
+			colours[i] = sample(positions[i]);
+	}
 };
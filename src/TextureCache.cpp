@@ -0,0 +1,408 @@
+#include "TextureCache.hpp"
+#include "Stats.hpp"
+
+#include <algorithm>
+#include <iostream>
+
+const TextureCache::TextureId TextureCache::invalidTexture;
+const uint TextureCache::tileSize;
+const uint TextureCache::threadEntryAmount;
+
+TextureCache &TextureCache::global()
+{
+	static TextureCache cache;
+	return cache;
+}
+
+TextureCache::TextureCache(size_t _memoryLimit, ImageFormat _format)
+	: memoryLimit(_memoryLimit)
+	, format(_format)
+	, generation(newGeneration())
+{
+}
+
+TextureCache::~TextureCache()
+{
+	if (spillFile)
+		std::fclose(spillFile);
+}
+
+uint64_t TextureCache::tileKey(TextureId texture, uint level, uint tileX, uint tileY)
+{
+	return (uint64_t(texture) << 40) | (uint64_t(level) << 32) | (uint64_t(tileY) << 16) | uint64_t(tileX);
+}
+
+uint64_t TextureCache::newGeneration()
+{
+	// Zero is left to the empty thread cache entries
+	static std::atomic<uint64_t> counter(0);
+	return ++counter;
+}
+
+size_t TextureCache::tileMemory(const Tile &tile)
+{
+	return size_t(tile.texels.getWidth()) * tile.texels.getHeight() * tile.texels.getPixelSizeInBytes() + sizeof(Tile);
+}
+
+TextureCache::TextureId TextureCache::addFile(const std::string &fileName)
+{
+	{
+		std::lock_guard<std::mutex> lock(mutex);
+		auto found = textureIds.find(fileName);
+		if (found != textureIds.end())
+			return found->second;
+	}
+
+	std::shared_ptr<TextureFile> texture = std::make_shared<TextureFile>();
+	texture->fileName = fileName;
+	if (!file::readImageInfo(fileName, texture->info))
+		return invalidTexture;
+	if (!texture->info.binary)
+	{
+		uint width = 0;
+		uint height = 0;
+		bool linear = false;
+		if (!file::readImage(fileName, texture->pixels, width, height, linear))
+			return invalidTexture;
+	}
+
+	// Halved down to a single texel, like ImageTexture::setTexels
+	uint width = texture->info.width;
+	uint height = texture->info.height;
+	texture->levelWidths.push_back(width);
+	texture->levelHeights.push_back(height);
+	while (width > 1 || height > 1)
+	{
+		width = math::max(width / 2, 1u);
+		height = math::max(height / 2, 1u);
+		texture->levelWidths.push_back(width);
+		texture->levelHeights.push_back(height);
+	}
+	if (!buildCoarseLevels(*texture))
+		return invalidTexture;
+
+	std::lock_guard<std::mutex> lock(mutex);
+	auto found = textureIds.find(fileName);
+	if (found != textureIds.end())
+		return found->second;
+	TextureId id = TextureId(textures.size());
+	textures.push_back(texture);
+	textureIds[fileName] = id;
+	return id;
+}
+
+bool TextureCache::buildCoarseLevels(TextureFile &texture)
+{
+	uint levelAmount = uint(texture.levelWidths.size());
+	if (levelAmount == 1)
+		return true;
+
+	// The levels get their range at the end of the spill file, left unused when registering fails
+	texture.levelOffsets.assign(levelAmount, 0);
+	{
+		std::lock_guard<std::mutex> lock(spillMutex);
+		if (!spillFile)
+			spillFile = std::tmpfile();
+		if (!spillFile)
+		{
+			std::cerr << "Could not create a file for the mip levels of " << texture.fileName << "." << std::endl;
+			return false;
+		}
+		for (uint level = 1; level < levelAmount; level++)
+		{
+			texture.levelOffsets[level] = spillSize;
+			spillSize += uint64_t(texture.levelWidths[level]) * texture.levelHeights[level] * 3 * sizeof(float);
+		}
+	}
+
+	// Level 0 goes through a band of rows at a time, each level only holds the row waiting for its pair
+	uint width = texture.info.width;
+	uint height = texture.info.height;
+	std::vector<uint> rowAmounts(levelAmount, 0);
+	std::vector<std::vector<float>> pendingRows(levelAmount);
+	std::vector<float> band(size_t(width) * tileSize * 3);
+	for (uint y0 = 0; y0 < height; y0 += tileSize)
+	{
+		uint bandHeight = math::min(tileSize, height - y0);
+		size_t bandSize = size_t(width) * bandHeight * 3;
+		if (!texture.pixels.empty())
+		{
+			std::copy(&texture.pixels[size_t(y0) * width * 3], &texture.pixels[size_t(y0) * width * 3] + bandSize, band.begin());
+		}
+		else if (!file::readImageRegion(texture.fileName, texture.info, 0, y0, width, bandHeight, band.data()))
+		{
+			return false;
+		}
+
+		if (!texture.info.linear)
+		{
+			for (size_t i = 0; i < bandSize; i++)
+				band[i] *= band[i];
+		}
+
+		for (uint y = 0; y < bandHeight; y++)
+		{
+			if (!addCoarseRow(texture, 0, &band[size_t(y) * width * 3], rowAmounts, pendingRows))
+				return false;
+		}
+	}
+	return true;
+}
+
+bool TextureCache::addCoarseRow(TextureFile &texture, uint level, const float *row, std::vector<uint> &rowAmounts,
+	std::vector<std::vector<float>> &pendingRows)
+{
+	if (level + 1 == texture.levelWidths.size())
+		return true;
+
+	// Same 2 by 2 averages as ImageTexture::setTexels, a level of a single row uses it twice and the last row of
+	// odd heights is left waiting
+	uint width = texture.levelWidths[level];
+	std::vector<float> &pending = pendingRows[level];
+	const float *first = row;
+	if (texture.levelHeights[level] > 1)
+	{
+		if (pending.empty())
+		{
+			pending.assign(row, row + size_t(width) * 3);
+			return true;
+		}
+		first = pending.data();
+	}
+
+	uint nextWidth = texture.levelWidths[level + 1];
+	std::vector<float> next(size_t(nextWidth) * 3);
+	for (uint x = 0; x < nextWidth; x++)
+	{
+		uint x0 = math::min(2 * x, width - 1);
+		uint x1 = math::min(2 * x + 1, width - 1);
+		for (uint c = 0; c < 3; c++)
+		{
+			float sum = first[x0 * 3 + c] + first[x1 * 3 + c] + row[x0 * 3 + c] + row[x1 * 3 + c];
+			next[x * 3 + c] = sum * 0.25f;
+		}
+	}
+	pending.clear();
+
+	uint64_t offset = texture.levelOffsets[level + 1] + uint64_t(rowAmounts[level + 1]) * nextWidth * 3 * sizeof(float);
+	rowAmounts[level + 1]++;
+	bool written = false;
+	{
+		std::lock_guard<std::mutex> lock(spillMutex);
+		written = std::fseek(spillFile, long(offset), SEEK_SET) == 0 &&
+			std::fwrite(next.data(), sizeof(float), next.size(), spillFile) == next.size();
+	}
+	if (!written)
+	{
+		std::cerr << "Could not write the mip levels of " << texture.fileName << "." << std::endl;
+		return false;
+	}
+	return addCoarseRow(texture, level + 1, next.data(), rowAmounts, pendingRows);
+}
+
+uint TextureCache::getLevelAmount(TextureId texture) const
+{
+	std::lock_guard<std::mutex> lock(mutex);
+	return uint(textures[texture]->levelWidths.size());
+}
+
+uint TextureCache::getLevelWidth(TextureId texture, uint level) const
+{
+	std::lock_guard<std::mutex> lock(mutex);
+	return textures[texture]->levelWidths[level];
+}
+
+uint TextureCache::getLevelHeight(TextureId texture, uint level) const
+{
+	std::lock_guard<std::mutex> lock(mutex);
+	return textures[texture]->levelHeights[level];
+}
+
+void TextureCache::loadTexel(TextureId texture, uint level, uint x, uint y, float colour[3])
+{
+	static thread_local ThreadEntry threadEntries[threadEntryAmount];
+
+	uint tileX = x / tileSize;
+	uint tileY = y / tileSize;
+	uint64_t key = tileKey(texture, level, tileX, tileY);
+	uint64_t currentGeneration = generation.load(std::memory_order_acquire);
+	ThreadEntry &entry = threadEntries[(key * 0x9E3779B97F4A7C15ull) >> 60];
+	if (entry.generation != currentGeneration || entry.key != key)
+	{
+		entry.tile = acquireTile(texture, level, tileX, tileY);
+		entry.key = key;
+		entry.generation = currentGeneration;
+	}
+	else if (!entry.tile->referenced.load(std::memory_order_relaxed))
+	{
+		entry.tile->referenced.store(true, std::memory_order_relaxed);
+	}
+	entry.tile->texels.loadColour(x - tileX * tileSize, y - tileY * tileSize, colour);
+}
+
+std::shared_ptr<const TextureCache::Tile> TextureCache::acquireTile(TextureId texture, uint level, uint tileX, uint tileY)
+{
+	uint64_t key = tileKey(texture, level, tileX, tileY);
+	std::shared_ptr<const TextureFile> textureFile;
+	{
+		std::lock_guard<std::mutex> lock(mutex);
+		auto found = slotIndices.find(key);
+		if (found != slotIndices.end())
+		{
+			const std::shared_ptr<const Tile> &tile = slots[found->second].tile;
+			tile->referenced.store(true, std::memory_order_relaxed);
+			return tile;
+		}
+		textureFile = textures[texture];
+	}
+
+	// Loaded without the lock, another thread may load the same tile meanwhile and the first one in is kept
+	std::shared_ptr<const Tile> tile = loadTile(*textureFile, level, tileX, tileY);
+
+	std::lock_guard<std::mutex> lock(mutex);
+	auto found = slotIndices.find(key);
+	if (found != slotIndices.end())
+		return slots[found->second].tile;
+
+	size_t index = slots.size();
+	if (freeSlots.empty())
+	{
+		slots.emplace_back();
+	}
+	else
+	{
+		index = freeSlots.back();
+		freeSlots.pop_back();
+	}
+	slots[index].key = key;
+	slots[index].tile = tile;
+	slotIndices[key] = index;
+	memoryUsage += tileMemory(*tile);
+	loadAmount++;
+	statsIncrement(TextureTileLoads);
+	evict();
+	return tile;
+}
+
+std::shared_ptr<const TextureCache::Tile> TextureCache::loadTile(const TextureFile &texture, uint level, uint tileX, uint tileY)
+{
+	uint x0 = tileX * tileSize;
+	uint y0 = tileY * tileSize;
+	ImageDesc desc;
+	desc.width = math::min(tileSize, texture.levelWidths[level] - x0);
+	desc.height = math::min(tileSize, texture.levelHeights[level] - y0);
+	desc.format = format;
+	std::vector<float> colours(size_t(desc.width) * desc.height * 3);
+
+	if (level == 0)
+	{
+		if (!texture.pixels.empty())
+		{
+			for (uint y = 0; y < desc.height; y++)
+			{
+				const float *row = &texture.pixels[(size_t(y0 + y) * texture.info.width + x0) * 3];
+				std::copy(row, row + desc.width * 3, &colours[size_t(y) * desc.width * 3]);
+			}
+		}
+		else if (!file::readImageRegion(texture.fileName, texture.info, x0, y0, desc.width, desc.height, colours.data()))
+		{
+			// Black rather than failing in the middle of a render
+			std::fill(colours.begin(), colours.end(), 0.0f);
+		}
+
+		// Undo the gamma correction of the integrators
+		if (!texture.info.linear)
+		{
+			for (float &value : colours)
+				value *= value;
+		}
+	}
+	else
+	{
+		// Rows of the level built by addFile
+		uint width = texture.levelWidths[level];
+		std::lock_guard<std::mutex> lock(spillMutex);
+		bool read = true;
+		for (uint y = 0; y < desc.height && read; y++)
+		{
+			uint64_t offset = texture.levelOffsets[level] + (uint64_t(y0 + y) * width + x0) * 3 * sizeof(float);
+			float *out = &colours[size_t(y) * desc.width * 3];
+			read = std::fseek(spillFile, long(offset), SEEK_SET) == 0 &&
+				std::fread(out, sizeof(float), size_t(desc.width) * 3, spillFile) == size_t(desc.width) * 3;
+		}
+		if (!read)
+			std::fill(colours.begin(), colours.end(), 0.0f);
+	}
+
+	std::shared_ptr<Tile> tile = std::make_shared<Tile>(desc);
+	tile->texels.storeColourTile(0, 0, desc.width, desc.height, colours.data());
+	return tile;
+}
+
+void TextureCache::evict()
+{
+	// Referenced tiles are spared once per turn of the hand, and not forever when other threads keep using them
+	size_t steps = 0;
+	while (memoryUsage > memoryLimit && !slotIndices.empty())
+	{
+		if (clockHand >= slots.size())
+			clockHand = 0;
+		Slot &slot = slots[clockHand];
+		if (slot.tile)
+		{
+			bool referenced = slot.tile->referenced.exchange(false, std::memory_order_relaxed);
+			if (!referenced || steps >= 2 * slots.size())
+			{
+				memoryUsage -= tileMemory(*slot.tile);
+				slotIndices.erase(slot.key);
+				slot.tile.reset();
+				freeSlots.push_back(clockHand);
+				evictionAmount++;
+			}
+		}
+		clockHand++;
+		steps++;
+	}
+}
+
+void TextureCache::setMemoryLimit(size_t bytes)
+{
+	std::lock_guard<std::mutex> lock(mutex);
+	memoryLimit = bytes;
+	evict();
+}
+
+size_t TextureCache::getMemoryLimit() const
+{
+	std::lock_guard<std::mutex> lock(mutex);
+	return memoryLimit;
+}
+
+size_t TextureCache::getMemoryUsage() const
+{
+	std::lock_guard<std::mutex> lock(mutex);
+	return memoryUsage;
+}
+
+uint64_t TextureCache::getLoadAmount() const
+{
+	std::lock_guard<std::mutex> lock(mutex);
+	return loadAmount;
+}
+
+uint64_t TextureCache::getEvictionAmount() const
+{
+	std::lock_guard<std::mutex> lock(mutex);
+	return evictionAmount;
+}
+
+void TextureCache::clear()
+{
+	std::lock_guard<std::mutex> lock(mutex);
+	slotIndices.clear();
+	slots.clear();
+	freeSlots.clear();
+	clockHand = 0;
+	memoryUsage = 0;
+	generation.store(newGeneration(), std::memory_order_release);
+}
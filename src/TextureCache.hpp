@@ -0,0 +1,135 @@
+#pragma once
+
+#include "Common.hpp"
+
+#include "File.hpp"
+#include "Image.hpp"
+
+#include <atomic>
+#include <cstddef>
+#include <cstdint>
+#include <cstdio>
+#include <memory>
+#include <mutex>
+#include <string>
+#include <unordered_map>
+#include <vector>
+
+// Texels of image files, loaded a tile at a time on first access and kept under a memory limit.
+//
+// Level 0 tiles are read from the file when sampled. The coarser mip levels are built once when the file is
+// registered, reading level 0 a band of rows at a time, and are kept in a temporary file read the same way. All the
+// textures of a cache share that file, so any number of them only takes a single file descriptor.
+// Resident tiles are evicted with the CLOCK policy once the limit is reached. Each thread keeps the last few tiles it used in its own small cache,
+// which is looked up without locking; only tiles missing from it go through the shared one.
+class TextureCache
+{
+public:
+	typedef uint TextureId;
+	static const TextureId invalidTexture = ~0u;
+	// Side of the tiles in texels
+	static const uint tileSize = 32;
+
+private:
+	struct TextureFile
+	{
+		std::string fileName;
+		file::ImageFileInfo info;
+		std::vector<uint> levelWidths;
+		std::vector<uint> levelHeights;
+		// ASCII files cannot be read in parts and are read once
+		std::vector<float> pixels;
+		// Where the levels past the first start in the spill file, as rows of linear float colours
+		std::vector<uint64_t> levelOffsets;
+
+		TextureFile() {}
+	};
+
+	struct Tile
+	{
+		Image texels;
+		// Set on use, cleared by the clock hand
+		mutable std::atomic<bool> referenced;
+
+		Tile(const ImageDesc &desc) : texels(desc), referenced(true) {}
+	};
+
+	struct Slot
+	{
+		uint64_t key = 0;
+		std::shared_ptr<const Tile> tile;
+
+		Slot() {}
+	};
+
+	// Tiles used last by a thread, direct mapped
+	struct ThreadEntry
+	{
+		uint64_t generation = 0;
+		uint64_t key = 0;
+		std::shared_ptr<const Tile> tile;
+
+		ThreadEntry() {}
+	};
+	static const uint threadEntryAmount = 16;
+
+	mutable std::mutex mutex;
+	std::vector<std::shared_ptr<const TextureFile>> textures;
+	std::unordered_map<std::string, TextureId> textureIds;
+	std::unordered_map<uint64_t, size_t> slotIndices;
+	std::vector<Slot> slots;
+	std::vector<size_t> freeSlots;
+	size_t clockHand = 0;
+	size_t memoryLimit;
+	size_t memoryUsage = 0;
+	uint64_t loadAmount = 0;
+	uint64_t evictionAmount = 0;
+	ImageFormat format;
+	// Tells the thread caches apart from the ones of other caches and of before clear
+	std::atomic<uint64_t> generation;
+	// Coarse levels of every texture, one after the other, created with the first one
+	std::FILE *spillFile = nullptr;
+	uint64_t spillSize = 0;
+	std::mutex spillMutex;
+
+	static uint64_t tileKey(TextureId texture, uint level, uint tileX, uint tileY);
+	static uint64_t newGeneration();
+	static size_t tileMemory(const Tile &tile);
+	bool buildCoarseLevels(TextureFile &texture);
+	bool addCoarseRow(TextureFile &texture, uint level, const float *row, std::vector<uint> &rowAmounts,
+		std::vector<std::vector<float>> &pendingRows);
+
+	std::shared_ptr<const Tile> acquireTile(TextureId texture, uint level, uint tileX, uint tileY);
+	std::shared_ptr<const Tile> loadTile(const TextureFile &texture, uint level, uint tileX, uint tileY);
+	void evict();
+
+public:
+	// The cache shared by the textures of the process
+	static TextureCache &global();
+
+	// Tiles are stored in a float colour format, half floats unless told otherwise
+	TextureCache(size_t _memoryLimit = size_t(256) << 20, ImageFormat _format = ImageFormat::r16g16b16a16f);
+	~TextureCache();
+	TextureCache(const TextureCache &other) = delete;
+	TextureCache &operator=(const TextureCache &other) = delete;
+
+	// Registers a PPM or PFM file, the same file once. Level 0 is read through once to build the coarser levels.
+	TextureId addFile(const std::string &fileName);
+
+	uint getLevelAmount(TextureId texture) const;
+	uint getLevelWidth(TextureId texture, uint level) const;
+	uint getLevelHeight(TextureId texture, uint level) const;
+
+	// Linear colour of a texel, within the level. PPM colours are gamma corrected like the ones written by
+	// file::writePpm.
+	void loadTexel(TextureId texture, uint level, uint x, uint y, float colour[3]);
+
+	// Resident tiles are evicted until they fit, tiles held by the thread caches are not counted
+	void setMemoryLimit(size_t bytes);
+	size_t getMemoryLimit() const;
+	size_t getMemoryUsage() const;
+	uint64_t getLoadAmount() const;
+	uint64_t getEvictionAmount() const;
+	// Drops every resident tile, registered files stay
+	void clear();
+};
@@ -0,0 +1,66 @@
+#include "TextureProgram.hpp"
+#include "CheckerTexture.hpp"
+#include "ImageTexture.hpp"
+#include "NoiseTexture.hpp"
+
+uint Texture::compile(TextureProgram &program) const
+{
+	TextureNode node;
+	node.op = TextureOp::Texture;
+	node.texture = this;
+	return program.addNode(node);
+}
+
+void TextureProgram::compile(const Texture &texture)
+{
+	nodes.clear();
+	compiled.clear();
+	add(texture);
+	compiled.clear();
+}
+
+uint TextureProgram::add(const Texture &texture)
+{
+	auto found = compiled.find(&texture);
+	if (found != compiled.end())
+		return found->second;
+	uint index = texture.compile(*this);
+	compiled[&texture] = index;
+	return index;
+}
+
+uint TextureProgram::addNode(const TextureNode &node)
+{
+	nodes.push_back(node);
+	return uint(nodes.size() - 1);
+}
+
+Vec3 TextureProgram::evaluate(const TextureCoordinates &coordinates) const
+{
+	if (nodes.empty())
+		return Vec3();
+
+	// Down the checkers to a leaf, the known leaves are called directly
+	const TextureNode *node = &nodes[0];
+	while (true)
+	{
+		switch (node->op)
+		{
+			case TextureOp::Constant:
+				return node->value;
+			case TextureOp::Checker:
+				node = &nodes[CheckerTexture::selectsFirst(node->value, coordinates.position) ? node->child1 : node->child2];
+				break;
+			case TextureOp::Noise:
+				return static_cast<const NoiseTexture*>(node->texture)->NoiseTexture::sample(coordinates.position);
+			case TextureOp::Turbulence:
+				return static_cast<const TurbulenceTexture*>(node->texture)->TurbulenceTexture::sample(coordinates.position);
+			case TextureOp::Marble:
+				return static_cast<const MarbleTexture*>(node->texture)->MarbleTexture::sample(coordinates.position);
+			case TextureOp::Image:
+				return static_cast<const ImageTexture*>(node->texture)->ImageTexture::sampleSurface(coordinates);
+			default:
+				return node->texture->sampleSurface(coordinates);
+		}
+	}
+}
@@ -0,0 +1,64 @@
+#pragma once
+
+#include "Common.hpp"
+
+#include "Texture.hpp"
+#include "Vec3.hpp"
+
+#include <cstdint>
+#include <unordered_map>
+#include <vector>
+
+enum class TextureOp : uint8_t
+{
+	Constant,
+	Checker,
+	Noise,
+	Turbulence,
+	Marble,
+	Image,
+	// Any other texture, sampled through its virtual functions
+	Texture
+};
+
+// Flattened texture, the root first. Checkers select one of two other nodes, every other node is a leaf.
+struct TextureNode
+{
+	TextureOp op = TextureOp::Texture;
+	// Checkers only, the nodes sampled where the product of sines is positive and negative
+	uint child1 = 0;
+	uint child2 = 0;
+	// Constants: the albedo. Checkers: the frequency divided by pi, in half periods per unit.
+	Vec3 value;
+	// Leaves sampled by their texture, with direct calls for the known types
+	const Texture *texture = nullptr;
+
+	TextureNode() {}
+};
+
+// A texture tree compiled into nodes, evaluated by a loop instead of a chain of virtual calls. Textures
+// compile themselves with Texture::compile; those used twice in the tree share their nodes. The textures must
+// stay alive and unchanged while the program is used.
+class TextureProgram
+{
+private:
+	std::vector<TextureNode> nodes;
+	// Nodes of the textures compiled so far
+	std::unordered_map<const Texture *, uint> compiled;
+
+public:
+	TextureProgram() {}
+	explicit TextureProgram(const Texture &texture) { compile(texture); }
+
+	void compile(const Texture &texture);
+	// Node of a texture, compiling it on first use, for Texture::compile to add its children
+	uint add(const Texture &texture);
+	uint addNode(const TextureNode &node);
+	TextureNode &getNode(uint index) { return nodes[index]; }
+	const TextureNode &getNode(uint index) const { return nodes[index]; }
+	uint getNodeAmount() const { return uint(nodes.size()); }
+	bool isEmpty() const { return nodes.empty(); }
+
+	// Same colour as sampleSurface on the compiled texture, black when empty
+	Vec3 evaluate(const TextureCoordinates &coordinates) const;
+};
@@ -0,0 +1,54 @@
+#include "TileBuffer.hpp"
+
+void TileBuffer::reset(uint _x, uint _y, uint _width, uint _height, bool keepState)
+{
+	x = _x;
+	y = _y;
+	width = _width;
+	height = _height;
+	stateKept = keepState;
+
+	size_t pixelAmount = size_t(width) * height;
+	colours.resize(pixelAmount * 3);
+	samples.resize(stateKept ? pixelAmount : 0);
+	variances.resize(stateKept ? pixelAmount : 0);
+}
+
+void TileBuffer::shade(const PixelRenderer &pixelRenderer)
+{
+	float *colour = colours.data();
+	size_t index = 0;
+	for (uint row = y; row < y + height; row++)
+	{
+		for (uint col = x; col < x + width; col++, index++)
+		{
+			Vec3 pixel;
+			if (stateKept)
+			{
+				PixelState state;
+				pixel = pixelRenderer.shadePixelWithState(col, row, state);
+				samples[index] = state.samples;
+				variances[index] = state.variance;
+			}
+			else
+			{
+				pixel = pixelRenderer.shadePixel(col, row);
+			}
+			*colour++ = pixel.r;
+			*colour++ = pixel.g;
+			*colour++ = pixel.b;
+		}
+	}
+}
+
+void TileBuffer::commit(Image *colourImage, Image *sampleImage, Image *varianceImage) const
+{
+	if (colourImage)
+		colourImage->storeColourTile(x, y, width, height, colours.data());
+	if (!stateKept)
+		return;
+	if (sampleImage && sampleImage->getDesc().format == ImageFormat::r32ui)
+		sampleImage->storeTile(x, y, width, height, reinterpret_cast<const byte*>(samples.data()));
+	if (varianceImage && varianceImage->getDesc().format == ImageFormat::r32f)
+		varianceImage->storeTile(x, y, width, height, reinterpret_cast<const byte*>(variances.data()));
+}
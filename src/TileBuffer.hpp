@@ -0,0 +1,39 @@
+#pragma once
+
+#include "Common.hpp"
+
+#include "Image.hpp"
+#include "PixelRenderer.hpp"
+
+#include <vector>
+
+// Pixels of one tile, shaded by a single thread and then committed to the frame at once, so that render threads
+// never write next to each other's pixels. The pixel states are only kept when asked for.
+class TileBuffer
+{
+private:
+	uint x = 0;
+	uint y = 0;
+	uint width = 0;
+	uint height = 0;
+	bool stateKept = false;
+	// 3 floats per pixel, rows from the bottom one
+	std::vector<float> colours;
+	std::vector<uint> samples;
+	std::vector<float> variances;
+
+public:
+	// Keeps the storage of the previous tile
+	void reset(uint x, uint y, uint width, uint height, bool keepState);
+	void shade(const PixelRenderer &pixelRenderer);
+	// Copies the tile into the images that are not null. Samples go to r32ui images and variances to r32f ones.
+	void commit(Image *colourImage, Image *sampleImage, Image *varianceImage) const;
+
+	uint getX() const { return x; }
+	uint getY() const { return y; }
+	uint getWidth() const { return width; }
+	uint getHeight() const { return height; }
+	const float *getColours() const { return colours.data(); }
+	const uint *getSamples() const { return samples.data(); }
+	const float *getVariances() const { return variances.data(); }
+};
@@ -0,0 +1,69 @@
+#include "TileCosts.hpp"
+
+void TileCosts::reset(uint _width, uint _height, uint _tileSize)
+{
+	width = _width;
+	height = _height;
+	tileSize = math::max(_tileSize, 1u);
+	tilesX = (width + tileSize - 1) / tileSize;
+	tilesY = (height + tileSize - 1) / tileSize;
+	costs.assign(tilesX * tilesY, Cost());
+}
+
+void TileCosts::record(uint tileX, uint tileY, uint64_t nanoseconds, uint64_t rays)
+{
+	Cost &cost = costs[tileY * tilesX + tileX];
+	cost.nanoseconds = nanoseconds;
+	cost.rays = rays;
+}
+
+uint64_t TileCosts::getValue(uint tileX, uint tileY, TileCostMetric metric) const
+{
+	const Cost &cost = get(tileX, tileY);
+	return metric == TileCostMetricRays ? cost.rays : cost.nanoseconds;
+}
+
+uint64_t TileCosts::getMaximum(TileCostMetric metric) const
+{
+	uint64_t maximum = 0;
+	for (uint tileY = 0; tileY < tilesY; tileY++)
+	{
+		for (uint tileX = 0; tileX < tilesX; tileX++)
+		{
+			uint64_t value = getValue(tileX, tileY, metric);
+			if (value > maximum)
+				maximum = value;
+		}
+	}
+	return maximum;
+}
+
+void TileCosts::makeHeatmap(Image &heatmap, TileCostMetric metric, const Image *render) const
+{
+	uint64_t maximum = getMaximum(metric);
+	Real scale = maximum > 0 ? Real(1) / Real(maximum) : Real(0);
+
+	uint stopX = math::min(width, heatmap.getWidth());
+	uint stopY = math::min(height, heatmap.getHeight());
+	float colourArray[3];
+	for (uint row = 0; row < stopY; row++)
+	{
+		for (uint col = 0; col < stopX; col++)
+		{
+			Vec3 colour = heatColour(getValue(col / tileSize, row / tileSize, metric) * scale);
+			if (render)
+			{
+				// Dim the heat by the brightness of the render, which is already gamma corrected
+				render->loadColour(int(col), int(row), colourArray);
+				Real brightness = Real(colourArray[0] + colourArray[1] + colourArray[2]) / Real(3 * 255.99);
+				colour *= Real(0.5) + Real(0.5) * math::clamp(brightness, Real(0), Real(1));
+			}
+			colour = 255.99 * colour;
+
+			colourArray[0] = colour.r;
+			colourArray[1] = colour.g;
+			colourArray[2] = colour.b;
+			heatmap.storeColour(int(col), int(row), colourArray);
+		}
+	}
+}
@@ -0,0 +1,63 @@
+#pragma once
+
+#include "Common.hpp"
+
+#include "Image.hpp"
+#include "Math.hpp"
+#include "Vec3.hpp"
+
+#include <cstdint>
+#include <vector>
+
+enum TileCostMetric
+{
+	TileCostMetricTime,
+	// Only counted in RAYTRACER_STATS builds
+	TileCostMetricRays
+};
+
+// Wall time and rays spent on each tile of a render, to find out which parts of a frame are expensive.
+// Each tile is only written by the thread that rendered it.
+class TileCosts
+{
+public:
+	struct Cost
+	{
+		uint64_t nanoseconds = 0;
+		uint64_t rays = 0;
+	};
+
+private:
+	std::vector<Cost> costs;
+	uint width = 0;
+	uint height = 0;
+	uint tileSize = 1;
+	uint tilesX = 0;
+	uint tilesY = 0;
+
+public:
+	void reset(uint _width, uint _height, uint _tileSize);
+	void record(uint tileX, uint tileY, uint64_t nanoseconds, uint64_t rays);
+
+	bool empty() const { return costs.empty(); }
+	uint getTilesX() const { return tilesX; }
+	uint getTilesY() const { return tilesY; }
+	uint getTileSize() const { return tileSize; }
+	const Cost &get(uint tileX, uint tileY) const { return costs[tileY * tilesX + tileX]; }
+	uint64_t getValue(uint tileX, uint tileY, TileCostMetric metric) const;
+	uint64_t getMaximum(TileCostMetric metric) const;
+
+	// Fills the image, which must have the size of the render, with the cost of each tile relative to the
+	// most expensive one, from black through red and yellow to white. Pixels are written in the same
+	// range as the integrators write theirs. When given, the render is blended in to locate the objects.
+	void makeHeatmap(Image &heatmap, TileCostMetric metric, const Image *render = nullptr) const;
+};
+
+// Black to white through red and yellow, for t in [0, 1]
+inline Vec3 heatColour(Real t)
+{
+	Real r = math::clamp(Real(3) * t, Real(0), Real(1));
+	Real g = math::clamp(Real(3) * t - Real(1), Real(0), Real(1));
+	Real b = math::clamp(Real(3) * t - Real(2), Real(0), Real(1));
+	return Vec3(r, g, b);
+}
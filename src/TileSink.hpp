@@ -0,0 +1,14 @@
+#pragma once
+
+#include "Common.hpp"
+
+// Receives the tiles of a render as soon as each one is finished, see Renderer::setTileSink
+class TileSink
+{
+public:
+	virtual ~TileSink() {}
+
+	// Called concurrently by the render threads. The tile starts at pixel (x, y) of the frame, its pixels are
+	// 3 floats in the range the integrators store in images, row by row from the bottom one.
+	virtual void writeTile(uint x, uint y, uint width, uint height, const float *pixels) = 0;
+};
@@ -0,0 +1,166 @@
+#include "Trace.hpp"
+
+#include <chrono>
+#include <fstream>
+#include <iostream>
+#include <memory>
+#include <mutex>
+#include <vector>
+
+namespace trace
+{
+
+std::atomic<bool> enabledFlag {false};
+
+namespace
+{
+
+// Events kept per thread, a power of two
+const uint64_t bufferCapacity = 8192;
+
+// Written by one thread at a time, the owner publishes each event by advancing the head
+struct Buffer
+{
+	Event events[bufferCapacity];
+	std::atomic<uint64_t> head {0};
+	std::atomic<bool> inUse {true};
+	uint id = 0;
+};
+
+struct Registry
+{
+	std::mutex mutex;
+	std::vector<std::unique_ptr<Buffer>> buffers;
+	std::chrono::steady_clock::time_point epoch = std::chrono::steady_clock::now();
+};
+
+Registry &registry()
+{
+	static Registry instance;
+	return instance;
+}
+
+// Hands the buffer over to the next new thread when its owner exits
+struct BufferHolder
+{
+	Buffer *buffer = nullptr;
+
+	~BufferHolder()
+	{
+		if (buffer)
+			buffer->inUse.store(false, std::memory_order_release);
+	}
+};
+
+Buffer &threadBuffer()
+{
+	static thread_local BufferHolder holder;
+	if (!holder.buffer)
+	{
+		Registry &r = registry();
+		std::lock_guard<std::mutex> lock(r.mutex);
+		for (std::unique_ptr<Buffer> &buffer : r.buffers)
+		{
+			bool expected = false;
+			if (buffer->inUse.compare_exchange_strong(expected, true, std::memory_order_acquire))
+			{
+				holder.buffer = buffer.get();
+				break;
+			}
+		}
+		if (!holder.buffer)
+		{
+			r.buffers.emplace_back(new Buffer);
+			holder.buffer = r.buffers.back().get();
+			holder.buffer->id = uint(r.buffers.size() - 1);
+		}
+	}
+	return *holder.buffer;
+}
+
+void writeEvent(std::ostream &os, const Event &event, uint threadId)
+{
+	os << "{\"name\": \"" << event.name << "\", \"cat\": \"" << event.category << "\", \"ph\": \"X\"";
+	os << ", \"ts\": " << event.start / 1000.0 << ", \"dur\": " << event.duration / 1000.0;
+	os << ", \"pid\": 1, \"tid\": " << threadId;
+	if (event.argNames[0])
+	{
+		os << ", \"args\": {\"" << event.argNames[0] << "\": " << event.args[0];
+		if (event.argNames[1])
+			os << ", \"" << event.argNames[1] << "\": " << event.args[1];
+		os << "}";
+	}
+	os << "}";
+}
+
+}	// namespace
+
+void setEnabled(bool enabled)
+{
+	// Start the clock before the first event
+	registry();
+	enabledFlag.store(enabled, std::memory_order_relaxed);
+}
+
+uint64_t now()
+{
+	return std::chrono::duration_cast<std::chrono::nanoseconds>(std::chrono::steady_clock::now() - registry().epoch).count();
+}
+
+void record(const Event &event)
+{
+	Buffer &buffer = threadBuffer();
+	uint64_t head = buffer.head.load(std::memory_order_relaxed);
+	buffer.events[head & (bufferCapacity - 1)] = event;
+	buffer.head.store(head + 1, std::memory_order_release);
+}
+
+void clear()
+{
+	Registry &r = registry();
+	std::lock_guard<std::mutex> lock(r.mutex);
+	for (std::unique_ptr<Buffer> &buffer : r.buffers)
+		buffer->head.store(0, std::memory_order_relaxed);
+}
+
+void writeChromeTrace(std::ostream &os)
+{
+	Registry &r = registry();
+	std::lock_guard<std::mutex> lock(r.mutex);
+
+	os.precision(15);
+	os << "{\"displayTimeUnit\": \"ms\", \"traceEvents\": [";
+	bool first = true;
+	for (const std::unique_ptr<Buffer> &buffer : r.buffers)
+	{
+		os << (first ? "\n" : ",\n");
+		first = false;
+		os << "{\"name\": \"thread_name\", \"ph\": \"M\", \"pid\": 1, \"tid\": " << buffer->id;
+		os << ", \"args\": {\"name\": \"thread " << buffer->id << "\"}}";
+
+		// Only the latest events are left once the ring has wrapped around
+		uint64_t head = buffer->head.load(std::memory_order_acquire);
+		uint64_t begin = head > bufferCapacity ? head - bufferCapacity : 0;
+		for (uint64_t i = begin; i < head; i++)
+		{
+			os << ",\n";
+			writeEvent(os, buffer->events[i & (bufferCapacity - 1)], buffer->id);
+		}
+	}
+	os << "\n]}\n";
+}
+
+bool writeChromeTrace(const std::string &fileName)
+{
+	std::ofstream file(fileName);
+	if (!file.is_open())
+	{
+		std::cerr << "Could not open file " << fileName << " for writing." << std::endl;
+		return false;
+	}
+	writeChromeTrace(file);
+	std::cout << "Trace written to " << fileName << std::endl;
+	return bool(file);
+}
+
+}	// namespace trace
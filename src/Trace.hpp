@@ -0,0 +1,80 @@
+#pragma once
+
+#include "Common.hpp"
+
+#include <atomic>
+#include <cstdint>
+#include <ostream>
+#include <string>
+
+// Timeline of the render execution, exported in the Chrome trace format (chrome://tracing, Perfetto)
+//
+// Scoped events are recorded while tracing is enabled, each thread writing to its own ring buffer without
+// locking. Buffers keep the latest events only and outlive their threads, a buffer left by a thread that
+// exited is taken over by the next new thread. Names and categories must be string literals.
+namespace trace
+{
+
+struct Event
+{
+	const char *name = nullptr;
+	const char *category = nullptr;
+	uint64_t start = 0;
+	uint64_t duration = 0;
+	const char *argNames[2] = { nullptr, nullptr };
+	int64_t args[2] = { 0, 0 };
+};
+
+extern std::atomic<bool> enabledFlag;
+
+inline bool enabled() { return enabledFlag.load(std::memory_order_relaxed); }
+void setEnabled(bool enabled);
+// Nanoseconds since tracing was first enabled
+uint64_t now();
+// Records a finished event in the ring buffer of the calling thread
+void record(const Event &event);
+// Forget all events, not to be called while other threads trace
+void clear();
+
+// Written once all traced work is done
+void writeChromeTrace(std::ostream &os);
+bool writeChromeTrace(const std::string &fileName);
+
+// Traces the lifetime of the object, with up to two named integer arguments
+class Scope
+{
+private:
+	Event event;
+
+public:
+	Scope(const char *name, const char *category)
+	{
+		if (!enabled())
+			return;
+		event.name = name;
+		event.category = category;
+		event.start = now();
+	}
+
+	Scope(const char *name, const char *category, const char *argName0, int64_t arg0, const char *argName1 = nullptr, int64_t arg1 = 0)
+	: Scope(name, category)
+	{
+		event.argNames[0] = argName0;
+		event.args[0] = arg0;
+		event.argNames[1] = argName1;
+		event.args[1] = arg1;
+	}
+
+	~Scope()
+	{
+		if (!event.name)
+			return;
+		event.duration = now() - event.start;
+		record(event);
+	}
+
+	Scope(const Scope &other) = delete;
+	Scope &operator=(const Scope &other) = delete;
+};
+
+}	// namespace trace
@@ -2,6 +2,7 @@
 
 #include "Common.hpp"
 
+#include "BoundingBox.hpp"
 #include "Quat.hpp"
 #include "Ray.hpp"
 #include "Vec3.hpp"
@@ -14,8 +15,16 @@ private:
 	Real s = 1;
 	Real invS = 1;
 
+	// Cached matrices, recomputed whenever a component changes.
+	// Rows of the 3x4 affine matrices are laid out as [linear part | translation].
+	Real rotationMatrix[3][3];
+	Real objectToWorld[3][4];
+	Real worldToObject[3][4];
+
+	void updateMatrices();
+
 public:
-	Transform() {}
+	Transform() { updateMatrices(); }
 	Transform(const Quat &_rotation, const Vec3 &_translation, Real _scale);
 
 	inline bool operator==(const Transform &_t) const { return r == _t.r && t == _t.t && s == _t.s; }
@@ -25,8 +34,8 @@ public:
 	const Vec3 &translation() const { return t; }
 	Real scale() const { return s; }
 	Real inverseScale() const { return invS; }
-	void setRotation(const Quat &_r) { r = _r; }
-	void setTranslation(const Vec3 &_t) { t = _t; }
+	void setRotation(const Quat &_r) { r = _r; updateMatrices(); }
+	void setTranslation(const Vec3 &_t) { t = _t; updateMatrices(); }
 	void setScale(Real _s);
 
 	Transform inverse() const;
@@ -34,60 +43,146 @@ public:
 	Vec3 applyInverse(const Vec3 &v) const;
 	Ray apply(const Ray &ray) const;
 	Ray applyInverse(const Ray &ray) const;
+	// Bounds of the transformed box
+	BoundingBox apply(const BoundingBox &box) const;
+
+	// Rotation only, e.g. for directions and normals
+	Vec3 applyRotation(const Vec3 &v) const;
+	Vec3 applyInverseRotation(const Vec3 &v) const;
 };
 
-Transform::Transform(const Quat &_rotation, const Vec3 &_translation, Real _scale)
+inline Transform::Transform(const Quat &_rotation, const Vec3 &_translation, Real _scale)
 : r(_rotation)
 , t(_translation)
 {
 	setScale(_scale);
 }
 
-void Transform::setScale(Real _s)
+// The rotation matrix is built to match rotate(v, r) exactly, including for non-unit quaternions.
+// Rotating by the conjugate is then the transpose.
+inline void Transform::updateMatrices()
+{
+	Real ww = r.w * r.w;
+	Real xx = r.x * r.x;
+	Real yy = r.y * r.y;
+	Real zz = r.z * r.z;
+	Real xy = r.x * r.y;
+	Real xz = r.x * r.z;
+	Real yz = r.y * r.z;
+	Real wx = r.w * r.x;
+	Real wy = r.w * r.y;
+	Real wz = r.w * r.z;
+
+	rotationMatrix[0][0] = ww + xx - yy - zz;
+	rotationMatrix[0][1] = 2 * (xy - wz);
+	rotationMatrix[0][2] = 2 * (xz + wy);
+	rotationMatrix[1][0] = 2 * (xy + wz);
+	rotationMatrix[1][1] = ww - xx + yy - zz;
+	rotationMatrix[1][2] = 2 * (yz - wx);
+	rotationMatrix[2][0] = 2 * (xz - wy);
+	rotationMatrix[2][1] = 2 * (yz + wx);
+	rotationMatrix[2][2] = ww - xx - yy + zz;
+
+	for (uint i = 0; i < 3; i++)
+	{
+		for (uint j = 0; j < 3; j++)
+		{
+			objectToWorld[i][j] = rotationMatrix[i][j] * s;
+			worldToObject[i][j] = rotationMatrix[j][i] * invS;
+		}
+		objectToWorld[i][3] = t[i];
+	}
+
+	for (uint i = 0; i < 3; i++)
+		worldToObject[i][3] = -(worldToObject[i][0] * t.x + worldToObject[i][1] * t.y + worldToObject[i][2] * t.z);
+}
+
+inline void Transform::setScale(Real _s)
 {
 	// Careful with scale close to zero
 	if (_s <= 0.0)
 		_s = 1.0;
 	s = _s;
 	invS = 1.0 / _s;
+	updateMatrices();
 }
 
-Transform Transform::inverse() const
+inline Transform Transform::inverse() const
 {
 	Quat inverseRotation = r.getConjugate();
 	return Transform(inverseRotation, -rotate(t, inverseRotation) * invS, invS);
 }
 
-Vec3 Transform::apply(const Vec3 &v) const
+inline Vec3 Transform::apply(const Vec3 &v) const
 {
-	Vec3 u = v * s;
-	u = rotate(u, r);
-	u += t;
-	return u;
+	const Real (&m)[3][4] = objectToWorld;
+	return Vec3(
+		m[0][0] * v.x + m[0][1] * v.y + m[0][2] * v.z + m[0][3],
+		m[1][0] * v.x + m[1][1] * v.y + m[1][2] * v.z + m[1][3],
+		m[2][0] * v.x + m[2][1] * v.y + m[2][2] * v.z + m[2][3]);
 }
 
-Vec3 Transform::applyInverse(const Vec3 &v) const
+inline Vec3 Transform::applyInverse(const Vec3 &v) const
 {
-	Vec3 u = v - t;
-	u = rotate(u, r.getConjugate());
-	u *= invS;
-	return u;
+	const Real (&m)[3][4] = worldToObject;
+	return Vec3(
+		m[0][0] * v.x + m[0][1] * v.y + m[0][2] * v.z + m[0][3],
+		m[1][0] * v.x + m[1][1] * v.y + m[1][2] * v.z + m[1][3],
+		m[2][0] * v.x + m[2][1] * v.y + m[2][2] * v.z + m[2][3]);
 }
 
-Ray Transform::apply(const Ray &ray) const
+inline Ray Transform::apply(const Ray &ray) const
 {
 	Vec3 o = apply(ray.origin());
-	Vec3 d = rotate(ray.direction(), r);
+	Vec3 d = applyRotation(ray.direction());
 	return Ray(o, d);
 }
 
-Ray Transform::applyInverse(const Ray &ray) const
+inline Ray Transform::applyInverse(const Ray &ray) const
 {
 	Vec3 o = applyInverse(ray.origin());
-	Vec3 d = rotate(ray.direction(), r.getConjugate());
+	Vec3 d = applyInverseRotation(ray.direction());
 	return Ray(o, d);
 }
 
+// From "Transforming Axis-Aligned Bounding Boxes", Arvo, Graphics Gems
+inline BoundingBox Transform::apply(const BoundingBox &box) const
+{
+	if (box.isEmpty())
+		return box;
+
+	BoundingBox res(t, t);
+	for (uint i = 0; i < 3; i++)
+	{
+		for (uint j = 0; j < 3; j++)
+		{
+			Real a = objectToWorld[i][j] * box.minimum[j];
+			Real b = objectToWorld[i][j] * box.maximum[j];
+			res.minimum[i] += math::min(a, b);
+			res.maximum[i] += math::max(a, b);
+		}
+	}
+	return res;
+}
+
+inline Vec3 Transform::applyRotation(const Vec3 &v) const
+{
+	const Real (&m)[3][3] = rotationMatrix;
+	return Vec3(
+		m[0][0] * v.x + m[0][1] * v.y + m[0][2] * v.z,
+		m[1][0] * v.x + m[1][1] * v.y + m[1][2] * v.z,
+		m[2][0] * v.x + m[2][1] * v.y + m[2][2] * v.z);
+}
+
+inline Vec3 Transform::applyInverseRotation(const Vec3 &v) const
+{
+	const Real (&m)[3][3] = rotationMatrix;
+	return Vec3(
+		m[0][0] * v.x + m[1][0] * v.y + m[2][0] * v.z,
+		m[0][1] * v.x + m[1][1] * v.y + m[2][1] * v.z,
+		m[0][2] * v.x + m[1][2] * v.y + m[2][2] * v.z);
+}
+
 inline std::istream &operator>>(std::istream &is, Transform &t)
 {
 	Quat r;
@@ -0,0 +1,250 @@
+#include "TriangleMesh.hpp"
+
+TriangleMesh::RayIntersector::RayIntersector(const TriangleMesh &_mesh, const Ray &r)
+: mesh(_mesh)
+{
+	const Vec3 &d = r.direction();
+	Vec3 absD = abs(d);
+	kz = (absD.x > absD.y) ? (absD.x > absD.z ? 0 : 2) : (absD.y > absD.z ? 1 : 2);
+	kx = (kz + 1) % 3;
+	ky = (kx + 1) % 3;
+	// Preserve winding
+	if (d[kz] < 0)
+		std::swap(kx, ky);
+	sx = d[kx] / d[kz];
+	sy = d[ky] / d[kz];
+	sz = Real(1) / d[kz];
+}
+
+bool TriangleMesh::RayIntersector::operator()(uint primitive, const Ray &r, Real minDist, Real &maxDist)
+{
+	const uint *tri = &mesh.indices[primitive * 3];
+	const Vec3 &o = r.origin();
+	Vec3 a = mesh.positions[tri[0]] - o;
+	Vec3 b = mesh.positions[tri[1]] - o;
+	Vec3 c = mesh.positions[tri[2]] - o;
+
+	Real ax = a[kx] - sx * a[kz];
+	Real ay = a[ky] - sy * a[kz];
+	Real bx = b[kx] - sx * b[kz];
+	Real by = b[ky] - sy * b[kz];
+	Real cx = c[kx] - sx * c[kz];
+	Real cy = c[ky] - sy * c[kz];
+
+	Real u = cx * by - cy * bx;
+	Real v = ax * cy - ay * cx;
+	Real w = bx * ay - by * ax;
+
+	// Edges passing exactly through the ray are recomputed in double to stay watertight
+	if (u == 0 || v == 0 || w == 0)
+	{
+		u = Real(double(cx) * double(by) - double(cy) * double(bx));
+		v = Real(double(ax) * double(cy) - double(ay) * double(cx));
+		w = Real(double(bx) * double(ay) - double(by) * double(ax));
+	}
+
+	if ((u < 0 || v < 0 || w < 0) && (u > 0 || v > 0 || w > 0))
+		return false;
+
+	Real det = u + v + w;
+	if (det == 0)
+		return false;
+
+	Real az = sz * a[kz];
+	Real bz = sz * b[kz];
+	Real cz = sz * c[kz];
+	Real t = (u * az + v * bz + w * cz) / det;
+	if (t <= minDist || t >= maxDist)
+		return false;
+
+	maxDist = t;
+	triangle = primitive;
+	b1 = v / det;
+	b2 = w / det;
+	return true;
+}
+
+Real TriangleMesh::PointDistance::operator()(uint primitive, const Vec3 &p) const
+{
+	const uint *tri = &mesh.indices[primitive * 3];
+	const Vec3 &a = mesh.positions[tri[0]];
+	const Vec3 &b = mesh.positions[tri[1]];
+	const Vec3 &c = mesh.positions[tri[2]];
+
+	Vec3 ab = b - a;
+	Vec3 ac = c - a;
+	Vec3 ap = p - a;
+	Real d1 = dot(ab, ap);
+	Real d2 = dot(ac, ap);
+	if (d1 <= 0 && d2 <= 0)
+		return ap.squaredLength();
+
+	Vec3 bp = p - b;
+	Real d3 = dot(ab, bp);
+	Real d4 = dot(ac, bp);
+	if (d3 >= 0 && d4 <= d3)
+		return bp.squaredLength();
+
+	Real vc = d1 * d4 - d3 * d2;
+	if (vc <= 0 && d1 >= 0 && d3 <= 0)
+		return (ap - ab * (d1 / (d1 - d3))).squaredLength();
+
+	Vec3 cp = p - c;
+	Real d5 = dot(ab, cp);
+	Real d6 = dot(ac, cp);
+	if (d6 >= 0 && d5 <= d6)
+		return cp.squaredLength();
+
+	Real vb = d5 * d2 - d1 * d6;
+	if (vb <= 0 && d2 >= 0 && d6 <= 0)
+		return (ap - ac * (d2 / (d2 - d6))).squaredLength();
+
+	Real va = d3 * d6 - d5 * d4;
+	if (va <= 0 && (d4 - d3) >= 0 && (d5 - d6) >= 0)
+		return (bp - (c - b) * ((d4 - d3) / ((d4 - d3) + (d5 - d6)))).squaredLength();
+
+	Real denom = Real(1) / (va + vb + vc);
+	Real v = vb * denom;
+	Real w = vc * denom;
+	return (ap - ab * v - ac * w).squaredLength();
+}
+
+TriangleMesh::TriangleMesh(const Transform &t, std::vector<Vec3> _positions, std::vector<uint> _indices, const Material &_material,
+	std::vector<Vec3> _normals, std::vector<Real> _uvs)
+: ownedPositions(std::move(_positions))
+, ownedNormals(std::move(_normals))
+, ownedUvs(std::move(_uvs))
+, ownedIndices(std::move(_indices))
+{
+	transform = t;
+	material = &_material;
+
+	vertexAmount = uint(ownedPositions.size());
+	triangleAmount = uint(ownedIndices.size() / 3);
+	positions = ownedPositions.data();
+	normals = ownedNormals.size() == ownedPositions.size() ? ownedNormals.data() : nullptr;
+	uvs = ownedUvs.size() == ownedPositions.size() * 2 ? ownedUvs.data() : nullptr;
+	indices = ownedIndices.data();
+
+	buildBvh();
+}
+
+TriangleMesh::TriangleMesh(const Transform &t, const Vec3 *_positions, const Vec3 *_normals, const Real *_uvs, uint _vertexAmount,
+	const uint *_indices, uint _triangleAmount, const Material &_material,
+	const BvhNode *bvhNodes, uint bvhNodeAmount, const uint *bvhReferences)
+{
+	transform = t;
+	material = &_material;
+
+	positions = _positions;
+	normals = _normals;
+	uvs = _uvs;
+	vertexAmount = _vertexAmount;
+	indices = _indices;
+	triangleAmount = _triangleAmount;
+
+	if (bvhNodes && bvhNodeAmount && bvhReferences)
+		bvh.setData(bvhNodes, bvhNodeAmount, bvhReferences, triangleAmount);
+	else
+		buildBvh();
+}
+
+void TriangleMesh::buildBvh()
+{
+	std::vector<BoundingBox> triangleBounds(triangleAmount);
+	for (uint i = 0; i < triangleAmount; i++)
+	{
+		const uint *tri = &indices[i * 3];
+		triangleBounds[i].extend(positions[tri[0]]).extend(positions[tri[1]]).extend(positions[tri[2]]);
+	}
+	bvh.build(triangleBounds);
+}
+
+Vec3 TriangleMesh::geometricNormal(uint triangle) const
+{
+	const uint *tri = &indices[triangle * 3];
+	const Vec3 &a = positions[tri[0]];
+	return normalize(cross(positions[tri[1]] - a, positions[tri[2]] - a));
+}
+
+Vec3 TriangleMesh::shadingNormal(uint triangle, Real b1, Real b2) const
+{
+	if (!normals)
+		return geometricNormal(triangle);
+
+	const uint *tri = &indices[triangle * 3];
+	return normalize(normals[tri[0]] * (1 - b1 - b2) + normals[tri[1]] * b1 + normals[tri[2]] * b2);
+}
+
+void TriangleMesh::surfaceCoordinates(uint triangle, Real b1, Real b2, HitRecord &rec) const
+{
+	if (!uvs)
+	{
+		rec.u = b1;
+		rec.v = b2;
+		rec.uvDensity = 0;
+		return;
+	}
+
+	const uint *tri = &indices[triangle * 3];
+	const Real *uv0 = &uvs[tri[0] * 2];
+	const Real *uv1 = &uvs[tri[1] * 2];
+	const Real *uv2 = &uvs[tri[2] * 2];
+	Real b0 = 1 - b1 - b2;
+	rec.u = uv0[0] * b0 + uv1[0] * b1 + uv2[0] * b2;
+	rec.v = uv0[1] * b0 + uv1[1] * b1 + uv2[1] * b2;
+
+	// Square root of the ratio of the uv and mesh space areas of the triangle
+	const Vec3 &a = positions[tri[0]];
+	Real area = cross(positions[tri[1]] - a, positions[tri[2]] - a).length();
+	Real uvArea = math::abs((uv1[0] - uv0[0]) * (uv2[1] - uv0[1]) - (uv2[0] - uv0[0]) * (uv1[1] - uv0[1]));
+	rec.uvDensity = area > 0 ? sqrt(uvArea / area) * transform.inverseScale() : 0;
+}
+
+bool TriangleMesh::hit(const Ray &r, Real minDist, Real maxDist, HitRecord &rec) const
+{
+	// Transform the ray into mesh space, where distances are divided by the scale
+	Ray ray = transform.applyInverse(r);
+	Real invScale = transform.inverseScale();
+	Real localMaxDist = maxDist * invScale;
+
+	RayIntersector intersector(*this, ray);
+	if (!bvh.intersect(ray, minDist * invScale, localMaxDist, intersector))
+		return false;
+
+	rec.t = localMaxDist * transform.scale();
+	rec.point = r.to(rec.t);
+	rec.normal = transform.applyRotation(shadingNormal(intersector.triangle, intersector.b1, intersector.b2));
+	surfaceCoordinates(intersector.triangle, intersector.b1, intersector.b2, rec);
+	rec.hitable = this;
+	return true;
+}
+
+// Unsigned distance to the closest triangle, enough for sphere tracing to find the surface
+Real TriangleMesh::evaluateSDF(const Vec3 &point) const
+{
+	PointDistance distance(*this);
+	uint closest = 0;
+	Real squaredDist = bvh.closestSquared(transform.applyInverse(point), distance, closest);
+	if (squaredDist == math::maxReal())
+		return math::maxReal();
+	return sqrt(squaredDist) * transform.scale();
+}
+
+Vec3 TriangleMesh::evaluateNormalFromSDF(const Vec3 &point, Real epsilon) const
+{
+	if (triangleAmount == 0)
+		return Vec3();
+
+	// The gradient of an unsigned distance vanishes on the surface, use the closest face instead
+	PointDistance distance(*this);
+	uint closest = 0;
+	bvh.closestSquared(transform.applyInverse(point), distance, closest);
+	return transform.applyRotation(geometricNormal(closest));
+}
+
+bool TriangleMesh::boundingBox(BoundingBox &box) const
+{
+	box = transform.apply(bvh.bounds());
+	return !box.isEmpty();
+}
@@ -0,0 +1,95 @@
+#pragma once
+
+#include "Common.hpp"
+
+#include "BoundingBox.hpp"
+#include "Bvh.hpp"
+#include "Hitable.hpp"
+
+#include <utility>
+#include <vector>
+
+class Material;
+
+// Indexed triangle mesh with its own acceleration structure.
+// Vertex attributes are shared between triangles: positions and optional per-vertex normals and uvs
+// (two Reals per vertex), indexed three by three. Buffers are either owned or borrowed from memory
+// that outlives the mesh.
+class TriangleMesh : public Hitable
+{
+private:
+	std::vector<Vec3> ownedPositions;
+	std::vector<Vec3> ownedNormals;
+	std::vector<Real> ownedUvs;
+	std::vector<uint> ownedIndices;
+
+	const Vec3 *positions = nullptr;
+	const Vec3 *normals = nullptr;
+	const Real *uvs = nullptr;
+	const uint *indices = nullptr;
+	uint vertexAmount = 0;
+	uint triangleAmount = 0;
+
+	Bvh bvh;
+
+	class RayIntersector;
+	class PointDistance;
+
+	void buildBvh();
+	Vec3 geometricNormal(uint triangle) const;
+	Vec3 shadingNormal(uint triangle, Real b1, Real b2) const;
+	// Interpolated uvs, or the barycentric coordinates without uvs
+	void surfaceCoordinates(uint triangle, Real b1, Real b2, HitRecord &rec) const;
+
+public:
+	TriangleMesh(const Transform &t, std::vector<Vec3> _positions, std::vector<uint> _indices, const Material &_material,
+		std::vector<Vec3> _normals = std::vector<Vec3>(), std::vector<Real> _uvs = std::vector<Real>());
+	// Borrowed buffers. A prebuilt hierarchy can be given as well, otherwise one is built.
+	TriangleMesh(const Transform &t, const Vec3 *_positions, const Vec3 *_normals, const Real *_uvs, uint _vertexAmount,
+		const uint *_indices, uint _triangleAmount, const Material &_material,
+		const BvhNode *bvhNodes = nullptr, uint bvhNodeAmount = 0, const uint *bvhReferences = nullptr);
+
+	virtual bool hit(const Ray &r, Real minDist, Real maxDist, HitRecord &rec) const override;
+	virtual Real evaluateSDF(const Vec3 &point) const override;
+	virtual Vec3 evaluateNormalFromSDF(const Vec3 &point, Real epsilon) const override;
+	virtual bool boundingBox(BoundingBox &box) const override;
+
+	uint getVertexAmount() const { return vertexAmount; }
+	uint getTriangleAmount() const { return triangleAmount; }
+	const Vec3 *getPositions() const { return positions; }
+	const Vec3 *getNormals() const { return normals; }
+	const Real *getUvs() const { return uvs; }
+	const uint *getIndices() const { return indices; }
+	const Bvh &getBvh() const { return bvh; }
+};
+
+// Watertight ray/triangle test from "Watertight Ray/Triangle Intersection", Woop, Benthin and Wald, JCGT 2013.
+// Per-ray shear constants are computed once and reused for every triangle visited.
+class TriangleMesh::RayIntersector
+{
+private:
+	const TriangleMesh &mesh;
+	uint kx, ky, kz;
+	Real sx, sy, sz;
+
+public:
+	uint triangle = 0;
+	Real b1 = 0;
+	Real b2 = 0;
+
+	RayIntersector(const TriangleMesh &_mesh, const Ray &r);
+
+	bool operator()(uint primitive, const Ray &r, Real minDist, Real &maxDist);
+};
+
+// Squared distance from a point to a triangle, from Real-Time Collision Detection, Ericson, 5.1.5
+class TriangleMesh::PointDistance
+{
+private:
+	const TriangleMesh &mesh;
+
+public:
+	PointDistance(const TriangleMesh &_mesh) : mesh(_mesh) {}
+
+	Real operator()(uint primitive, const Vec3 &p) const;
+};
@@ -0,0 +1,126 @@
+#include "Viewer.hpp"
+#include "Trace.hpp"
+
+void Viewer::clampToAspectRatio(uint &width, uint &height, const Real aspectRatio) const
+{
+	Real framebufferAspectRatio = Real(width) / Real(height);
+	if (aspectRatio > framebufferAspectRatio)
+	{
+		height = width / aspectRatio;
+	}
+	else
+	{
+		width = height * aspectRatio;
+	}
+}
+
+void Viewer::getCenteredViewportOrigin(uint &x, uint &y, uint windowWidth, uint windowHeight, uint viewportWidth, uint viewportHeight) const
+{
+	// Assuming windowWidth >= viewportWidth and windowHeight >= viewportHeight
+	x = (windowWidth - viewportWidth) / 2;
+	y = (windowHeight - viewportHeight) / 2;
+}
+
+void Viewer::normalizeImage(Image &image) const
+{
+	// Assuming image has primitive type float
+	ImageView<float> samples = image.view<float>();
+	size_t sampleAmount = samples.size();
+	float imageMax = 0.0f;
+	for (size_t i = 0; i < sampleAmount; i++)
+		imageMax = math::max(imageMax, samples.data[i]);
+
+	float factor = abs(imageMax) > 1e-6 ? (1.0 / imageMax) : 1.0;
+	for (size_t i = 0; i < sampleAmount; i++)
+		samples.data[i] *= factor;
+}
+
+float Viewer::getColourMaximum(const Image &image) const
+{
+	uint width = image.getWidth();
+	uint height = image.getHeight();
+	float colour[3];
+	float imageMax = 0.0f;
+	for (uint y = 0; y < height; y++)
+	{
+		for (uint x = 0; x < width; x++)
+		{
+			image.loadColour(x, y, colour);
+			imageMax = math::max(imageMax, math::max(colour[0], math::max(colour[1], colour[2])));
+		}
+	}
+	return imageMax;
+}
+
+Viewer::Viewer(uint displayWidth, uint displayHeight, const std::string &displayName)
+: platform(displayWidth, displayHeight, displayName)
+{}
+
+bool Viewer::show(const Image &image, std::mutex *imageMutex)
+{
+	if (!platform.init())
+		return false;
+
+	if (!gpu.init())
+		return false;
+
+	// Colour images are staged as 8 bit, a quarter of the upload of float ones
+	bool colourImage = Image::isColourFormat(image.getDesc().format);
+	ImageDesc stagingDesc = image.getDesc();
+	stagingDesc.layout = ImageLayout::Linear;
+	if (colourImage)
+		stagingDesc.format = ImageFormat::r8g8b8a8un;
+	Image stagingImage(stagingDesc);
+	// Copied while holding the mutex, converted after releasing it
+	Image frame(image.getDesc());
+
+	while (platform.isLive())
+	{
+		uint width, height;
+		platform.getFramebufferSize(width, height);
+
+		uint viewportWidth = width;
+		uint viewportHeight = height;
+		clampToAspectRatio(viewportWidth, viewportHeight, image.getAspectRatio());
+		uint x = 0;
+		uint y = 0;
+		getCenteredViewportOrigin(x, y, width, height, viewportWidth, viewportHeight);
+
+		{
+			trace::Scope scope("viewer upload", "viewer");
+
+			// Update staging and normalize
+			{
+				std::unique_lock<std::mutex> lock;
+				if (imageMutex)
+					lock = std::unique_lock<std::mutex>(*imageMutex);
+				frame = image;
+			}
+			if (colourImage)
+			{
+				float imageMax = getColourMaximum(frame);
+				frame.convertTo(stagingImage, imageMax > 1e-6f ? 255.99f / imageMax : 1.0f);
+			}
+			else
+			{
+				frame.convertTo(stagingImage);
+				normalizeImage(stagingImage);
+			}
+
+			gpu.setViewport(x, y, viewportWidth, viewportHeight);
+			gpu.updateDisplayImage(stagingImage);
+			gpu.render();
+		}
+
+		// Swap buffers and poll events
+		platform.update();
+
+		// Sleep to reduce cpu time usage
+		std::this_thread::sleep_for(std::chrono::milliseconds(100));
+	}
+
+	gpu.end();
+	platform.end();
+
+	return true;
+}
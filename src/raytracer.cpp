@@ -5,123 +5,540 @@
 #include "Camera.hpp"
 #include "Dielectric.hpp"
 #include "DiffuseLight.hpp"
+#include "Exr.hpp"
 #include "File.hpp"
 #include "Image.hpp"
 #include "Lambertian.hpp"
 #include "Metal.hpp"
+#include "PixelRenderer.hpp"
 #include "Preview.hpp"
+#include "Raymarch.hpp"
 #include "Raytrace.hpp"
+#include "RaytraceVisualizer.hpp"
 #include "Rect.hpp"
 #include "Renderer.hpp"
 #include "Scene.hpp"
+#include "SceneFile.hpp"
+#include "SceneParser.hpp"
 #include "Sphere.hpp"
+#include "Stats.hpp"
+#include "TextureCache.hpp"
+#include "TileCosts.hpp"
+#include "Trace.hpp"
 #include "Transform.hpp"
 #include "Vec3.hpp"
+#ifdef RAYTRACER_VIEWER
 #include "Viewer.hpp"
+#endif
 
+#include <algorithm>
 #include <chrono>
+#include <cstdlib>
 #include <iostream>
+#include <memory>
+#include <string>
+#include <vector>
+
+bool hasExtension(const std::string &fileName, const std::string &extension)
+{
+	return fileName.size() > extension.size() &&
+		fileName.compare(fileName.size() - extension.size(), extension.size(), extension) == 0;
+}
+
+// The format follows the extension, PPM by default. Values tells float formats how to convert the samples back.
+bool writeImage(const std::string &fileName, const Image &image, file::ExrValues values)
+{
+	if (hasExtension(fileName, ".pfm"))
+		return file::writePfm(fileName, image, values);
+	if (hasExtension(fileName, ".exr"))
+		return file::writeExr(fileName, std::vector<file::ExrLayer>(1, file::ExrLayer("", image, values)));
+	return file::writePpm(fileName, image);
+}
 
 class FileWriterCallback : public FinishCallbackFunctor
 {
 private:
 	const char *filename = nullptr;
 	const Image &image;
+	file::ExrValues values = file::ExrValuesColour;
 	std::chrono::high_resolution_clock::time_point timeStart;
+	bool writeEnabled = true;
+	bool written = true;
 
 public:
-	FileWriterCallback(const char *_filename, const Image &_image)
+	FileWriterCallback(const char *_filename, const Image &_image, file::ExrValues _values)
 	: filename(_filename)
 	, image(_image)
+	, values(_values)
 	{
 		timeStart = std::chrono::high_resolution_clock::now();
 	}
 
+	// Only the duration is reported when disabled
+	void setWriteEnabled(bool enabled) { writeEnabled = enabled; }
+	// False when writing the image failed
+	bool succeeded() const { return written; }
+
 	virtual void operator()() override
 	{
 		std::chrono::high_resolution_clock::time_point timeStop = std::chrono::high_resolution_clock::now();
 		std::cout << "Render duration: " <<
 		std::chrono::duration_cast<std::chrono::milliseconds>(timeStop - timeStart).count() / 1000.0 << "s" <<
 		std::endl;
-		file::writePpm(filename, image);
+		if (writeEnabled)
+			written = writeImage(filename, image, values);
 	}
 };
 
-int main(int argc, char *argv[])
+struct Options
 {
+	std::string outputFileName;
+	std::string sceneFileName;
+	std::string integrator;
+	std::string statsFileName;
+	std::string heatmapFileName;
+	std::string traceFileName;
+	std::string imageFormat;
+	std::vector<std::string> layers;
+	TileCostMetric heatmapMetric = TileCostMetricTime;
+	uint width = 0;
+	uint height = 0;
 	uint samplesPerPixel = 100;
+	uint threadCount = 0;
+	uint textureCacheMegabytes = 256;
+	bool headless = false;
+	bool stream = false;
+	bool tiledImage = false;
+};
+
+void printUsage(const char *programName)
+{
+	std::cout << "usage: " << programName << " [options] [output_file] [scene_file]\n"
+		"  Renders scene_file, or a generated scene, and writes the result to output_file.ppm,\n"
+		"  or to output_file as floating point colours when it ends with .pfm or .exr.\n"
+		"  Text scene files are parsed, binary ones (.rtscene) are mapped.\n"
+		"options:\n"
+		"  -h, --help                 Prints this message.\n"
+		"  -o, --output file          Output file, the program name by default.\n"
+		"  -r, --resolution WxH       Image resolution, overrides the one of the scene.\n"
+		"  -s, --spp n                Samples per pixel for raytrace and raymarch (100).\n"
+		"  -t, --threads n            Rendering threads, all hardware threads by default.\n"
+		"  -i, --integrator name      raytrace, raymarch, preview, or visualizer-depth, -normal or -bounces.\n"
+		"                             Defaults to preview with the viewer and raytrace when headless.\n"
+		"      --headless             Renders without opening the viewer.\n"
+		"      --stream               Writes the tiles of an .exr output as they finish instead of keeping\n"
+		"                             the image in memory, implies --headless.\n"
+		"      --stats file           Writes render statistics as JSON, counted in RAYTRACER_STATS builds.\n"
+		"      --heatmap file         Writes the cost of each tile over the render to file.ppm.\n"
+		"      --heatmap-metric name  time (default), or rays in RAYTRACER_STATS builds.\n"
+		"      --trace file           Writes a timeline of the execution in Chrome trace format.\n"
+		"      --layers names         Adds depth, normal or bounces visualizer layers to an .exr output,\n"
+		"                             comma separated.\n"
+		"      --image-format name    Storage of the rendered image: float, half, r11g11b10 or 8bit.\n"
+		"                             Defaults to half for preview and float otherwise.\n"
+		"      --tiled-image          Stores the rendered image in blocks of the size of the render tiles.\n"
+		"      --texture-cache MB     Memory kept for image texture tiles (256), they are read again once evicted.\n";
+#ifndef RAYTRACER_VIEWER
+	std::cout << "  This build has no viewer and always runs headless.\n";
+#endif
+}
+
+bool parseUint(const char *text, uint &value)
+{
+	char *end = nullptr;
+	long parsed = std::strtol(text, &end, 10);
+	if (end == text || *end != '\0' || parsed < 0)
+		return false;
+	value = uint(parsed);
+	return true;
+}
+
+// Returns 0 to continue, otherwise the exit code
+int parseOptions(int argc, char *argv[], Options &options)
+{
+	options.outputFileName = argv[0];
+	std::vector<std::string> positionals;
+	bool outputGiven = false;
+	for (int i = 1; i < argc; i++)
+	{
+		std::string arg(argv[i]);
+		bool hasValue = i + 1 < argc;
+		bool valid = true;
+		if (arg == "-h" || arg == "--help")
+		{
+			printUsage(argv[0]);
+			return -1;
+		}
+		else if (arg == "--headless")
+		{
+			options.headless = true;
+		}
+		else if (arg == "--tiled-image")
+		{
+			options.tiledImage = true;
+		}
+		else if (arg == "--stream")
+		{
+			options.stream = true;
+			options.headless = true;
+		}
+		else if ((arg == "-o" || arg == "--output") && hasValue)
+		{
+			options.outputFileName = argv[++i];
+			outputGiven = true;
+		}
+		else if ((arg == "-r" || arg == "--resolution") && hasValue)
+		{
+			std::string resolution(argv[++i]);
+			size_t separator = resolution.find('x');
+			valid = separator != std::string::npos &&
+				parseUint(resolution.substr(0, separator).c_str(), options.width) &&
+				parseUint(resolution.substr(separator + 1).c_str(), options.height) &&
+				options.width > 0 && options.height > 0;
+		}
+		else if ((arg == "-s" || arg == "--spp") && hasValue)
+		{
+			valid = parseUint(argv[++i], options.samplesPerPixel) && options.samplesPerPixel > 0;
+		}
+		else if ((arg == "-t" || arg == "--threads") && hasValue)
+		{
+			valid = parseUint(argv[++i], options.threadCount);
+		}
+		else if (arg == "--texture-cache" && hasValue)
+		{
+			valid = parseUint(argv[++i], options.textureCacheMegabytes) && options.textureCacheMegabytes > 0;
+		}
+		else if ((arg == "-i" || arg == "--integrator") && hasValue)
+		{
+			options.integrator = argv[++i];
+		}
+		else if (arg == "--stats" && hasValue)
+		{
+			options.statsFileName = argv[++i];
+		}
+		else if (arg == "--trace" && hasValue)
+		{
+			options.traceFileName = argv[++i];
+		}
+		else if (arg == "--layers" && hasValue)
+		{
+			std::string list(argv[++i]);
+			size_t start = 0;
+			while (valid && start <= list.size())
+			{
+				size_t end = std::min(list.find(',', start), list.size());
+				std::string layer = list.substr(start, end - start);
+				valid = layer == "depth" || layer == "normal" || layer == "bounces";
+				options.layers.push_back(layer);
+				start = end + 1;
+			}
+		}
+		else if (arg == "--image-format" && hasValue)
+		{
+			options.imageFormat = argv[++i];
+			valid = options.imageFormat == "float" || options.imageFormat == "half" ||
+				options.imageFormat == "r11g11b10" || options.imageFormat == "8bit";
+		}
+		else if (arg == "--heatmap" && hasValue)
+		{
+			options.heatmapFileName = argv[++i];
+		}
+		else if (arg == "--heatmap-metric" && hasValue)
+		{
+			std::string metric(argv[++i]);
+			valid = metric == "time" || metric == "rays";
+			options.heatmapMetric = metric == "rays" ? TileCostMetricRays : TileCostMetricTime;
+		}
+		else if (arg.size() > 1 && arg[0] == '-')
+		{
+			valid = false;
+		}
+		else if (positionals.size() < 2)
+		{
+			positionals.push_back(arg);
+		}
+		else
+		{
+			valid = false;
+		}
+
+		if (!valid)
+		{
+			std::cerr << "Invalid argument '" << arg << "'." << std::endl;
+			printUsage(argv[0]);
+			return 1;
+		}
+	}
+
+	// A single positional argument is the output file, unless it was given as an option
+	if (positionals.size() == 2 && outputGiven)
+	{
+		std::cerr << "Output file given twice." << std::endl;
+		return 1;
+	}
+	if (positionals.size() == 2 || (positionals.size() == 1 && !outputGiven))
+		options.outputFileName = positionals[0];
+	if (positionals.size() == 2 || (positionals.size() == 1 && outputGiven))
+		options.sceneFileName = positionals.back();
+
+	if (!options.layers.empty() && !hasExtension(options.outputFileName, ".exr"))
+	{
+		std::cerr << "Layers can only be written to an .exr output." << std::endl;
+		return 1;
+	}
+	if (options.stream && (!hasExtension(options.outputFileName, ".exr") || !options.layers.empty()))
+	{
+		std::cerr << "Only an .exr output without layers can be streamed." << std::endl;
+		return 1;
+	}
+
+#ifndef RAYTRACER_VIEWER
+	options.headless = true;
+#endif
+	if (options.integrator.empty())
+		options.integrator = options.headless ? "raytrace" : "preview";
+	// Previews are approximate, half floats are enough
+	if (options.imageFormat.empty())
+		options.imageFormat = options.integrator == "preview" ? "half" : "float";
+
+	return 0;
+}
+
+int main(int argc, char *argv[])
+{
+	Options options;
+	int exitCode = parseOptions(argc, argv, options);
+	if (exitCode != 0)
+		return exitCode < 0 ? 0 : exitCode;
+
+	if (!options.traceFileName.empty())
+		trace::setEnabled(true);
+	TextureCache::global().setMemoryLimit(size_t(options.textureCacheMegabytes) << 20);
+
 	Viewport viewport(1024, 640);
-	ImageDesc imageDesc;
-	imageDesc.width = viewport.width();
-	imageDesc.height = viewport.height();
-	imageDesc.format = ImageFormat::r32g32b32f;
-	Image image(imageDesc);
+
+	SceneParser sceneParser;
+	SceneFile sceneFile;
+	const Scene *loadedScene = nullptr;
+	if (!options.sceneFileName.empty())
+	{
+		if (hasExtension(options.sceneFileName, ".rtscene"))
+		{
+			if (!sceneFile.load(options.sceneFileName))
+				return 1;
+			loadedScene = &sceneFile.getScene();
+		}
+		else
+		{
+			if (!sceneParser.load(options.sceneFileName))
+				return 1;
+			loadedScene = &sceneParser.getScene();
+			viewport = sceneParser.getViewport();
+		}
+	}
+	if (options.width > 0)
+		viewport = Viewport(options.width, options.height);
 
 	Vec3 cameraPosition(13.0, 2.0, 3.0);
 	Vec3 focusPosition(0, 0.5, 0);
 	Vec3 focusDirection = focusPosition - cameraPosition;
 	Camera camera(cameraPosition, focusDirection, Vec3(0, 1, 0), 20, viewport, 0.25, focusDirection.length() - 4.0);
+	if (sceneParser.hasCamera())
+		camera = sceneParser.createCamera(viewport);
 
-	int arenaDimensions[4] = { -11, 11, -11, 11 };
-	int arenaSize = (arenaDimensions[1] - arenaDimensions[0]) * (arenaDimensions[3] - arenaDimensions[2]);
+	ImageDesc imageDesc;
+	imageDesc.width = viewport.width();
+	imageDesc.height = viewport.height();
+	imageDesc.format = ImageFormat::r32g32b32f;
+	// Layers and heatmap stay float, the render is stored as asked
+	ImageDesc renderDesc = imageDesc;
+	if (options.imageFormat == "half")
+		renderDesc.format = ImageFormat::r16g16b16a16f;
+	else if (options.imageFormat == "r11g11b10")
+		renderDesc.format = ImageFormat::r11g11b10f;
+	else if (options.imageFormat == "8bit")
+		renderDesc.format = ImageFormat::r8g8b8a8un;
+	if (options.tiledImage)
+		renderDesc.layout = ImageLayout::Tiled;
+	// Streamed renders never write the image, the integrators only need one to refer to
+	Image image(options.stream ? ImageDesc() : renderDesc);
 
+	// The generated scene, only built when none was loaded
 	std::vector<Material *> materials;
-	materials.reserve(arenaSize + 5);
 	std::vector<Hitable *> objects;
-	objects.reserve(arenaSize + 5);
+	Scene defaultScene;
+	if (!loadedScene)
+	{
+		int arenaDimensions[4] = { -11, 11, -11, 11 };
+		int arenaSize = (arenaDimensions[1] - arenaDimensions[0]) * (arenaDimensions[3] - arenaDimensions[2]);
 
-	materials.push_back(new Lambertian(Vec3(0.5, 0.5, 0.5)));
-	objects.push_back(new Sphere(Vec3(0, -1000, 0), 1000, *materials[0]));
+		materials.reserve(arenaSize + 5);
+		objects.reserve(arenaSize + 5);
 
-	int materialIndex = 1;
-	for (int i = arenaDimensions[0]; i < arenaDimensions[1]; i++)
-	{
-		for (int j = arenaDimensions[2]; j < arenaDimensions[3]; j++)
+		materials.push_back(new Lambertian(Vec3(0.5, 0.5, 0.5)));
+		objects.push_back(new Sphere(Vec3(0, -1000, 0), 1000, *materials[0]));
+
+		int materialIndex = 1;
+		for (int i = arenaDimensions[0]; i < arenaDimensions[1]; i++)
 		{
-			Real materialChooser = uniformRand();
-			if (materialChooser > 0.9)
-			{
-				materials.push_back(new Dielectric(1.2 + uniformRand() * 0.5));
-			}
-			else if (materialChooser > 0.6)
+			for (int j = arenaDimensions[2]; j < arenaDimensions[3]; j++)
 			{
-				materials.push_back(new Metal(Vec3(uniformRand(), uniformRand(), uniformRand()), uniformRand()));
+				Real materialChooser = uniformRand();
+				if (materialChooser > 0.9)
+				{
+					materials.push_back(new Dielectric(1.2 + uniformRand() * 0.5));
+				}
+				else if (materialChooser > 0.6)
+				{
+					materials.push_back(new Metal(Vec3(uniformRand(), uniformRand(), uniformRand()), uniformRand()));
+				}
+				else
+				{
+					materials.push_back(new Lambertian(Vec3(uniformRand(), uniformRand(), uniformRand())));
+				}
+				Vec3 spherePosition(i + uniformRand() * 2.0 - 1.0, 0.2 + uniformRand() * 0.2, j + uniformRand() * 2.0 - 1.0);
+				objects.push_back(new Sphere(spherePosition, 0.2, *materials[materialIndex++]));
 			}
-			else
-			{
-				materials.push_back(new Lambertian(Vec3(uniformRand(), uniformRand(), uniformRand())));
-			}
-			Vec3 spherePosition(i + uniformRand() * 2.0 - 1.0, 0.2 + uniformRand() * 0.2, j + uniformRand() * 2.0 - 1.0);
-			objects.push_back(new Sphere(spherePosition, 0.2, *materials[materialIndex++]));
 		}
-	}
 
-	materials.push_back(new Lambertian(Vec3(0.0, 1.0, 0.32)));
-	materials.push_back(new Metal(Vec3(0.7, 0.6, 0.5), 0));
-	materials.push_back(new Dielectric(1.5));
-	objects.push_back(new Sphere(Vec3(-4, 1, 0), 1, *materials[materialIndex++]));
-	objects.push_back(new Sphere(Vec3(4, 1, 0), 1, *materials[materialIndex++]));
-	objects.push_back(new Sphere(Vec3(0, 1, 0), 1, *materials[materialIndex++]));
+		materials.push_back(new Lambertian(Vec3(0.0, 1.0, 0.32)));
+		materials.push_back(new Metal(Vec3(0.7, 0.6, 0.5), 0));
+		materials.push_back(new Dielectric(1.5));
+		objects.push_back(new Sphere(Vec3(-4, 1, 0), 1, *materials[materialIndex++]));
+		objects.push_back(new Sphere(Vec3(4, 1, 0), 1, *materials[materialIndex++]));
+		objects.push_back(new Sphere(Vec3(0, 1, 0), 1, *materials[materialIndex++]));
 
-	Scene scene;
-	scene.setBackground(Background(Vec3(0.619, 1, 0.694), Vec3(1, 0.639, 0.619)));
-	for (Hitable *hitable : objects)
-		scene.add(*hitable);
+		defaultScene.setBackground(Background(Vec3(0.619, 1, 0.694), Vec3(1, 0.639, 0.619)));
+		for (Hitable *hitable : objects)
+			defaultScene.add(*hitable);
+		defaultScene.build();
+	}
+	const Scene &scene = loadedScene ? *loadedScene : defaultScene;
+
+	std::unique_ptr<PixelRenderer> pixelRenderer;
+	if (options.integrator == "raytrace")
+	{
+		Raytrace *raytrace = new Raytrace(scene, camera, viewport, image);
+		raytrace->setSamplesPerPixel(options.samplesPerPixel);
+		pixelRenderer.reset(raytrace);
+	}
+	else if (options.integrator == "raymarch")
+	{
+		Raymarch *raymarch = new Raymarch(scene, camera, viewport, image);
+		raymarch->setSamplesPerPixel(options.samplesPerPixel);
+		pixelRenderer.reset(raymarch);
+	}
+	else if (options.integrator == "preview")
+	{
+		pixelRenderer.reset(new Preview(scene, camera, viewport, image));
+	}
+	else if (options.integrator == "visualizer-depth")
+	{
+		pixelRenderer.reset(new RaytraceVisualizer(RaytraceVisualizerTypeDepth, scene, camera, viewport, image));
+	}
+	else if (options.integrator == "visualizer-normal")
+	{
+		pixelRenderer.reset(new RaytraceVisualizer(RaytraceVisualizerTypeNormal, scene, camera, viewport, image));
+	}
+	else if (options.integrator == "visualizer-bounces")
+	{
+		pixelRenderer.reset(new RaytraceVisualizer(RaytraceVisualizerTypeBounces, scene, camera, viewport, image));
+	}
+	else
+	{
+		std::cerr << "Unknown integrator '" << options.integrator << "'." << std::endl;
+		printUsage(argv[0]);
+		return 1;
+	}
 
-	Preview preview(scene, camera, viewport, image);
-	Raytrace raytrace(scene, camera, viewport, image);
-	raytrace.setSamplesPerPixel(samplesPerPixel);
-	FileWriterCallback finishCallback(argv[argc > 1 ? 1 : 0], image);
+	// Depth and normals are not gamma corrected, as in the layers below
+	bool visualizesUnits = options.integrator == "visualizer-depth" || options.integrator == "visualizer-normal";
+	FileWriterCallback finishCallback(options.outputFileName.c_str(), image,
+		visualizesUnits ? file::ExrValuesUnit : file::ExrValuesColour);
 	Renderer renderer;
-	// renderer.renderAsync(raytrace, RenderFunctionTiles);
-	renderer.renderAsync(preview, RenderFunctionTiles);
+	renderer.setThreadCount(options.threadCount);
+	finishCallback.setWriteEnabled(options.layers.empty() && !options.stream);
 	renderer.setFinishCallback(finishCallback);
+	renderer.setTileCostsEnabled(!options.heatmapFileName.empty());
 
-	Viewer viewer(imageDesc.width, imageDesc.height, "viewer");
-	if (!viewer.show(image))
+	file::ExrTileWriter tileWriter;
+	if (options.stream)
+	{
+		if (!tileWriter.open(options.outputFileName, imageDesc.width, imageDesc.height, renderer.getTileSize()))
+			return 1;
+		renderer.setTileSink(&tileWriter);
+	}
+
+	if (options.headless)
+	{
+		renderer.render(*pixelRenderer, RenderFunctionTiles);
+	}
+	else
+	{
+#ifdef RAYTRACER_VIEWER
+		renderer.setFrameShared(true);
+		renderer.renderAsync(*pixelRenderer, RenderFunctionTiles);
+
+		Viewer viewer(imageDesc.width, imageDesc.height, "viewer");
+		if (!viewer.show(image, &renderer.getFrameMutex()))
+			return 1;
+#endif
+		renderer.waitForFinish();
+	}
+
+	if (options.stream && !tileWriter.close())
 		return 1;
 
-	renderer.waitForFinish();
+	// Every output is attempted, any failure shows in the exit code
+	bool written = finishCallback.succeeded();
+
+	if (!options.layers.empty())
+	{
+		// Rendered after the image, each by a visualizer, and written together with it
+		std::vector<std::unique_ptr<Image>> layerImages;
+		std::vector<file::ExrLayer> layers(1, file::ExrLayer("", image));
+		Renderer layerRenderer;
+		layerRenderer.setThreadCount(options.threadCount);
+		for (const std::string &name : options.layers)
+		{
+			RaytraceVisualizerType type = RaytraceVisualizerTypeBounces;
+			if (name == "depth")
+				type = RaytraceVisualizerTypeDepth;
+			else if (name == "normal")
+				type = RaytraceVisualizerTypeNormal;
+			layerImages.emplace_back(new Image(imageDesc));
+			RaytraceVisualizer visualizer(type, scene, camera, viewport, *layerImages.back());
+			layerRenderer.render(visualizer, RenderFunctionTiles);
+
+			// Depth and bounces are grey, bounces are gamma corrected like colours
+			if (type == RaytraceVisualizerTypeNormal)
+				layers.push_back(file::ExrLayer(name, *layerImages.back(), file::ExrValuesUnit));
+			else if (type == RaytraceVisualizerTypeDepth)
+				layers.push_back(file::ExrLayer(name, *layerImages.back(), file::ExrValuesUnit, 1));
+			else
+				layers.push_back(file::ExrLayer(name, *layerImages.back(), file::ExrValuesColour, 1));
+		}
+		written = file::writeExr(options.outputFileName, layers) && written;
+	}
+
+	if (!options.heatmapFileName.empty())
+	{
+		if (options.heatmapMetric == TileCostMetricRays && !stats::RenderStats::enabled())
+			std::cerr << "Rays are only counted when built with RAYTRACER_STATS." << std::endl;
+		Image heatmap(imageDesc);
+		renderer.getTileCosts().makeHeatmap(heatmap, options.heatmapMetric, options.stream ? nullptr : &image);
+		written = file::writePpm(options.heatmapFileName, heatmap, 255) && written;
+	}
+
+	if (!options.statsFileName.empty())
+	{
+		if (!stats::RenderStats::enabled())
+			std::cerr << "Statistics are only counted when built with RAYTRACER_STATS." << std::endl;
+		written = renderer.getStats().writeJson(options.statsFileName) && written;
+	}
+
+	if (!options.traceFileName.empty())
+		written = trace::writeChromeTrace(options.traceFileName) && written;
 
 	for (Hitable *hitable : objects)
 		delete hitable;
@@ -130,5 +547,5 @@ int main(int argc, char *argv[])
 		delete material;
 	materials.clear();
 
-	return 0;
+	return written ? 0 : 1;
 }
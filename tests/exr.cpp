@@ -0,0 +1,177 @@
+#include "Common.hpp"
+
+#ifdef NDEBUG
+#undef NDEBUG
+#endif
+
+#include "Debug.hpp"
+#include "Deflate.hpp"
+#include "Exr.hpp"
+#include "Half.hpp"
+#include "Image.hpp"
+
+#include <cmath>
+#include <cstdint>
+#include <cstdio>
+#include <cstring>
+#include <fstream>
+#include <iterator>
+#include <limits>
+#include <string>
+#include <vector>
+
+std::string readFile(const std::string &fileName)
+{
+	std::ifstream file(fileName, std::ios::binary);
+	return std::string(std::istreambuf_iterator<char>(file), std::istreambuf_iterator<char>());
+}
+
+template <typename T>
+T readValue(const std::string &content, size_t offset)
+{
+	T value;
+	std::memcpy(&value, content.data() + offset, sizeof(value));
+	return value;
+}
+
+void testHalf()
+{
+	assertEqual(floatToHalf(0.0f), 0x0000);
+	assertEqual(floatToHalf(-0.0f), 0x8000);
+	assertEqual(floatToHalf(1.0f), 0x3c00);
+	assertEqual(floatToHalf(0.5f), 0x3800);
+	assertEqual(floatToHalf(-2.0f), 0xc000);
+	assertEqual(floatToHalf(65504.0f), 0x7bff);
+	assertEqual(floatToHalf(1e6f), 0x7c00);
+	assertEqual(floatToHalf(std::numeric_limits<float>::infinity()), 0x7c00);
+	assert((floatToHalf(std::numeric_limits<float>::quiet_NaN()) & 0x7fff) > 0x7c00);
+	// Smallest denormal, and ties to even on both sides of it
+	assertEqual(floatToHalf(std::ldexp(1.0f, -24)), 0x0001);
+	assertEqual(floatToHalf(std::ldexp(1.0f, -25)), 0x0000);
+	assertEqual(floatToHalf(std::ldexp(3.0f, -25)), 0x0002);
+	assertEqual(floatToHalf(1.0f + std::ldexp(1.0f, -11)), 0x3c00);
+	assertEqual(floatToHalf(1.0f + std::ldexp(3.0f, -11)), 0x3c02);
+
+	// Every half survives the round trip
+	for (uint bits = 0; bits < 0x10000; bits++)
+	{
+		uint16_t half = uint16_t(bits);
+		bool isNaN = (half & 0x7c00) == 0x7c00 && (half & 0x3ff) != 0;
+		if (!isNaN)
+			assertEqual(floatToHalf(halfToFloat(half)), half);
+	}
+	assertEqual(halfToFloat(0x3555), 0.333251953125f);
+}
+
+void testDeflate()
+{
+	const char *text = "Wikipedia";
+	assertEqual(deflate::adler32((const byte*)text, std::strlen(text)), 0x11e60398u);
+
+	std::vector<byte> data(100000);
+	for (size_t i = 0; i < data.size(); i++)
+		data[i] = byte((i / 100) % 7);
+	std::vector<byte> compressed;
+	deflate::compress(data.data(), data.size(), compressed);
+	assert(compressed.size() < data.size() / 10);
+	// zlib header, then the checksum at the end, most significant byte first
+	assertEqual(compressed[0], 0x78);
+	assertEqual((compressed[0] * 256 + compressed[1]) % 31, 0);
+	uint32_t checksum = deflate::adler32(data.data(), data.size());
+	size_t end = compressed.size();
+	assertEqual(compressed[end - 4], byte(checksum >> 24));
+	assertEqual(compressed[end - 1], byte(checksum));
+
+	compressed.clear();
+	deflate::compress(nullptr, 0, compressed);
+	assert(compressed.size() > 6);
+}
+
+void testExr()
+{
+	ImageDesc desc;
+	desc.width = 3;
+	desc.height = 2;
+	desc.format = ImageFormat::r32g32b32f;
+	Image image(desc);
+	for (int y = 0; y < 2; y++)
+	{
+		for (int x = 0; x < 3; x++)
+		{
+			float colour[3] = { float(x), float(y), float(x + y) };
+			image.store(x, y, (byte*)colour);
+		}
+	}
+
+	// Uncompressed floats, one scanline per chunk, channels sorted by name
+	file::ExrOptions options;
+	options.pixelType = file::ExrPixelTypeFloat;
+	options.compression = file::ExrCompressionNone;
+	std::vector<file::ExrLayer> layers;
+	layers.push_back(file::ExrLayer("", image, file::ExrValuesRaw));
+	layers.push_back(file::ExrLayer("depth", image, file::ExrValuesRaw, 1));
+	assert(file::writeExr("test_exr_output", layers, options));
+	std::string content = readFile("test_exr_output.exr");
+	assertEqual(readValue<uint32_t>(content, 0), 20000630u);
+	assertEqual(readValue<uint32_t>(content, 4), 2u);
+	size_t channels = content.find("channels");
+	assert(channels != std::string::npos);
+	// Each name is followed by its type, flags and sampling
+	size_t entry = channels + std::strlen("channels") + 1 + std::strlen("chlist") + 1 + 4;
+	const char *names[4] = { "B", "G", "R", "depth.Y" };
+	for (const char *name : names)
+	{
+		assertEqual(std::string(content.c_str() + entry), std::string(name));
+		entry += std::strlen(name) + 1;
+		assertEqual(readValue<int32_t>(content, entry), 2);
+		entry += 16;
+	}
+	assertEqual(content[entry], '\0');
+
+	// The first chunk is the top row, which is the last of the image
+	size_t headerEnd = content.size() - 2 * (8 + 3 * 4 * 4) - 2 * sizeof(uint64_t);
+	uint64_t firstChunk = readValue<uint64_t>(content, headerEnd);
+	assertEqual(firstChunk, uint64_t(headerEnd + 2 * sizeof(uint64_t)));
+	assertEqual(readValue<int32_t>(content, firstChunk), 0);
+	assertEqual(readValue<int32_t>(content, firstChunk + 4), 3 * 4 * 4);
+	// B of the pixels first, depth last
+	assertEqual(readValue<float>(content, firstChunk + 8), 1.0f);
+	assertEqual(readValue<float>(content, firstChunk + 8 + 2 * 4), 3.0f);
+	assertEqual(readValue<float>(content, firstChunk + 8 + 10 * 4), 1.0f);
+
+	// Flat images compress well, by scanline or by tile
+	ImageDesc largeDesc;
+	largeDesc.width = 64;
+	largeDesc.height = 64;
+	largeDesc.format = ImageFormat::r32g32b32f;
+	Image large(largeDesc);
+	size_t sizes[3];
+	for (int compression = file::ExrCompressionNone; compression <= file::ExrCompressionZip; compression++)
+	{
+		file::ExrOptions compressed;
+		compressed.compression = file::ExrCompression(compression);
+		compressed.tiled = compression == file::ExrCompressionZip;
+		compressed.tileSize = 16;
+		assert(file::writeExr("test_exr_output.exr", large, compressed));
+		sizes[compression] = readFile("test_exr_output.exr").size();
+	}
+	assert(sizes[file::ExrCompressionRle] < sizes[file::ExrCompressionNone] / 10);
+	assert(sizes[file::ExrCompressionZip] < sizes[file::ExrCompressionNone] / 10);
+
+	// Layers must have the same size
+	std::vector<file::ExrLayer> mismatched;
+	mismatched.push_back(file::ExrLayer("", image));
+	mismatched.push_back(file::ExrLayer("other", large));
+	assert(!file::writeExr("test_exr_output", mismatched));
+
+	std::remove("test_exr_output.exr");
+}
+
+int main()
+{
+	testHalf();
+	testDeflate();
+	testExr();
+
+	return 0;
+}
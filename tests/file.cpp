@@ -0,0 +1,100 @@
+#include "Common.hpp"
+
+#ifdef NDEBUG
+#undef NDEBUG
+#endif
+
+#include "Debug.hpp"
+#include "File.hpp"
+#include "Image.hpp"
+
+#include <cstdio>
+#include <cstring>
+#include <fstream>
+#include <iterator>
+#include <string>
+
+std::string readFile(const std::string &fileName)
+{
+	std::ifstream file(fileName, std::ios::binary);
+	return std::string(std::istreambuf_iterator<char>(file), std::istreambuf_iterator<char>());
+}
+
+void storeColour(Image &image, int x, int y, float r, float g, float b)
+{
+	float colour[3] = { r, g, b };
+	image.store(x, y, (byte*)colour);
+}
+
+int main()
+{
+	ImageDesc desc;
+	desc.width = 2;
+	desc.height = 2;
+	desc.format = ImageFormat::r32g32b32f;
+	Image image(desc);
+	storeColour(image, 0, 0, 0.0f, 10.0f, 20.0f);
+	storeColour(image, 1, 0, 30.0f, 40.0f, 50.0f);
+	storeColour(image, 0, 1, 255.99f, 127.995f, 1.5f);
+	storeColour(image, 1, 1, 60.0f, 70.0f, 80.0f);
+
+	// 8 bits, top row first
+	{
+		assert(file::writePpm("test_file_output", image, 255));
+		std::string content = readFile("test_file_output.ppm");
+		std::string header = "P6\n2 2\n255\n";
+		assertEqual(content.size(), header.size() + 12);
+		assert(content.compare(0, header.size(), header) == 0);
+		const unsigned char expected[12] = { 255, 127, 1, 60, 70, 80, 0, 10, 20, 30, 40, 50 };
+		assert(std::memcmp(content.data() + header.size(), expected, 12) == 0);
+	}
+
+	// The maximum is searched, above 255 samples take two big endian bytes
+	{
+		storeColour(image, 1, 1, 300.0f, 70.0f, 80.0f);
+		assert(file::writePpm("test_file_output.ppm", image));
+		std::string content = readFile("test_file_output.ppm");
+		std::string header = "P6\n2 2\n300\n";
+		assertEqual(content.size(), header.size() + 24);
+		assert(content.compare(0, header.size(), header) == 0);
+		const unsigned char *samples = (const unsigned char*)content.data() + header.size();
+		assertEqual(samples[0], 0);
+		assertEqual(samples[1], 255);
+		assertEqual(samples[6], 1);
+		assertEqual(samples[7], 300 - 256);
+	}
+
+	// Linear floats, bottom row first
+	{
+		assert(file::writePfm("test_file_output", image));
+		std::string content = readFile("test_file_output.pfm");
+		std::string header = "PF\n2 2\n-1.0\n";
+		assertEqual(content.size(), header.size() + 12 * sizeof(float));
+		assert(content.compare(0, header.size(), header) == 0);
+		float samples[12];
+		std::memcpy(samples, content.data() + header.size(), sizeof(samples));
+		assertEqualWithTolerance(samples[0], 0.0f, 1e-6f);
+		assertEqualWithTolerance(samples[1], (10.0f / 255.99f) * (10.0f / 255.99f), 1e-6f);
+		assertEqualWithTolerance(samples[6], 1.0f, 1e-6f);
+		assertEqualWithTolerance(samples[7], 0.25f, 1e-6f);
+
+		// Depths and normals are only scaled
+		assert(file::writePfm("test_file_output", image, file::ExrValuesUnit));
+		content = readFile("test_file_output.pfm");
+		std::memcpy(samples, content.data() + header.size(), sizeof(samples));
+		assertEqualWithTolerance(samples[1], 10.0f / 255.99f, 1e-6f);
+		assertEqualWithTolerance(samples[6], 1.0f, 1e-6f);
+		assertEqualWithTolerance(samples[7], 0.5f, 1e-6f);
+	}
+
+	// Integer images are not written
+	{
+		desc.format = ImageFormat::r32g32b32ui;
+		assert(!file::writePpm("test_file_output_ui", Image(desc)));
+	}
+
+	std::remove("test_file_output.ppm");
+	std::remove("test_file_output.pfm");
+
+	return 0;
+}
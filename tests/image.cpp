@@ -0,0 +1,275 @@
+#include "Common.hpp"
+
+#ifdef NDEBUG
+#undef NDEBUG
+#endif
+
+#include "Debug.hpp"
+#include "File.hpp"
+#include "Image.hpp"
+
+#include <cmath>
+#include <cstdint>
+#include <cstdio>
+#include <fstream>
+#include <iterator>
+#include <limits>
+#include <string>
+
+std::string readFile(const std::string &fileName)
+{
+	std::ifstream file(fileName, std::ios::binary);
+	return std::string(std::istreambuf_iterator<char>(file), std::istreambuf_iterator<char>());
+}
+
+ImageDesc makeDesc(uint width, uint height, ImageFormat format)
+{
+	ImageDesc desc;
+	desc.width = width;
+	desc.height = height;
+	desc.format = format;
+	return desc;
+}
+
+int main()
+{
+	// Sizes
+	{
+		Image half(makeDesc(3, 2, ImageFormat::r16g16b16a16f));
+		assertEqual(half.getChannelAmount(), 4u);
+		assertEqual(half.getPixelSizeInBytes(), 8u);
+		Image unorm(makeDesc(3, 2, ImageFormat::r8g8b8a8un));
+		assertEqual(unorm.getChannelAmount(), 4u);
+		assertEqual(unorm.getPixelSizeInBytes(), 4u);
+		Image packed(makeDesc(3, 2, ImageFormat::r11g11b10f));
+		assertEqual(packed.getChannelAmount(), 3u);
+		assertEqual(packed.getPixelSizeInBytes(), 4u);
+		Image full(makeDesc(3, 2, ImageFormat::r32g32b32f));
+		assertEqual(full.getPixelSizeInBytes(), 12u);
+
+		assert(Image::isColourFormat(ImageFormat::r11g11b10f));
+		assert(!Image::isColourFormat(ImageFormat::r32g32b32ui));
+	}
+
+	// Colours through every format
+	{
+		const float colour[3] = { 200.5f, 0.25f, 17.0f };
+		const ImageFormat formats[4] = { ImageFormat::r32g32b32f, ImageFormat::r16g16b16a16f, ImageFormat::r11g11b10f, ImageFormat::r8g8b8a8un };
+		// Relative error of the mantissas, the bytes truncate
+		const float tolerances[3] = { 1.0e-6f, 1.0f / 2048.0f, 1.0f / 64.0f };
+		for (uint i = 0; i < 4; i++)
+		{
+			Image image(makeDesc(2, 2, formats[i]));
+			image.storeColour(1, 1, colour);
+			float loaded[3];
+			image.loadColour(1, 1, loaded);
+			for (uint c = 0; c < 3; c++)
+			{
+				float expected = i == 3 ? std::floor(colour[c]) : colour[c];
+				float tolerance = i == 3 ? 1.0e-6f : colour[c] * tolerances[i];
+				assertEqualWithTolerance(loaded[c], expected, tolerance);
+			}
+			image.loadColour(0, 0, loaded);
+			assertEqual(loaded[0], 0.0f);
+		}
+	}
+
+	// r11g11b10f edge cases
+	{
+		Image image(makeDesc(1, 1, ImageFormat::r11g11b10f));
+		const float colour[3] = { -3.0f, 1.0e-6f, 1.0e9f };
+		image.storeColour(0, 0, colour);
+		float loaded[3];
+		image.loadColour(0, 0, loaded);
+		assertEqual(loaded[0], 0.0f);
+		// Smallest denormal, 2^-20 with a 6 bit mantissa
+		assertEqual(loaded[1], std::ldexp(1.0f, -20));
+		// Largest finite value, 1.96875 * 2^15 with a 5 bit mantissa
+		assertEqual(loaded[2], 64512.0f);
+
+		const float infinite[3] = { std::numeric_limits<float>::infinity(), 1.0f, 0.5f };
+		image.storeColour(0, 0, infinite);
+		image.loadColour(0, 0, loaded);
+		assert(std::isinf(loaded[0]));
+		assertEqual(loaded[1], 1.0f);
+		assertEqual(loaded[2], 0.5f);
+		const uint32_t packed = *reinterpret_cast<const uint32_t*>(image.getData());
+		assertEqual(packed >> 22, 14u << 5);
+	}
+
+	// Bulk conversion, with scale, alpha and missing channels
+	{
+		const float in[6] = { 255.99f, 128.0f, 0.0f, 1000.0f, -5.0f, 64.5f };
+		byte out[8];
+		Image::convertPixels((const byte*)in, ImageFormat::r32g32b32f, out, ImageFormat::r8g8b8a8un, 2, 0.5f);
+		const byte expected[8] = { 127, 64, 0, 255, 255, 0, 32, 255 };
+		for (uint i = 0; i < 8; i++)
+			assertEqual(uint(out[i]), uint(expected[i]));
+
+		float grey[4];
+		Image::convertPixels(out, ImageFormat::r8g8b8a8un, (byte*)grey, ImageFormat::r32f, 2);
+		assertEqual(grey[0], 127.0f);
+		assertEqual(grey[1], 255.0f);
+
+		// More pixels than one conversion block
+		Image source(makeDesc(100, 3, ImageFormat::r32g32b32f));
+		for (uint y = 0; y < 3; y++)
+		{
+			for (uint x = 0; x < 100; x++)
+			{
+				const float colour[3] = { float(x), float(y), float(x + y) };
+				source.storeColour(x, y, colour);
+			}
+		}
+		Image half(makeDesc(100, 3, ImageFormat::r16g16b16a16f));
+		source.convertTo(half);
+		Image back(makeDesc(100, 3, ImageFormat::r32g32b32f));
+		half.convertTo(back);
+		float loaded[3];
+		back.loadColour(99, 2, loaded);
+		assertEqual(loaded[0], 99.0f);
+		assertEqual(loaded[1], 2.0f);
+		assertEqual(loaded[2], 101.0f);
+
+		// Same format copies as is
+		Image copy(makeDesc(100, 3, ImageFormat::r16g16b16a16f));
+		half.convertTo(copy);
+		for (uint i = 0; i < 100 * 3 * 8; i++)
+			assert(copy.getData()[i] == half.getData()[i]);
+	}
+
+	// Rows, tiles and views
+	{
+		Image image(makeDesc(5, 4, ImageFormat::r32f));
+		ImageView<float> samples = image.view<float>();
+		assert(samples.valid());
+		assertEqual(samples.size(), size_t(20));
+		for (size_t i = 0; i < samples.size(); i++)
+			samples.data[i] = float(i);
+		assertEqual(*samples.pixel(2, 3), 17.0f);
+		assert(image.getRow(3) == (const byte*)samples.row(3));
+		assertEqual(image.getRowSizeInBytes(), 20u);
+
+		// Clipped to the image on the right and top
+		const float tile[6] = { 100.0f, 101.0f, 102.0f, 103.0f, 104.0f, 105.0f };
+		image.storeTile(4, 2, 3, 2, (const byte*)tile);
+		assertEqual(*samples.pixel(4, 2), 100.0f);
+		assertEqual(*samples.pixel(4, 3), 103.0f);
+		assertEqual(*samples.pixel(3, 3), 18.0f);
+
+		float loaded[4] = { -1.0f, -1.0f, -1.0f, -1.0f };
+		image.loadTile(3, 1, 2, 2, (byte*)loaded);
+		assertEqual(loaded[0], 8.0f);
+		assertEqual(loaded[1], 9.0f);
+		assertEqual(loaded[2], 13.0f);
+		assertEqual(loaded[3], 100.0f);
+
+		// Pixels which are not made of whole doubles
+		const Image packed(makeDesc(2, 2, ImageFormat::r8g8b8a8un));
+		assert(!packed.view<double>().valid());
+		assertEqual(packed.view<byte>().pixelStride, 4u);
+
+		// Copies own their samples
+		Image copy(image);
+		Image assigned(makeDesc(1, 1, ImageFormat::r32g32b32f));
+		assigned = image;
+		samples.data[0] = -1.0f;
+		assertEqual(copy.view<float>().data[0], 0.0f);
+		assertEqual(assigned.view<float>().data[0], 0.0f);
+		assert(assigned.getDesc() == image.getDesc());
+		assertEqual(assigned.getPixelSizeInBytes(), 4u);
+
+		// Colour tiles are converted to the image format
+		Image half(makeDesc(3, 3, ImageFormat::r16g16b16a16f));
+		const float colours[6] = { 1.0f, 2.0f, 3.0f, 4.0f, 5.0f, 6.0f };
+		half.storeColourTile(2, 1, 1, 2, colours);
+		float colour[3];
+		half.loadColour(2, 2, colour);
+		assertEqual(colour[0], 4.0f);
+		assertEqual(colour[2], 6.0f);
+	}
+
+	// Tiled layout, transparent to the accessors
+	{
+		ImageDesc desc = makeDesc(37, 21, ImageFormat::r32g32b32f);
+		desc.layout = ImageLayout::Tiled;
+		desc.blockSize = 12;
+		Image tiled(desc);
+		assertEqual(tiled.getDesc().blockSize, 16u);
+		assert(tiled.getRow(0) == nullptr);
+		assert(!tiled.view<float>().valid());
+
+		Image linear(makeDesc(37, 21, ImageFormat::r32g32b32f));
+		for (uint y = 0; y < 21; y++)
+		{
+			for (uint x = 0; x < 37; x++)
+			{
+				const float colour[3] = { float(x), float(y), float(x * y) };
+				tiled.storeColour(x, y, colour);
+				linear.storeColour(x, y, colour);
+			}
+		}
+		float loaded[3];
+		tiled.loadColour(36, 20, loaded);
+		assertEqual(loaded[2], 720.0f);
+		// Pixels of a block are next to each other
+		assertEqual(((const float*)tiled.getData())[15 * 3], 15.0f);
+		assertEqual(((const float*)tiled.getData())[16 * 3 + 1], 1.0f);
+
+		// Tiles across block boundaries
+		float tile[5 * 3 * 3];
+		tiled.loadTile(14, 15, 5, 3, (byte*)tile);
+		assertEqual(tile[(2 * 5 + 3) * 3], 17.0f);
+		assertEqual(tile[(2 * 5 + 3) * 3 + 1], 17.0f);
+		tile[(2 * 5 + 3) * 3] = -1.0f;
+		tiled.storeTile(14, 15, 5, 3, (const byte*)tile);
+		tiled.loadColour(17, 17, loaded);
+		assertEqual(loaded[0], -1.0f);
+		const float colour[3] = { 17.0f, 17.0f, 289.0f };
+		tiled.storeColourTile(17, 17, 1, 1, colour);
+
+		// Linearized on the way out
+		Image back(makeDesc(37, 21, ImageFormat::r32g32b32f));
+		tiled.convertTo(back);
+		for (uint i = 0; i < 37 * 21 * 12; i++)
+			assert(back.getData()[i] == linear.getData()[i]);
+		assert(file::writePfm("test_image_tiled", tiled));
+		assert(file::writePfm("test_image_linear", linear));
+		assert(readFile("test_image_tiled.pfm") == readFile("test_image_linear.pfm"));
+		std::remove("test_image_tiled.pfm");
+		std::remove("test_image_linear.pfm");
+
+		// Into another tiled layout and format
+		ImageDesc halfDesc = makeDesc(37, 21, ImageFormat::r16g16b16a16f);
+		halfDesc.layout = ImageLayout::Tiled;
+		halfDesc.blockSize = 8;
+		Image half(halfDesc);
+		tiled.convertTo(half);
+		half.loadColour(30, 19, loaded);
+		assertEqual(loaded[2], 570.0f);
+
+		Image copy(makeDesc(1, 1, ImageFormat::r32f));
+		copy = tiled;
+		copy.loadColour(36, 20, loaded);
+		assertEqual(loaded[2], 720.0f);
+	}
+
+	// Files are written from a float copy
+	{
+		Image full(makeDesc(2, 1, ImageFormat::r32g32b32f));
+		Image unorm(makeDesc(2, 1, ImageFormat::r8g8b8a8un));
+		const float colour[3] = { 10.0f, 20.0f, 30.0f };
+		full.storeColour(1, 0, colour);
+		unorm.storeColour(1, 0, colour);
+		assert(file::writePpm("test_image_full", full, 255));
+		assert(file::writePpm("test_image_unorm", unorm, 255));
+		assert(readFile("test_image_full.ppm") == readFile("test_image_unorm.ppm"));
+		std::remove("test_image_full.ppm");
+		std::remove("test_image_unorm.ppm");
+
+		Image integers(makeDesc(2, 1, ImageFormat::r32g32b32ui));
+		assert(!file::writePfm("test_image_integers", integers));
+	}
+
+	return 0;
+}
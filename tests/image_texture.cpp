@@ -0,0 +1,127 @@
+#include "Common.hpp"
+
+#ifdef NDEBUG
+#undef NDEBUG
+#endif
+
+#include "Debug.hpp"
+#include "File.hpp"
+#include "Hitable.hpp"
+#include "Image.hpp"
+#include "ImageTexture.hpp"
+#include "Lambertian.hpp"
+#include "Quat.hpp"
+#include "Ray.hpp"
+#include "Rect.hpp"
+#include "Sphere.hpp"
+#include "Transform.hpp"
+#include "Vec3.hpp"
+
+#include <cstdio>
+#include <fstream>
+#include <vector>
+
+int main()
+{
+	// 4 by 4 texels, red growing along x and green along y
+	std::vector<float> texels(4 * 4 * 3);
+	for (uint y = 0; y < 4; y++)
+	{
+		for (uint x = 0; x < 4; x++)
+		{
+			texels[(y * 4 + x) * 3] = float(x) * 0.25f;
+			texels[(y * 4 + x) * 3 + 1] = float(y) * 0.25f;
+			texels[(y * 4 + x) * 3 + 2] = 1.0f;
+		}
+	}
+
+	// Mip pyramid of 2 by 2 averages, stored in blocks
+	ImageTexture texture(ImageFormat::r32g32b32f);
+	texture.setTexels(texels.data(), 4, 4);
+	assertEqual(texture.getLevelAmount(), 3u);
+	assertEqual(texture.getLevel(1).getWidth(), 2u);
+	assert(texture.getLevel(0).getLayout() == ImageLayout::Tiled);
+	assertEqual(texture.getLevel(0).getDesc().blockSize, ImageTexture::blockSize);
+	float a0[3];
+	texture.getLevel(1).loadColour(1, 0, a0);
+	assertEqual(Vec3(a0[0], a0[1], a0[2]), Vec3(0.625, 0.125, 1));
+	texture.getLevel(2).loadColour(0, 0, a0);
+	assertEqual(Vec3(a0[0], a0[1], a0[2]), Vec3(0.375, 0.375, 1));
+
+	// Texel centers, bilinear in between, repeated past the edges
+	assertEqual(texture.sampleSurface(TextureCoordinates(Vec3(), 0.375, 0.625)), Vec3(0.25, 0.5, 1));
+	assertEqualWithTolerance(texture.sampleSurface(TextureCoordinates(Vec3(), 0.5, 0.625)), Vec3(0.375, 0.5, 1), 1e-6);
+	assertEqual(texture.sampleSurface(TextureCoordinates(Vec3(), 1.375, -0.375)), Vec3(0.25, 0.5, 1));
+	assertEqualWithTolerance(texture.sampleSurface(TextureCoordinates(Vec3(), 0.0, 0.125)), Vec3(0.375, 0, 1), 1e-6);
+
+	// Footprints pick the levels, a texel wide footprint is the finest one
+	assertEqual(texture.sampleSurface(TextureCoordinates(Vec3(), 0.375, 0.625, 0.25)), Vec3(0.25, 0.5, 1));
+	assertEqual(texture.sampleSurface(TextureCoordinates(Vec3(), 0.3, 0.1, 4)), Vec3(0.375, 0.375, 1));
+	Vec3 level1 = texture.sampleSurface(TextureCoordinates(Vec3(), 0.75, 0.25, 0.5));
+	assertEqual(level1, Vec3(0.625, 0.125, 1));
+	Vec3 between = texture.sampleSurface(TextureCoordinates(Vec3(), 0.75, 0.25, 0.5 * std::sqrt(2.0)));
+	assertEqualWithTolerance(between, 0.5 * (level1 + Vec3(0.375, 0.375, 1)), 1e-5);
+
+	// Files, PPM colours are gamma corrected
+	{
+		ImageDesc desc;
+		desc.width = 2;
+		desc.height = 1;
+		desc.format = ImageFormat::r32g32b32f;
+		Image image(desc);
+		float colour[3] = { 255.0f, 127.5f, 0.0f };
+		image.storeColour(1, 0, colour);
+		assert(file::writePpm("test_image_texture", image, 255));
+		assert(file::writePfm("test_image_texture", image));
+
+		ImageTexture b0;
+		assert(b0.load("test_image_texture.ppm"));
+		assertEqual(b0.getLevel(0).getWidth(), 2u);
+		b0.getLevel(0).loadColour(1, 0, a0);
+		assertEqualWithTolerance(Vec3(a0[0], a0[1], a0[2]), Vec3(1, 0.25, 0), 2e-3);
+
+		std::vector<float> b1;
+		uint width = 0;
+		uint height = 0;
+		bool linear = false;
+		assert(file::readImage("test_image_texture.pfm", b1, width, height, linear));
+		assert(linear);
+		assertEqual(width, 2u);
+		assertEqualWithTolerance(Vec3(b1[3], b1[4], b1[5]), Vec3(255.0 * 255.0, 127.5 * 127.5, 0) / (255.99 * 255.99), 1e-6);
+
+		// ASCII PPM with comments, top row first
+		std::ofstream b2("test_image_texture_ascii.ppm");
+		b2 << "P3\n# comment\n1 2\n# another\n10\n10 0 0\n0 5 0\n";
+		b2.close();
+		assert(file::readImage("test_image_texture_ascii.ppm", b1, width, height, linear));
+		assert(!linear);
+		assertEqual(height, 2u);
+		assertEqual(Vec3(b1[0], b1[1], b1[2]), Vec3(0, 0.5, 0));
+		assertEqual(Vec3(b1[3], b1[4], b1[5]), Vec3(1, 0, 0));
+
+		assert(!b0.load("test_image_texture_missing.ppm"));
+		std::remove("test_image_texture.ppm");
+		std::remove("test_image_texture.pfm");
+		std::remove("test_image_texture_ascii.ppm");
+	}
+
+	// Surface coordinates of the primitives
+	{
+		Lambertian material(Vec3(1, 1, 1));
+		Sphere sphere(Vec3(0, 0, 0), 2, material);
+		HitRecord c0;
+		Ray c1(Vec3(0, 0, 10), Vec3(0, 0, -1), 0.01);
+		assert(sphere.hit(c1, 0.001, 100, c0));
+		assertEqualWithTolerance(c0.u, Real(0.75), 1e-6);
+		assertEqualWithTolerance(c0.v, Real(0.5), 1e-6);
+		assertEqualWithTolerance(c0.uvFootprint(c1), Real(0.01 * 8 / (math::pi() * 2)), 1e-6);
+
+		Rect rect(Transform(Quat(), Vec3(0, 0, 0), 2), 2, 1, material);
+		assert(rect.hit(Ray(Vec3(1, 0.25, 5), Vec3(0, 0, -1)), 0.001, 100, c0));
+		assertEqualWithTolerance(c0.u, Real(0.75), 1e-6);
+		assertEqualWithTolerance(c0.v, Real(0.625), 1e-6);
+		assertEqualWithTolerance(c0.uvDensity, Real(0.5), 1e-6);
+	}
+
+	return 0;
+}
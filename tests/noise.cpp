@@ -0,0 +1,105 @@
+#include "Common.hpp"
+
+#ifdef NDEBUG
+#undef NDEBUG
+#endif
+
+#include "ConstantTexture.hpp"
+#include "Debug.hpp"
+#include "Noise.hpp"
+#include "NoiseTexture.hpp"
+#include "Random.hpp"
+#include "Vec3.hpp"
+
+#include <cmath>
+#include <vector>
+
+Vec3 randomPosition()
+{
+	return 20.0 * (2.0 * Vec3(uniformRand(), uniformRand(), uniformRand()) - 1.0);
+}
+
+int main()
+{
+	seedRandom(3);
+
+	// Zero on the lattice, continuous, bounded and centered in between
+	{
+		assertEqual(noise::perlin(Vec3(3, -7, 12)), Real(0));
+		Real sum = 0;
+		Real minimum = 1;
+		Real maximum = -1;
+		for (uint i = 0; i < 10000; i++)
+		{
+			Vec3 position = randomPosition();
+			Real value = noise::perlin(position);
+			sum += value;
+			minimum = math::min(minimum, value);
+			maximum = math::max(maximum, value);
+			assertEqualWithTolerance(noise::perlin(position + Vec3(1e-4, 1e-4, 1e-4)), value, 1e-3);
+		}
+		assert(minimum > -1.1 && minimum < -0.4);
+		assert(maximum < 1.1 && maximum > 0.4);
+		assertEqualWithTolerance(sum / 10000, Real(0), 0.02);
+
+		// Octaves add up, each at most half the previous one
+		Vec3 position(0.3, 1.7, -2.2);
+		Real one = noise::turbulence(position, 1);
+		assertEqualWithTolerance(one, std::fabs(noise::perlin(position)), 1e-6);
+		Real two = noise::turbulence(position, 2);
+		assertEqualWithTolerance(two - one, 0.5 * std::fabs(noise::perlin(2.0 * position)), 1e-6);
+	}
+
+	// Batches compute the same values as single positions
+	{
+		float x[noise::batchSize];
+		float y[noise::batchSize];
+		float z[noise::batchSize];
+		float values[noise::batchSize];
+		float turbulence[noise::batchSize];
+		for (uint i = 0; i < noise::batchSize; i++)
+		{
+			Vec3 position = randomPosition();
+			x[i] = float(position.x);
+			y[i] = float(position.y);
+			z[i] = float(position.z);
+		}
+		noise::perlinBatch(x, y, z, values);
+		noise::turbulenceBatch(x, y, z, 5, turbulence);
+		for (uint i = 0; i < noise::batchSize; i++)
+		{
+			Vec3 position(x[i], y[i], z[i]);
+			assertEqualWithTolerance(Real(values[i]), noise::perlin(position), 1e-5);
+			assertEqualWithTolerance(Real(turbulence[i]), noise::turbulence(position, 5), 1e-5);
+		}
+	}
+
+	// Textures sample the same one at a time and many at once, over partial batches
+	{
+		std::vector<Vec3> positions;
+		for (uint i = 0; i < 13; i++)
+			positions.push_back(randomPosition());
+		NoiseTexture a0(4, Vec3(1, 0.5, 0.25));
+		TurbulenceTexture a1(2, 6);
+		MarbleTexture a2(3, 7, Vec3(0.9, 0.9, 1));
+		ConstantTexture a3(Vec3(0.1, 0.2, 0.3));
+		const Texture *textures[4] = { &a0, &a1, &a2, &a3 };
+		for (const Texture *texture : textures)
+		{
+			std::vector<Vec3> colours(positions.size());
+			texture->sampleMany(positions.data(), uint(positions.size()), colours.data());
+			for (size_t i = 0; i < positions.size(); i++)
+			{
+				assertEqualWithTolerance(colours[i], texture->sample(positions[i]), 1e-4);
+				assert(colours[i].r >= 0);
+			}
+		}
+
+		assert(a0.sample(positions[0]).r <= 1);
+		assertEqual(a0.sample(Vec3(0.5, 0.25, 0.75)), Vec3(0.5, 0.25, 0.125));
+		Vec3 stripe = a2.sample(positions[1]);
+		assert(stripe.r <= 0.9 && stripe.b <= 1);
+	}
+
+	return 0;
+}
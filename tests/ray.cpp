@@ -20,5 +20,16 @@ int main()
 	assert(r1.direction() == normalize(Vec3(0, 0, -1)));
 	assert(r1.to(1) == Vec3());
 
+	// Offset origins end up strictly on the side the direction points to
+	Vec3 p(1000, 0.01, -3.5);
+	Vec3 n(0, 1, 0);
+	Vec3 above = offsetRayOrigin(p, n, Vec3(1, 1, 0));
+	assert(above.y > p.y && above.x == p.x && above.z == p.z);
+	Vec3 below = offsetRayOrigin(p, n, Vec3(1, -1, 0));
+	assert(below.y < p.y);
+	Ray r2 = spawnRay(p, Vec3(1, 0, 0), Vec3(1, 0, 0));
+	assert(r2.origin().x > p.x);
+	assert(r2.direction() == Vec3(1, 0, 0));
+
 	return 0;
 }
@@ -0,0 +1,130 @@
+#include "Common.hpp"
+
+#ifdef NDEBUG
+#undef NDEBUG
+#endif
+
+#include "Box.hpp"
+#include "Debug.hpp"
+#include "Instance.hpp"
+#include "Lambertian.hpp"
+#include "Quat.hpp"
+#include "Random.hpp"
+#include "Rect.hpp"
+#include "Scene.hpp"
+#include "Sphere.hpp"
+#include "Transform.hpp"
+#include "Vec3.hpp"
+
+#include <vector>
+
+Vec3 randomVec3(Real range)
+{
+	return range * (2.0 * Vec3(uniformRand(), uniformRand(), uniformRand()) - 1.0);
+}
+
+int main()
+{
+	Lambertian material(Vec3(1, 1, 1));
+	Lambertian overrideMaterial(Vec3(1, 0, 0));
+
+	// Bounds
+	BoundingBox a0;
+	assert(a0.isEmpty());
+	Sphere a1(Vec3(1, 2, 3), 2, material);
+	assert(a1.boundingBox(a0));
+	assertEqual(a0.minimum, Vec3(-1, 0, 1));
+	assertEqual(a0.maximum, Vec3(3, 4, 5));
+	Box a2(Transform(axisAngleToQuat(Vec3(0, 1, 0), math::pi() * 0.25), Vec3(), 1), Vec3(2, 2, 2), material);
+	assert(a2.boundingBox(a0));
+	assertEqualWithTolerance(a0.maximum, Vec3(sqrt(2.0), 1, sqrt(2.0)), 0.0001);
+
+	// Hierarchy against linear traversal
+	std::vector<Hitable *> objects;
+	for (uint i = 0; i < 100; i++)
+	{
+		Transform t(axisAngleToQuat(randomVec3(1), uniformRand() * 3), randomVec3(10), 0.5 + uniformRand());
+		if (i % 3 == 0)
+			objects.push_back(new Sphere(randomVec3(10), 0.2 + uniformRand(), material));
+		else if (i % 3 == 1)
+			objects.push_back(new Box(t, Vec3(1, 0.5, 2), material));
+		else
+			objects.push_back(new Rect(t, 1, 2, material));
+	}
+	Scene linearScene;
+	Scene scene;
+	for (Hitable *hitable : objects)
+	{
+		linearScene.add(*hitable);
+		scene.add(*hitable);
+	}
+	scene.build();
+
+	uint hits = 0;
+	for (uint i = 0; i < 2000; i++)
+	{
+		Ray r(randomVec3(15), randomVec3(1));
+		HitRecord linearRec;
+		HitRecord rec;
+		bool linearHit = linearScene.hit(r, 0.001, 100, linearRec);
+		assertEqual(scene.hit(r, 0.001, 100, rec), linearHit);
+		if (!linearHit)
+			continue;
+		hits++;
+		assertEqual(rec.t, linearRec.t);
+		assert(rec.hitable == linearRec.hitable);
+	}
+	assert(hits > 100);
+
+	// Instances of a shared sub-scene against the same objects placed directly
+	Scene shared;
+	Sphere b0(Vec3(1, 0, 0), 0.5, material);
+	Box b1(Transform(Quat(), Vec3(-1, 0, 0), 1), Vec3(1, 1, 1), material);
+	shared.add(b0);
+	shared.add(b1);
+	shared.build();
+
+	Transform b2(axisAngleToQuat(Vec3(0, 0, 1), math::pi() * 0.5), Vec3(0, 0, -5), 2);
+	Instance b3(shared, b2);
+	Instance b4(shared, Transform(Quat(), Vec3(0, 0, 5), 1), &overrideMaterial);
+	Sphere b5(b2.apply(Vec3(1, 0, 0)), 1.0, material);
+	Box b6(Transform(b2.rotation(), b2.apply(Vec3(-1, 0, 0)), 2), Vec3(1, 1, 1), material);
+
+	for (uint i = 0; i < 500; i++)
+	{
+		Ray r(Vec3(0, 0, 1) + randomVec3(0.5), Vec3(0, 0, -5) + randomVec3(2.5) - Vec3(0, 0, 1));
+		HitRecord instanceRec;
+		HitRecord sphereRec;
+		HitRecord boxRec;
+		bool instanceHit = b3.hit(r, 0.001, 100, instanceRec);
+		bool sphereHit = b5.hit(r, 0.001, 100, sphereRec);
+		bool boxHit = b6.hit(r, 0.001, 100, boxRec);
+		assertEqual(instanceHit, sphereHit || boxHit);
+		if (!instanceHit)
+			continue;
+		const HitRecord &expected = (sphereHit && (!boxHit || sphereRec.t < boxRec.t)) ? sphereRec : boxRec;
+		assertEqualWithTolerance(instanceRec.t, expected.t, 0.001);
+		assertEqualWithTolerance(instanceRec.normal, expected.normal, 0.001);
+		assert(instanceRec.hitable == &b0 || instanceRec.hitable == &b1);
+	}
+
+	HitRecord c0;
+	assert(b4.hit(Ray(Vec3(1, 0, 10), Vec3(0, 0, -1)), 0.001, 100, c0));
+	assert(c0.hitable == &b4 && c0.hitable->getMaterial() == &overrideMaterial);
+	assertEqualWithTolerance(c0.t, 4.5, 0.0001);
+	assertEqualWithTolerance(b3.evaluateSDF(b2.apply(Vec3(3, 0, 0))), 3.0, 0.0001);
+
+	Scene top;
+	top.add(b3);
+	top.add(b4);
+	top.build();
+	BoundingBox c1;
+	assert(top.boundingBox(c1));
+	assert(top.hit(Ray(Vec3(1, 0, 10), Vec3(0, 0, -1)), 0.001, 100, c0));
+	assert(c0.hitable == &b4);
+
+	for (Hitable *hitable : objects)
+		delete hitable;
+
+	return 0;
+}
@@ -0,0 +1,202 @@
+#include "Common.hpp"
+
+#ifdef NDEBUG
+#undef NDEBUG
+#endif
+
+#include "Box.hpp"
+#include "Debug.hpp"
+#include "Lambertian.hpp"
+#include "Metal.hpp"
+#include "Quat.hpp"
+#include "Random.hpp"
+#include "Rect.hpp"
+#include "Scene.hpp"
+#include "SceneFile.hpp"
+#include "Sphere.hpp"
+#include "Transform.hpp"
+#include "TriangleMesh.hpp"
+#include "Vec3.hpp"
+
+#include <cstdio>
+#include <fstream>
+#include <iterator>
+#include <vector>
+
+Vec3 randomVec3(Real range)
+{
+	return range * (2.0 * Vec3(uniformRand(), uniformRand(), uniformRand()) - 1.0);
+}
+
+std::vector<char> readFile(const char *fileName)
+{
+	std::ifstream file(fileName, std::ios::binary);
+	return std::vector<char>(std::istreambuf_iterator<char>(file), std::istreambuf_iterator<char>());
+}
+
+void writeFile(const char *fileName, const std::vector<char> &bytes)
+{
+	std::ofstream file(fileName, std::ios::binary | std::ios::trunc);
+	file.write(bytes.data(), bytes.size());
+}
+
+// Entry of a chunk in the table, within the bytes of a scene file
+scenefile::Chunk *findChunk(std::vector<char> &bytes, uint type)
+{
+	const scenefile::Header *header = reinterpret_cast<const scenefile::Header *>(bytes.data());
+	scenefile::Chunk *chunks = reinterpret_cast<scenefile::Chunk *>(bytes.data() + sizeof(scenefile::Header));
+	for (uint i = 0; i < header->chunkAmount; i++)
+	{
+		if (chunks[i].type == type)
+			return &chunks[i];
+	}
+	return nullptr;
+}
+
+// First record of a chunk
+template <typename T>
+T *chunkRecords(std::vector<char> &bytes, uint type)
+{
+	scenefile::Chunk *chunk = findChunk(bytes, type);
+	return chunk ? reinterpret_cast<T *>(bytes.data() + chunk->offset) : nullptr;
+}
+
+int main()
+{
+	const char *fileName = "scene_file_test.rtscene";
+
+	Lambertian material(Vec3(0.5, 0.5, 0.5));
+	Metal metal(Vec3(0.8, 0.8, 0.8), 0.1);
+
+	// Grid mesh, shared by two shapes
+	std::vector<Vec3> positions;
+	std::vector<uint> indices;
+	for (uint y = 0; y < 8; y++)
+	{
+		for (uint x = 0; x < 8; x++)
+			positions.push_back(Vec3(x, y, 0.3 * sin(Real(x + y))));
+	}
+	for (uint y = 0; y < 7; y++)
+	{
+		for (uint x = 0; x < 7; x++)
+		{
+			uint i = y * 8 + x;
+			uint quad[6] = { i, i + 1, i + 9, i, i + 9, i + 8 };
+			indices.insert(indices.end(), quad, quad + 6);
+		}
+	}
+
+	Transform meshTransform0(axisAngleToQuat(Vec3(1, 0, 0), 0.3), Vec3(-4, -4, -3), 1);
+	Transform meshTransform1(axisAngleToQuat(Vec3(0, 1, 0), 1.2), Vec3(2, -1, 4), 0.5);
+	Transform boxTransform(axisAngleToQuat(Vec3(1, 1, 0), 0.7), Vec3(3, 3, 0), 1.5);
+	Transform rectTransform(axisAngleToQuat(Vec3(0, 1, 1), 2.0), Vec3(-3, 2, 1), 2);
+
+	SceneFileWriter writer;
+	uint a0 = writer.addLambertian(Vec3(0.5, 0.5, 0.5));
+	uint a1 = writer.addMetal(Vec3(0.8, 0.8, 0.8), 0.1);
+	uint a2 = writer.addCheckerTexture(writer.addConstantTexture(Vec3(1, 1, 1)), writer.addConstantTexture(Vec3()), Vec3(2, 2, 2));
+	uint a3 = writer.addLambertian(a2);
+	uint a4 = writer.addMesh(positions, indices);
+	writer.addSphere(Vec3(0, 0, 0), 1.5, a0);
+	writer.addMeshShape(a4, meshTransform0, a1);
+	writer.addBox(boxTransform, Vec3(1, 2, 0.5), a3);
+	writer.addRect(rectTransform, 2, 3, a0);
+	writer.addMeshShape(a4, meshTransform1, a0);
+	writer.setBackground(Vec3(1, 1, 1), Vec3(0.5, 0.7, 1));
+	assert(writer.write(fileName));
+
+	Scene expected;
+	Sphere b0(Vec3(0, 0, 0), 1.5, material);
+	TriangleMesh b1(meshTransform0, positions, indices, metal);
+	Box b2(boxTransform, Vec3(1, 2, 0.5), material);
+	Rect b3(rectTransform, 2, 3, material);
+	TriangleMesh b4(meshTransform1, positions, indices, material);
+	expected.add(b0);
+	expected.add(b1);
+	expected.add(b2);
+	expected.add(b3);
+	expected.add(b4);
+	expected.build();
+
+	SceneFile sceneFile;
+	assert(sceneFile.load(fileName));
+	const Scene &loaded = sceneFile.getScene();
+	assertEqual(loaded.size(), 5u);
+	assertEqual(loaded.background().sample(Vec3(0, 1, 0)), Vec3(0.5, 0.7, 1));
+
+	BoundingBox c0;
+	BoundingBox c1;
+	assert(loaded.boundingBox(c0));
+	assert(expected.boundingBox(c1));
+	assertEqualWithTolerance(c0.minimum, c1.minimum, 0.0001);
+	assertEqualWithTolerance(c0.maximum, c1.maximum, 0.0001);
+
+	uint hits = 0;
+	for (uint i = 0; i < 2000; i++)
+	{
+		Ray r(randomVec3(10), randomVec3(1));
+		HitRecord loadedRec;
+		HitRecord expectedRec;
+		bool expectedHit = expected.hit(r, 0.001, 100, expectedRec);
+		assertEqual(loaded.hit(r, 0.001, 100, loadedRec), expectedHit);
+		if (!expectedHit)
+			continue;
+		hits++;
+		assertEqualWithTolerance(loadedRec.t, expectedRec.t, 0.0001);
+		assertEqualWithTolerance(loadedRec.normal, expectedRec.normal, 0.0001);
+	}
+	assert(hits > 100);
+
+	Vec3 d0(0.5, 0.5, 2);
+	assertEqualWithTolerance(loaded.evaluateSDF(d0), expected.evaluateSDF(d0), 0.0001);
+
+	// Offsets out of bounds, also when they wrap around, indices out of bounds, broken hierarchies and unknown
+	// types are rejected before anything reads them
+	const std::vector<char> original = readFile(fileName);
+	for (uint i = 0; i < 11; i++)
+	{
+		std::vector<char> bytes = original;
+		BvhNode *nodes = chunkRecords<BvhNode>(bytes, scenefile::ChunkTypeSceneBvhNodes);
+		uint *references = chunkRecords<uint>(bytes, scenefile::ChunkTypeSceneBvhReferences);
+		scenefile::MeshRecord *mesh = chunkRecords<scenefile::MeshRecord>(bytes, scenefile::ChunkTypeMeshes);
+		BvhNode *meshNodes = reinterpret_cast<BvhNode *>(bytes.data() + mesh->bvhNodes);
+		uint *meshIndices = reinterpret_cast<uint *>(bytes.data() + mesh->indices);
+		assertEqual(nodes[0].count, 0u);
+		assertEqual(meshNodes[0].count, 0u);
+		BvhNode *leaf = &nodes[1];
+		while (leaf->count == 0)
+			leaf++;
+		switch (i)
+		{
+			case 0: nodes[0].offset = 1000; break;
+			case 1: nodes[0].offset = 0; break;
+			case 2: leaf->count = 6; break;
+			case 3: references[4] = 5; break;
+			case 4: meshIndices[7] = 64; break;
+			case 5: meshNodes[0].offset = 0; break;
+			case 6: findChunk(bytes, scenefile::ChunkTypeMeshes)->offset = ~uint64_t(0) - 15; break;
+			case 7: findChunk(bytes, scenefile::ChunkTypeMeshes)->offset += 4; break;
+			case 8: mesh->positions = ~uint64_t(0) - 15; break;
+			case 9: chunkRecords<scenefile::TextureRecord>(bytes, scenefile::ChunkTypeTextures)[0].type = 7; break;
+			default: chunkRecords<scenefile::MaterialRecord>(bytes, scenefile::ChunkTypeMaterials)[1].type = 7; break;
+		}
+		writeFile(fileName, bytes);
+		assert(!sceneFile.load(fileName));
+		assertEqual(sceneFile.getScene().size(), 0u);
+	}
+	writeFile(fileName, original);
+	assert(sceneFile.load(fileName));
+
+	// Corrupted files are rejected
+	{
+		std::fstream file(fileName, std::ios::in | std::ios::out | std::ios::binary);
+		file.seekp(0);
+		file.put('X');
+	}
+	assert(!sceneFile.load(fileName));
+	assertEqual(sceneFile.getScene().size(), 0u);
+
+	std::remove(fileName);
+
+	return 0;
+}
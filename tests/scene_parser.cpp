@@ -0,0 +1,120 @@
+#include "Common.hpp"
+
+#ifdef NDEBUG
+#undef NDEBUG
+#endif
+
+#include "Box.hpp"
+#include "Debug.hpp"
+#include "Lambertian.hpp"
+#include "Quat.hpp"
+#include "Random.hpp"
+#include "Rect.hpp"
+#include "Scene.hpp"
+#include "SceneParser.hpp"
+#include "Sphere.hpp"
+#include "Transform.hpp"
+#include "Vec3.hpp"
+
+#include <sstream>
+
+Vec3 randomVec3(Real range)
+{
+	return range * (2.0 * Vec3(uniformRand(), uniformRand(), uniformRand()) - 1.0);
+}
+
+int main()
+{
+	std::istringstream a0(
+		"# Test scene\n"
+		"resolution 320 200\n"
+		"camera 0 1 10  0 0 0  0 1 0  30 0.1 8\n"
+		"background 1 1 1  0.5 0.7 1.0\n"
+		"\n"
+		"texture white constant 0.9 0.9 0.9\n"
+		"texture black constant 0.1 0.1 0.1\n"
+		"texture checks checker white black 2 2 2\n"
+		"material ground lambertian checks   # textured\n"
+		"material red lambertian 0.8 0.1 0.1\n"
+		"material mirror metal 0.8 0.8 0.8 0.05\n"
+		"material glass dielectric 1.5\n"
+		"material lamp light 4 4 4\n"
+		"sphere 0 -1000 0 1000 ground\n"
+		"sphere -2 1 0 1 glass\n"
+		"sphere 2 1 0 1 mirror\n"
+		"box 0.9238795 0 0.3826834 0  0 0.5 2  1  1 1 1 red\n"
+		"rect 0.7071068 0.7071068 0 0  0 4 0  1  2 2 lamp\n");
+
+	SceneParser parser;
+	assert(parser.parse(a0));
+	const Scene &scene = parser.getScene();
+	assertEqual(scene.size(), 5u);
+	assertEqual(parser.getViewport().width(), 320u);
+	assertEqual(parser.getViewport().height(), 200u);
+	assert(parser.hasCamera());
+	assertEqual(parser.getCameraParameters().position, Vec3(0, 1, 10));
+	assertEqual(parser.getCameraParameters().focusDistance, Real(8));
+	assertEqual(scene.background().sample(Vec3(0, -1, 0)), Vec3(1, 1, 1));
+
+	// Same scene built in code
+	Lambertian material(Vec3(1, 1, 1));
+	Sphere b0(Vec3(0, -1000, 0), 1000, material);
+	Sphere b1(Vec3(-2, 1, 0), 1, material);
+	Sphere b2(Vec3(2, 1, 0), 1, material);
+	Box b3(Transform(axisAngleToQuat(Vec3(0, 1, 0), math::pi() * 0.25), Vec3(0, 0.5, 2), 1), Vec3(1, 1, 1), material);
+	Rect b4(Transform(axisAngleToQuat(Vec3(1, 0, 0), math::pi() * 0.5), Vec3(0, 4, 0), 1), 2, 2, material);
+	Scene expected;
+	expected.add(b0);
+	expected.add(b1);
+	expected.add(b2);
+	expected.add(b3);
+	expected.add(b4);
+
+	uint hits = 0;
+	for (uint i = 0; i < 1000; i++)
+	{
+		Ray r(randomVec3(5) + Vec3(0, 5, 0), randomVec3(1));
+		HitRecord parsedRec;
+		HitRecord expectedRec;
+		bool expectedHit = expected.hit(r, 0.001, 100, expectedRec);
+		assertEqual(scene.hit(r, 0.001, 100, parsedRec), expectedHit);
+		if (!expectedHit)
+			continue;
+		hits++;
+		assertEqualWithTolerance(parsedRec.t, expectedRec.t, 0.001);
+	}
+	assert(hits > 100);
+
+	Vec3 c0(0, 1, 0);
+	HitRecord c1;
+	assert(scene.hit(Ray(Vec3(-2, 5, 0), Vec3(0, -1, 0)), 0.001, 100, c1));
+	Vec3 c2;
+	Ray c3;
+	assert(c1.hitable->getMaterial()->scatter(Ray(Vec3(-2, 5, 0), Vec3(0, -1, 0)), c1, c2, c3));
+	assertEqual(c2, Vec3(1, 1, 1));
+
+	// Errors are reported and leave an empty scene
+	std::istringstream d0("material a lambertian 1 1 1\nsphere 0 0 0 1 b\n");
+	assert(!parser.parse(d0));
+	assertEqual(parser.getScene().size(), 0u);
+	std::istringstream d1("sphere 0 0 0\n");
+	assert(!parser.parse(d1));
+	std::istringstream d2("material a metal 1 1 1 0.5 2\n");
+	assert(!parser.parse(d2));
+	std::istringstream d3("teapot\n");
+	assert(!parser.parse(d3));
+	std::istringstream d4("material a light 1 1 1\nmaterial a light 2 2 2\n");
+	assert(!parser.parse(d4));
+	std::istringstream d5("texture a image test_scene_parser_missing.ppm\n");
+	assert(!parser.parse(d5));
+	std::istringstream d6("texture a marble 4 0\n");
+	assert(!parser.parse(d6));
+
+	// Procedural textures
+	std::istringstream e0("texture a noise 4\ntexture b turbulence 2 5 0.5 0.5 0.5\ntexture c marble 1 7\n"
+		"material m lambertian c\nsphere 0 0 0 1 m\n");
+	assert(parser.parse(e0));
+	assertEqual(parser.getScene().size(), 1u);
+
+	return 0;
+}
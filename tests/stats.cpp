@@ -0,0 +1,99 @@
+#include "Common.hpp"
+
+#ifdef NDEBUG
+#undef NDEBUG
+#endif
+
+#include "Camera.hpp"
+#include "Debug.hpp"
+#include "Image.hpp"
+#include "Instance.hpp"
+#include "Lambertian.hpp"
+#include "RaytraceVisualizer.hpp"
+#include "Renderer.hpp"
+#include "Scene.hpp"
+#include "Sphere.hpp"
+#include "Stats.hpp"
+#include "Transform.hpp"
+
+#include <sstream>
+#include <string>
+#include <thread>
+
+int main()
+{
+	// Counts move from each thread to its slot, then are merged
+	stats::RenderStats renderStats;
+	renderStats.begin(2);
+	stats::threadCounters().reset();
+	stats::threadCounters().values[stats::Rays] += 10;
+	stats::threadCounters().maxTileNanoseconds = 5;
+	renderStats.collect(0);
+	assertEqual(stats::threadCounters().values[stats::Rays], 0u);
+
+	std::thread worker([&renderStats]()
+	{
+		stats::threadCounters().values[stats::Rays] += 3;
+		stats::threadCounters().values[stats::Bounces] += 2;
+		stats::threadCounters().maxTileNanoseconds = 7;
+		renderStats.collect(1);
+	});
+	worker.join();
+
+	stats::threadCounters().values[stats::Rays] += 1;
+	renderStats.collect(0);
+	renderStats.end(1.5);
+
+	assertEqual(renderStats.getThreadAmount(), 2u);
+	assertEqual(renderStats.getThread(0).values[stats::Rays], 11u);
+	assertEqual(renderStats.getThread(1).values[stats::Rays], 3u);
+	assertEqual(renderStats.getTotal().values[stats::Rays], 14u);
+	assertEqual(renderStats.getTotal().values[stats::Bounces], 2u);
+	assertEqual(renderStats.getTotal().maxTileNanoseconds, 7u);
+	assertEqual(renderStats.getSeconds(), 1.5);
+
+	// Slots of different threads never share a cache line
+	const char *slot0 = reinterpret_cast<const char *>(&renderStats.getThread(0));
+	const char *slot1 = reinterpret_cast<const char *>(&renderStats.getThread(1));
+	assert(size_t(slot1 - slot0) >= sizeof(stats::Counters) + 64);
+
+	std::ostringstream a0;
+	renderStats.writeJson(a0);
+	std::string a1 = a0.str();
+	assert(a1.find("\"rays\": 14") != std::string::npos);
+	assert(a1.find("\"maxTileNanoseconds\": 7") != std::string::npos);
+	assert(a1.find("\"threads\": [") != std::string::npos);
+
+	// A new render starts from zero
+	renderStats.begin(1);
+	renderStats.end(0.0);
+	assertEqual(renderStats.getTotal().values[stats::Rays], 0u);
+
+	// Integrators count their rays once, not again in the sub-scenes of instances
+	{
+		Lambertian material(Vec3(0.5, 0.5, 0.5));
+		Sphere sphere(Vec3(), 1, material);
+		Scene shared;
+		shared.add(sphere);
+		shared.build();
+		Instance instance(shared, Transform(Quat(), Vec3(0, 0, -5), 1));
+		Scene scene;
+		scene.add(instance);
+		scene.build();
+
+		Viewport viewport(4, 4);
+		Camera camera(Vec3(), Vec3(0, 0, -1), Vec3(0, 1, 0), 20, viewport, 0, 1);
+		ImageDesc desc;
+		desc.width = 4;
+		desc.height = 4;
+		desc.format = ImageFormat::r32g32b32f;
+		Image image(desc);
+		RaytraceVisualizer depth(RaytraceVisualizerTypeDepth, scene, camera, viewport, image);
+		Renderer renderer;
+		renderer.setThreadCount(2);
+		renderer.render(depth);
+		assertEqual(renderer.getStats().getTotal().values[stats::Rays], (stats::RenderStats::enabled() ? 16u : 0u));
+	}
+
+	return 0;
+}
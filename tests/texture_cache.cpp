@@ -0,0 +1,183 @@
+#include "Common.hpp"
+
+#ifdef NDEBUG
+#undef NDEBUG
+#endif
+
+#include "Debug.hpp"
+#include "File.hpp"
+#include "Image.hpp"
+#include "ImageTexture.hpp"
+#include "TextureCache.hpp"
+#include "Vec3.hpp"
+
+#include <cmath>
+#include <cstdio>
+#include <thread>
+#include <vector>
+
+ImageDesc makeDesc(uint width, uint height, ImageFormat format)
+{
+	ImageDesc desc;
+	desc.width = width;
+	desc.height = height;
+	desc.format = format;
+	return desc;
+}
+
+// Compares the samples of both textures over the levels
+bool sameSamples(const ImageTexture &resident, const ImageTexture &cached, uint seed)
+{
+	for (uint i = 0; i < 400; i++)
+	{
+		uint n = (i + seed) * 2654435761u;
+		Real u = Real(n % 1000) / 317;
+		Real v = Real((n / 1000) % 1000) / 411;
+		Real footprint = Real(i % 9) / 64;
+		TextureCoordinates coordinates(Vec3(), u, v, footprint);
+		if (resident.sampleSurface(coordinates) != cached.sampleSurface(coordinates))
+			return false;
+	}
+	return true;
+}
+
+int main()
+{
+	// Colours as the integrators store them
+	Image image(makeDesc(100, 70, ImageFormat::r32g32b32f));
+	for (uint y = 0; y < 70; y++)
+	{
+		for (uint x = 0; x < 100; x++)
+		{
+			const float colour[3] = { float(x) * 2.5f, float(y) * 3.5f, float((x * y) % 256) };
+			image.storeColour(x, y, colour);
+		}
+	}
+	assert(file::writePfm("test_texture_cache", image));
+	assert(file::writePpm("test_texture_cache", image, 255));
+
+	// Regions read the same samples as whole files
+	{
+		std::vector<float> whole;
+		uint width = 0;
+		uint height = 0;
+		bool linear = false;
+		const char *names[2] = { "test_texture_cache.pfm", "test_texture_cache.ppm" };
+		for (uint i = 0; i < 2; i++)
+		{
+			assert(file::readImage(names[i], whole, width, height, linear));
+			file::ImageFileInfo info;
+			assert(file::readImageInfo(names[i], info));
+			assertEqual(info.width, 100u);
+			assert(info.binary);
+			assertEqual(info.linear, i == 0);
+			std::vector<float> region(7 * 5 * 3);
+			assert(file::readImageRegion(names[i], info, 90, 60, 7, 5, region.data()));
+			for (uint y = 0; y < 5; y++)
+			{
+				for (uint x = 0; x < 7 * 3; x++)
+					assertEqual(region[y * 7 * 3 + x], whole[((60 + y) * 100 + 90) * 3 + x]);
+			}
+			assert(!file::readImageRegion(names[i], info, 95, 0, 7, 1, region.data()));
+		}
+	}
+
+	// Opened textures sample like loaded ones, float tiles for exact comparisons
+	{
+		TextureCache cache(size_t(64) << 20, ImageFormat::r32g32b32f);
+		const char *names[2] = { "test_texture_cache.pfm", "test_texture_cache.ppm" };
+		for (uint i = 0; i < 2; i++)
+		{
+			ImageTexture resident(ImageFormat::r32g32b32f);
+			assert(resident.load(names[i]));
+			ImageTexture cached;
+			assert(cached.open(names[i], cache));
+			assert(cached.isCached());
+			assertEqual(cached.getLevelAmount(), resident.getLevelAmount());
+			assertEqual(cached.getLevelWidth(3), 12u);
+			assertEqual(cached.getLevelHeight(6), 1u);
+			assert(sameSamples(resident, cached, i));
+		}
+		assertEqual(cache.addFile("test_texture_cache.pfm"), TextureCache::TextureId(0));
+		assertEqual(cache.addFile("test_texture_cache_missing.pfm"), TextureCache::invalidTexture);
+		assert(cache.getLoadAmount() > 0);
+		assertEqual(cache.getEvictionAmount(), uint64_t(0));
+
+		// Nothing resident after a clear, the samples are loaded again
+		cache.clear();
+		assertEqual(cache.getMemoryUsage(), size_t(0));
+		ImageTexture resident(ImageFormat::r32g32b32f);
+		assert(resident.load("test_texture_cache.pfm"));
+		ImageTexture cached;
+		assert(cached.open("test_texture_cache.pfm", cache));
+		assert(sameSamples(resident, cached, 7));
+		assert(cache.getMemoryUsage() > 0);
+	}
+
+	// Under a memory limit of about 3 tiles, from several threads
+	{
+		const size_t limit = 3 * 32 * 32 * 12 + 1024;
+		TextureCache cache(limit, ImageFormat::r32g32b32f);
+		ImageTexture resident(ImageFormat::r32g32b32f);
+		assert(resident.load("test_texture_cache.pfm"));
+		ImageTexture cached;
+		assert(cached.open("test_texture_cache.pfm", cache));
+
+		std::vector<std::thread> threads;
+		bool same[4] = {};
+		for (uint t = 0; t < 4; t++)
+			threads.emplace_back([&, t]() { same[t] = sameSamples(resident, cached, t * 1000); });
+		for (std::thread &thread : threads)
+			thread.join();
+		for (uint t = 0; t < 4; t++)
+			assert(same[t]);
+		assert(cache.getMemoryUsage() <= limit);
+		assert(cache.getEvictionAmount() > 0);
+
+		cache.setMemoryLimit(0);
+		assertEqual(cache.getMemoryUsage(), size_t(0));
+		assert(sameSamples(resident, cached, 5));
+	}
+
+	// Coarse levels under a limit below the texture size are loaded once each, not rebuilt from level 0
+	{
+		Image large(makeDesc(512, 512, ImageFormat::r32g32b32f));
+		for (uint y = 0; y < 512; y++)
+		{
+			for (uint x = 0; x < 512; x++)
+			{
+				const float colour[3] = { float(x % 37), float(y % 23), float((x ^ y) % 64) };
+				large.storeColour(x, y, colour);
+			}
+		}
+		assert(file::writePfm("test_texture_cache_large", large));
+
+		const uint levelZeroTiles = (512 / 32) * (512 / 32);
+		const size_t limit = 16 * 32 * 32 * 12 + 1024;
+		TextureCache cache(limit, ImageFormat::r32g32b32f);
+		ImageTexture resident(ImageFormat::r32g32b32f);
+		assert(resident.load("test_texture_cache_large.pfm"));
+		ImageTexture cached;
+		assert(cached.open("test_texture_cache_large.pfm", cache));
+		for (uint i = 0; i < 200; i++)
+		{
+			uint n = i * 2654435761u;
+			Real footprint = Real(4u << (i % 7)) / 512;
+			TextureCoordinates coordinates(Vec3(), Real(n % 1000) / 1000, Real((n / 1000) % 1000) / 1000, footprint);
+			assertEqual(cached.sampleSurface(coordinates), resident.sampleSurface(coordinates));
+		}
+		assert(cache.getLoadAmount() <= levelZeroTiles * 4 / 3);
+		assert(cache.getMemoryUsage() <= limit);
+
+		std::remove("test_texture_cache_large.pfm");
+	}
+
+	// Scenes use the global cache
+	assert(ImageTexture().open("test_texture_cache.ppm"));
+	assert(!ImageTexture().open("test_texture_cache_missing.ppm"));
+
+	std::remove("test_texture_cache.pfm");
+	std::remove("test_texture_cache.ppm");
+
+	return 0;
+}
@@ -0,0 +1,99 @@
+#include "Common.hpp"
+
+#ifdef NDEBUG
+#undef NDEBUG
+#endif
+
+#include "CheckerTexture.hpp"
+#include "ConstantTexture.hpp"
+#include "Debug.hpp"
+#include "Hitable.hpp"
+#include "Lambertian.hpp"
+#include "NoiseTexture.hpp"
+#include "Random.hpp"
+#include "Ray.hpp"
+#include "TextureProgram.hpp"
+#include "Vec3.hpp"
+
+#include <cmath>
+
+// Not known to the programs, sampled through its virtual functions
+class GradientTexture : public Texture
+{
+public:
+	virtual Vec3 sample(const Vec3& position) const override { return Vec3(position.x, 0, 0); }
+	virtual Vec3 sampleSurface(const TextureCoordinates &coordinates) const override { return Vec3(coordinates.u, coordinates.v, 1); }
+};
+
+Vec3 randomPosition()
+{
+	return 10.0 * (2.0 * Vec3(uniformRand(), uniformRand(), uniformRand()) - 1.0);
+}
+
+int main()
+{
+	seedRandom(5);
+
+	// Checkers select like the product of sines, away from its zeros
+	{
+		Vec3 frequency(2, 3.5, 0.7);
+		for (uint i = 0; i < 10000; i++)
+		{
+			Vec3 p = randomPosition();
+			Real product = std::sin(frequency.x * p.x) * std::sin(frequency.y * p.y) * std::sin(frequency.z * p.z);
+			if (std::fabs(product) > 1e-6)
+				assertEqual(CheckerTexture::selectsFirst(frequency / math::pi(), p), (product > 0));
+		}
+
+		// The product of a zero frequency is 0, never negative
+		for (uint i = 0; i < 100; i++)
+		{
+			Vec3 p = randomPosition();
+			assert(CheckerTexture::selectsFirst(Vec3(0, 3.5, 0.7) / math::pi(), p));
+			assert(CheckerTexture::selectsFirst(Vec3(2, 0, 0) / math::pi(), p));
+		}
+	}
+
+	// Nested checkers over every kind of leaf, one of them used twice
+	ConstantTexture white(Vec3(1, 1, 1));
+	ConstantTexture black(Vec3(0, 0, 0));
+	NoiseTexture noise(3, Vec3(1, 0.5, 0.5));
+	MarbleTexture marble(2, 5);
+	TurbulenceTexture turbulence(1, 4);
+	GradientTexture gradient;
+	CheckerTexture a0(white, black, Vec3(4, 4, 4));
+	CheckerTexture a1(a0, noise, Vec3(1, 2, 3));
+	CheckerTexture a2(marble, a0, Vec3(0.5, 0.5, 0.5));
+	CheckerTexture a3(turbulence, gradient);
+	CheckerTexture a4(a1, a2, Vec3(0.25, 1, 0.25));
+	CheckerTexture root(a4, a3, Vec3(0.1, 0.1, 0.1));
+
+	TextureProgram program(root);
+	// 6 checkers and 6 leaves, a0 and its leaves only once
+	assertEqual(program.getNodeAmount(), 12u);
+	assert(program.getNode(0).op == TextureOp::Checker);
+	for (uint i = 0; i < 10000; i++)
+	{
+		TextureCoordinates coordinates(randomPosition(), uniformRand(), uniformRand());
+		assertEqual(program.evaluate(coordinates), root.sampleSurface(coordinates));
+	}
+
+	// Single leaves and nothing
+	assertEqual(TextureProgram(white).evaluate(TextureCoordinates()), Vec3(1, 1, 1));
+	assertEqual(TextureProgram(gradient).evaluate(TextureCoordinates(Vec3(), 0.25, 0.5)), Vec3(0.25, 0.5, 1));
+	assertEqual(TextureProgram().evaluate(TextureCoordinates()), Vec3(0, 0, 0));
+
+	// Materials scatter with the compiled texture
+	{
+		Lambertian material(root);
+		HitRecord rec;
+		rec.point = Vec3(1.3, -0.2, 4.1);
+		rec.normal = Vec3(0, 1, 0);
+		Vec3 attenuation;
+		Ray scattered;
+		assert(material.scatter(Ray(Vec3(0, 5, 0), Vec3(0, -1, 0)), rec, attenuation, scattered));
+		assertEqual(attenuation, root.sampleSurface(TextureCoordinates(rec.point, 0, 0)));
+	}
+
+	return 0;
+}
@@ -0,0 +1,100 @@
+#include "Common.hpp"
+
+#ifdef NDEBUG
+#undef NDEBUG
+#endif
+
+#include "Debug.hpp"
+#include "Image.hpp"
+#include "PixelRenderer.hpp"
+#include "Renderer.hpp"
+#include "TileBuffer.hpp"
+#include "Vec3.hpp"
+#include "Viewport.hpp"
+
+// Colours each pixel with its coordinates, and reports as many samples as the column
+class StateRenderer : public PixelRenderer
+{
+public:
+	StateRenderer(const Viewport &vp, Image *img = nullptr) : PixelRenderer(vp, img) {}
+
+	virtual Vec3 shadePixel(uint col, uint row) const override { return Vec3(Real(col), Real(row), 1); }
+
+	virtual Vec3 shadePixelWithState(uint col, uint row, PixelState &state) const override
+	{
+		state.samples = col;
+		state.variance = float(row) * 0.5f;
+		return shadePixel(col, row);
+	}
+};
+
+ImageDesc makeDesc(uint width, uint height, ImageFormat format)
+{
+	ImageDesc desc;
+	desc.width = width;
+	desc.height = height;
+	desc.format = format;
+	return desc;
+}
+
+int main()
+{
+	Viewport viewport(150, 100);
+
+	// A tile is shaded on its own and committed where it belongs
+	{
+		Image image(makeDesc(150, 100, ImageFormat::r32g32b32f));
+		StateRenderer renderer(viewport);
+		TileBuffer tile;
+		tile.reset(64, 64, 3, 2, false);
+		tile.shade(renderer);
+		const float *colours = tile.getColours();
+		assertEqual(Vec3(colours[15], colours[16], colours[17]), Vec3(66, 65, 1));
+
+		tile.commit(&image, nullptr, nullptr);
+		float a0[3];
+		image.loadColour(66, 65, a0);
+		assertEqual(Vec3(a0[0], a0[1], a0[2]), Vec3(66, 65, 1));
+		image.loadColour(67, 65, a0);
+		assertEqual(Vec3(a0[0], a0[1], a0[2]), Vec3(0, 0, 0));
+	}
+
+	// Renders keep the pixel states when given images for them
+	{
+		Image image(makeDesc(150, 100, ImageFormat::r16g16b16a16f));
+		Image samples(makeDesc(150, 100, ImageFormat::r32ui));
+		Image variances(makeDesc(150, 100, ImageFormat::r32f));
+		StateRenderer b0(viewport, &image);
+		Renderer renderer;
+		renderer.setThreadCount(3);
+		renderer.setPixelStateImages(&samples, &variances);
+		renderer.render(b0);
+
+		ImageView<const uint> b1 = static_cast<const Image&>(samples).view<uint>();
+		ImageView<const float> b2 = static_cast<const Image&>(variances).view<float>();
+		for (uint row = 0; row < 100; row++)
+		{
+			for (uint col = 0; col < 150; col++)
+			{
+				assertEqual(*b1.pixel(col, row), col);
+				assertEqual(*b2.pixel(col, row), float(row) * 0.5f);
+			}
+		}
+		float b3[3];
+		image.loadColour(149, 99, b3);
+		assertEqual(Vec3(b3[0], b3[1], b3[2]), Vec3(149, 99, 1));
+
+		// Pixel renderers without state report one sample without variance
+		class Plain : public PixelRenderer
+		{
+		public:
+			Plain(const Viewport &vp) : PixelRenderer(vp) {}
+			virtual Vec3 shadePixel(uint, uint) const override { return Vec3(); }
+		};
+		renderer.render(Plain(viewport));
+		assertEqual(*b1.pixel(149, 99), 1u);
+		assertEqual(*b2.pixel(149, 99), 0.0f);
+	}
+
+	return 0;
+}
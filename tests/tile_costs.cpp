@@ -0,0 +1,75 @@
+#include "Common.hpp"
+
+#ifdef NDEBUG
+#undef NDEBUG
+#endif
+
+#include "Debug.hpp"
+#include "Image.hpp"
+#include "PixelRenderer.hpp"
+#include "Renderer.hpp"
+#include "TileCosts.hpp"
+#include "Vec3.hpp"
+#include "Viewport.hpp"
+
+#include <atomic>
+
+// Counts the pixels it is asked to render
+class CountingRenderer : public PixelRenderer
+{
+public:
+	mutable std::atomic<uint> pixels {0};
+
+	CountingRenderer(const Viewport &vp) : PixelRenderer(vp) {}
+
+	virtual Vec3 shadePixel(uint col, uint row) const override
+	{
+		pixels++;
+		return Vec3();
+	}
+};
+
+int main()
+{
+	TileCosts costs;
+	costs.reset(100, 70, 32);
+	assertEqual(costs.getTilesX(), 4u);
+	assertEqual(costs.getTilesY(), 3u);
+	costs.record(0, 0, 10, 1);
+	costs.record(3, 2, 40, 4);
+	costs.record(1, 2, 20, 8);
+	assertEqual(costs.getMaximum(TileCostMetricTime), 40u);
+	assertEqual(costs.getMaximum(TileCostMetricRays), 8u);
+	assertEqual(costs.getValue(1, 2, TileCostMetricRays), 8u);
+
+	// Pixels take the colour of their tile, relative to the most expensive one
+	ImageDesc desc;
+	desc.width = 100;
+	desc.height = 70;
+	desc.format = ImageFormat::r32g32b32f;
+	Image heatmap(desc);
+	costs.makeHeatmap(heatmap, TileCostMetricTime);
+	float a0[3];
+	heatmap.load(99, 69, (byte*)a0);
+	assertEqualWithTolerance(Vec3(a0[0], a0[1], a0[2]), 255.99 * heatColour(1), 0.001);
+	heatmap.load(5, 5, (byte*)a0);
+	assertEqualWithTolerance(Vec3(a0[0], a0[1], a0[2]), 255.99 * heatColour(0.25), 0.001);
+	heatmap.load(40, 40, (byte*)a0);
+	assertEqualWithTolerance(Vec3(a0[0], a0[1], a0[2]), Vec3(0, 0, 0), 0.001);
+	assertEqual(heatColour(0), Vec3(0, 0, 0));
+	assertEqual(heatColour(1), Vec3(1, 1, 1));
+
+	// Every tile of a render is recorded
+	Viewport b0(150, 100);
+	CountingRenderer b1(b0);
+	Renderer b2;
+	b2.setThreadCount(2);
+	b2.setTileCostsEnabled(true);
+	b2.render(b1);
+	assertEqual(b1.pixels.load(), 150u * 100u);
+	const TileCosts &b3 = b2.getTileCosts();
+	assert(b3.getTilesX() * b3.getTileSize() >= 150u);
+	assert(b3.getTilesY() * b3.getTileSize() >= 100u);
+
+	return 0;
+}
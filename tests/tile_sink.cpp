@@ -0,0 +1,111 @@
+#include "Common.hpp"
+
+#ifdef NDEBUG
+#undef NDEBUG
+#endif
+
+#include "Debug.hpp"
+#include "Exr.hpp"
+#include "Image.hpp"
+#include "PixelRenderer.hpp"
+#include "Renderer.hpp"
+#include "TileSink.hpp"
+#include "Vec3.hpp"
+#include "Viewport.hpp"
+
+#include <cstdio>
+#include <mutex>
+#include <vector>
+
+// Colours each pixel with its coordinates
+class GradientRenderer : public PixelRenderer
+{
+public:
+	GradientRenderer(const Viewport &vp, Image *img = nullptr) : PixelRenderer(vp, img) {}
+
+	virtual Vec3 shadePixel(uint col, uint row) const override { return Vec3(Real(col), Real(row), 1); }
+};
+
+// Keeps the pixels it receives in a frame of its own
+class FrameSink : public TileSink
+{
+public:
+	std::mutex mutex;
+	std::vector<float> pixels;
+	std::vector<uint> writes;
+	uint width;
+	uint tiles = 0;
+
+	FrameSink(uint _width, uint height) : pixels(_width * height * 3, 0.0f), writes(_width * height, 0), width(_width) {}
+
+	virtual void writeTile(uint x, uint y, uint tileWidth, uint tileHeight, const float *tilePixels) override
+	{
+		std::lock_guard<std::mutex> lock(mutex);
+		tiles++;
+		for (uint row = 0; row < tileHeight; row++)
+		{
+			for (uint col = 0; col < tileWidth; col++)
+			{
+				size_t index = size_t(y + row) * width + x + col;
+				const float *in = tilePixels + (size_t(row) * tileWidth + col) * 3;
+				for (uint channel = 0; channel < 3; channel++)
+					pixels[index * 3 + channel] = in[channel];
+				writes[index]++;
+			}
+		}
+	}
+};
+
+int main()
+{
+	Viewport viewport(150, 100);
+	ImageDesc desc;
+	desc.width = 150;
+	desc.height = 100;
+	desc.format = ImageFormat::r32g32b32f;
+	Image image(desc);
+	GradientRenderer gradient(viewport, &image);
+
+	// Without a sink the pixels are stored in the image
+	Renderer renderer;
+	renderer.setThreadCount(3);
+	renderer.render(gradient);
+	float a0[3];
+	image.load(149, 99, (byte*)a0);
+	assertEqual(Vec3(a0[0], a0[1], a0[2]), Vec3(149, 99, 1));
+
+	// With one, every pixel goes to the sink once and the image is left alone
+	Image untouched(desc);
+	GradientRenderer b0(viewport, &untouched);
+	FrameSink b1(150, 100);
+	renderer.setTileSink(&b1);
+	renderer.render(b0);
+	uint tileSize = renderer.getTileSize();
+	assertEqual(b1.tiles, ((150 + tileSize - 1) / tileSize) * ((100 + tileSize - 1) / tileSize));
+	for (uint row = 0; row < 100; row++)
+	{
+		for (uint col = 0; col < 150; col++)
+		{
+			size_t index = size_t(row) * 150 + col;
+			assertEqual(b1.writes[index], 1u);
+			assertEqual(Vec3(b1.pixels[index * 3], b1.pixels[index * 3 + 1], b1.pixels[index * 3 + 2]), Vec3(Real(col), Real(row), 1));
+		}
+	}
+	untouched.load(149, 99, (byte*)a0);
+	assertEqual(Vec3(a0[0], a0[1], a0[2]), Vec3(0, 0, 0));
+
+	// Streamed EXR files are only complete once every tile is written
+	file::ExrTileWriter c0;
+	assert(c0.open("test_tile_sink_output", 150, 100, tileSize));
+	renderer.setTileSink(&c0);
+	renderer.render(GradientRenderer(viewport));
+	assert(c0.close());
+	assert(c0.open("test_tile_sink_output.exr", 150, 100, tileSize));
+	float c1[3] = { 0, 0, 0 };
+	c0.writeTile(0, 0, 1, 1, c1);
+	assert(!c0.close());
+
+	std::remove("test_tile_sink_output.exr");
+
+	return 0;
+}
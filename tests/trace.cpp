@@ -0,0 +1,73 @@
+#include "Common.hpp"
+
+#ifdef NDEBUG
+#undef NDEBUG
+#endif
+
+#include "Debug.hpp"
+#include "Trace.hpp"
+
+#include <sstream>
+#include <string>
+#include <thread>
+
+uint countOccurrences(const std::string &text, const std::string &pattern)
+{
+	uint count = 0;
+	for (size_t i = text.find(pattern); i != std::string::npos; i = text.find(pattern, i + 1))
+		count++;
+	return count;
+}
+
+int main()
+{
+	// Nothing is recorded while disabled
+	{
+		trace::Scope scope("disabled", "test");
+	}
+	std::ostringstream a0;
+	trace::writeChromeTrace(a0);
+	assertEqual(countOccurrences(a0.str(), "disabled"), 0u);
+
+	trace::setEnabled(true);
+	{
+		trace::Scope outer("outer", "test");
+		trace::Scope inner("inner", "test", "x", 3, "y", -4);
+	}
+	std::thread worker([]()
+	{
+		trace::Scope scope("worker", "test");
+	});
+	worker.join();
+
+	std::ostringstream b0;
+	trace::writeChromeTrace(b0);
+	std::string b1 = b0.str();
+	assertEqual(countOccurrences(b1, "\"ph\": \"X\""), 3u);
+	assertEqual(countOccurrences(b1, "\"thread_name\""), 2u);
+	assert(b1.find("\"args\": {\"x\": 3, \"y\": -4}") != std::string::npos);
+	assert(b1.find("\"name\": \"worker\"") != std::string::npos);
+
+	// A new thread takes over the buffer of the one that exited
+	std::thread worker2([]()
+	{
+		trace::Scope scope("worker2", "test");
+	});
+	worker2.join();
+	std::ostringstream c0;
+	trace::writeChromeTrace(c0);
+	assertEqual(countOccurrences(c0.str(), "\"thread_name\""), 2u);
+	assertEqual(countOccurrences(c0.str(), "\"ph\": \"X\""), 4u);
+
+	// Rings keep the latest events
+	trace::clear();
+	for (uint i = 0; i < 100000; i++)
+		trace::Scope scope("many", "test");
+	std::ostringstream d0;
+	trace::writeChromeTrace(d0);
+	uint d1 = countOccurrences(d0.str(), "\"ph\": \"X\"");
+	assert(d1 > 0 && d1 < 100000);
+
+	trace::setEnabled(false);
+	return 0;
+}
@@ -37,5 +37,22 @@ int main(int argc, char const *argv[])
 	assertEqualWithTolerance(b0.inverse().apply(Vec3(1, 0, 0)), b0.applyInverse(Vec3(1, 0, 0)), 0.0001);
 	assertEqualWithTolerance(b0.applyInverse(Vec3(1, 0, 0)), b1.apply(Vec3(1, 0, 0)), 0.0001);
 
+	// Cached matrices against the quaternion path
+	Quat c0 = axisAngleToQuat(Vec3(1, 2, -3), 0.7);
+	Transform c1(c0, Vec3(4, -5, 6), 1.5);
+	Vec3 c2(-2, 0.5, 3);
+	assertEqualWithTolerance(c1.apply(c2), rotate(c2 * 1.5, c0) + Vec3(4, -5, 6), 0.0001);
+	assertEqualWithTolerance(c1.applyInverse(c2), rotate(c2 - Vec3(4, -5, 6), c0.getConjugate()) / 1.5, 0.0001);
+	assertEqualWithTolerance(c1.applyInverse(c1.apply(c2)), c2, 0.0001);
+	assertEqualWithTolerance(c1.applyRotation(c2), rotate(c2, c0), 0.0001);
+	assertEqualWithTolerance(c1.applyInverseRotation(c2), rotate(c2, c0.getConjugate()), 0.0001);
+	c1.setRotation(Quat());
+	c1.setTranslation(Vec3());
+	c1.setScale(2);
+	assertEqualWithTolerance(c1.apply(c2), c2 * 2, 0.0001);
+	Ray c3 = b0.applyInverse(b0.apply(Ray(Vec3(1, 2, 3), Vec3(0, 1, 1))));
+	assertEqualWithTolerance(c3.origin(), Vec3(1, 2, 3), 0.0001);
+	assertEqualWithTolerance(c3.direction(), normalize(Vec3(0, 1, 1)), 0.0001);
+
 	return 0;
 }
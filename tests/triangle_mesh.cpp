@@ -0,0 +1,101 @@
+#include "Common.hpp"
+
+#ifdef NDEBUG
+#undef NDEBUG
+#endif
+
+#include "Box.hpp"
+#include "Debug.hpp"
+#include "Lambertian.hpp"
+#include "Quat.hpp"
+#include "Random.hpp"
+#include "Transform.hpp"
+#include "TriangleMesh.hpp"
+#include "Vec3.hpp"
+
+#include <vector>
+
+int main()
+{
+	Lambertian material(Vec3(1, 1, 1));
+
+	// Unit cube, counter-clockwise faces seen from outside
+	std::vector<Vec3> positions;
+	for (uint i = 0; i < 8; i++)
+		positions.push_back(Vec3(i & 1 ? 0.5 : -0.5, i & 2 ? 0.5 : -0.5, i & 4 ? 0.5 : -0.5));
+	std::vector<uint> indices =
+	{
+		0, 2, 1,  1, 2, 3,	// -z
+		4, 5, 6,  5, 7, 6,	// +z
+		0, 1, 4,  1, 5, 4,	// -y
+		2, 6, 3,  3, 6, 7,	// +y
+		0, 4, 2,  2, 4, 6,	// -x
+		1, 3, 5,  3, 7, 5	// +x
+	};
+
+	Transform transform(axisAngleToQuat(Vec3(1, 1, 0), 0.6), Vec3(1, -2, 3), 2.0);
+	TriangleMesh mesh(transform, positions, indices, material);
+	assertEqual(mesh.getTriangleAmount(), 12u);
+	assertEqual(mesh.getVertexAmount(), 8u);
+	Box box(transform, Vec3(1, 1, 1), material);
+
+	// Rays aimed around the cube must agree with the analytic box
+	uint hits = 0;
+	for (uint i = 0; i < 1000; i++)
+	{
+		Vec3 origin = transform.translation() + 6.0 * normalize(2.0 * Vec3(uniformRand(), uniformRand(), uniformRand()) - 1.0);
+		Vec3 target = transform.translation() + 2.0 * (Vec3(uniformRand(), uniformRand(), uniformRand()) - 0.5);
+		Ray r(origin, target - origin);
+		HitRecord meshRec;
+		HitRecord boxRec;
+		bool meshHit = mesh.hit(r, 0.001, 100.0, meshRec);
+		bool boxHit = box.hit(r, 0.001, 100.0, boxRec);
+		if (meshHit != boxHit)
+		{
+			// Only allowed on the very edge of the box
+			Vec3 local = transform.applyInverse(meshHit ? meshRec.point : boxRec.point);
+			Vec3 distToEdge = Vec3(0.5, 0.5, 0.5) - abs(local);
+			assertVerbose(min(distToEdge) < 0.001 || ((distToEdge.x < 0.001) + (distToEdge.y < 0.001) + (distToEdge.z < 0.001)) >= 2, local);
+			continue;
+		}
+		if (!meshHit)
+			continue;
+		hits++;
+		assertEqualWithTolerance(meshRec.t, boxRec.t, 0.0001);
+		assertEqualWithTolerance(meshRec.normal, boxRec.normal, 0.0001);
+		assert(meshRec.hitable == &mesh);
+	}
+	assert(hits > 100);
+
+	// Distance to the surface
+	assertEqualWithTolerance(mesh.evaluateSDF(transform.translation()), 1.0, 0.0001);
+	assertEqualWithTolerance(mesh.evaluateSDF(transform.apply(Vec3(1.5, 0, 0))), 2.0, 0.0001);
+	assertEqualWithTolerance(mesh.evaluateNormalFromSDF(transform.apply(Vec3(0.6, 0, 0)), 0.001), transform.applyRotation(Vec3(1, 0, 0)), 0.0001);
+
+	// Shared edges of a subdivided grid must never let a ray through
+	const uint gridSize = 64;
+	std::vector<Vec3> gridPositions;
+	std::vector<uint> gridIndices;
+	for (uint y = 0; y <= gridSize; y++)
+		for (uint x = 0; x <= gridSize; x++)
+			gridPositions.push_back(Vec3(Real(x) / gridSize - 0.5, Real(y) / gridSize - 0.5, 0));
+	for (uint y = 0; y < gridSize; y++)
+	{
+		for (uint x = 0; x < gridSize; x++)
+		{
+			uint i = y * (gridSize + 1) + x;
+			gridIndices.insert(gridIndices.end(), { i, i + 1, i + gridSize + 1, i + 1, i + gridSize + 2, i + gridSize + 1 });
+		}
+	}
+	TriangleMesh grid(Transform(), gridPositions, gridIndices, material);
+	assertEqual(grid.getTriangleAmount(), 2 * gridSize * gridSize);
+	for (uint y = 1; y < gridSize; y++)
+	{
+		// Aim exactly at vertices and edges
+		Vec3 target(Real(y) / gridSize - 0.5, Real(y) / gridSize - 0.5, 0);
+		HitRecord rec;
+		assertVerbose(grid.hit(Ray(Vec3(0.1, -0.2, 1), target - Vec3(0.1, -0.2, 1)), 0.0, 10.0, rec), target);
+	}
+
+	return 0;
+}
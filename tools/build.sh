@@ -6,6 +6,8 @@ usage()
 	echo "  project_name is the name of a .cpp file with entry point and its location. If a Makefile"
 	echo "  is located next to project_name, it will be used to build the project."
 	echo "output: the name of the successfully built executable, or an error message in stderr."
+	echo "environment:"
+	echo "  CXXFLAGS                   Compiler flags used instead of the default -O3."
 	echo "options:"
 	echo "  -h, --help                 Prints this message."
 	echo "  -r, --root                 Specifies where included files are rooted."
@@ -110,10 +112,53 @@ if [ ! -f "$projectSrc" ]; then
 	exit 1
 fi
 
+# Compiler flags can be overridden through the environment, e.g. CXXFLAGS="-O2 -g -march=native"
+cxxFlags="${CXXFLAGS:--O3}"
+
+# Build the core library from the sources found in the root directory, recompiling only the sources
+# that changed or that are older than one of the headers
+build_core_library()
+{
+	libDir="${binDir}/lib"
+	coreLibrary="${libDir}/libraytracer_core.a"
+	mkdir -p "${libDir}/obj" || return 1
+
+	newestHeader="$(ls -t "${rootDir}"/*.hpp 2>/dev/null | head -n 1)"
+	objects=()
+	changed=0
+
+	# Everything is rebuilt when the flags change
+	flagsFile="${libDir}/flags"
+	if [[ ! -f "$flagsFile" || "$(cat "$flagsFile")" != "$cxxFlags" ]]; then
+		rm -f "${libDir}"/obj/*.o
+		echo "$cxxFlags" > "$flagsFile"
+	fi
+	for source in "${rootDir}"/*.cpp; do
+		case "$(basename "$source")" in
+			# Entry point and viewer are not part of the core
+			raytracer.cpp|Viewer.cpp)
+			continue
+			;;
+		esac
+		object="${libDir}/obj/$(barename "$source").o"
+		objects+=("$object")
+		if [[ ! -f "$object" || "$source" -nt "$object" || ( -n "$newestHeader" && "$newestHeader" -nt "$object" ) ]]; then
+			g++ $cxxFlags -Wall -std=c++11 -I "${rootDir}" -c -o "$object" "$source" 1>&2 || return 1
+			changed=1
+		fi
+	done
+
+	if [[ $changed -ne 0 || ! -f "$coreLibrary" ]]; then
+		rm -f "$coreLibrary"
+		ar rcs "$coreLibrary" "${objects[@]}" || return 1
+	fi
+}
+
 if [ -f "${projectDir}/Makefile" ]; then
 	( cd "${projectDir}" && make >/dev/null )
 else
-	g++ -O3 -Wall -std=c++11 -I "${rootDir}" -o "$outputFile" "$projectSrc"
+	build_core_library &&
+	g++ $cxxFlags -Wall -std=c++11 -I "${rootDir}" -o "$outputFile" "$projectSrc" "${coreLibrary}" -pthread
 fi
 
 if [[ $? -eq 0 ]]; then